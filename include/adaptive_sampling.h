@@ -0,0 +1,62 @@
+#ifndef ADAPTIVE_SAMPLING_H
+#define ADAPTIVE_SAMPLING_H
+
+#include <Arduino.h>
+
+// Set to 0 to read every sensor at its fixed default interval
+#define ADAPTIVE_SAMPLING 1
+
+// Read interval limits per sensor
+#define SAMPLING_BMP390_MIN_MS 2000       // Fastest BMP390 read interval
+#define SAMPLING_BMP390_MAX_MS 60000      // Slowest BMP390 read interval
+#define SAMPLING_BMP390_DEFAULT_MS 5000   // Interval at boot and without adaptation
+#define SAMPLING_DHT11_MIN_MS 2000        // Fastest DHT11 read interval (sensor needs 1 s)
+#define SAMPLING_DHT11_MAX_MS 30000       // Slowest DHT11 read interval
+#define SAMPLING_DHT11_DEFAULT_MS 2000    // Interval at boot and without adaptation
+
+// Activity: standard deviation of a metric around its moving mean,
+// relative to the metric's threshold below
+#define SAMPLING_TAU_MS 120000.0f         // Time constant of the moving mean and variance
+#define SAMPLING_ACTIVITY_PRESSURE 0.03f  // hPa
+#define SAMPLING_ACTIVITY_TEMPERATURE 0.1f // °C
+#define SAMPLING_ACTIVITY_HUMIDITY 1.5f   // % (DHT11 reads whole percent)
+#define SAMPLING_CALM_RATIO 0.5f          // Activity below this lets the interval grow
+#define SAMPLING_HOLD_MS 60000UL          // Calm time before each doubling of the interval
+
+// Sensors with their own read interval
+enum SamplingSource {
+    SAMPLING_BMP390,
+    SAMPLING_DHT11,
+    SAMPLING_SOURCE_COUNT
+};
+
+// Metrics whose variance drives their sensor's interval
+enum SamplingMetric {
+    SAMPLING_PRESSURE,        // BMP390
+    SAMPLING_TEMPERATURE,     // BMP390
+    SAMPLING_HUMIDITY,        // DHT11
+    SAMPLING_METRIC_COUNT
+};
+
+// Read rate counters of one sensor
+struct SamplingStats {
+    const char *name;         // Sensor name
+    uint32_t intervalMs;      // Current read interval
+    uint32_t samples;         // Readings since boot
+    uint32_t averageMs;       // Mean time between readings
+    float minimumPercent;     // Share of time spent at the fastest interval
+    uint16_t faster;          // Switches to the fastest interval
+    uint16_t slower;          // Interval doublings
+};
+
+// Function declarations
+void samplingAddReading(SamplingMetric metric, float value);  // Updates a metric's moving mean and variance
+unsigned long samplingUpdate(SamplingSource source);          // Adapts a sensor's interval after a reading, returns it
+unsigned long samplingIntervalMs(SamplingSource source);      // Current read interval of a sensor
+void getSamplingStats(SamplingSource source, SamplingStats &out); // Copies a sensor's counters
+float samplingDeviation(SamplingMetric metric);               // Moving standard deviation of a metric
+const char *samplingMetricName(SamplingMetric metric);        // "pressure", ...
+SamplingSource samplingMetricSource(SamplingMetric metric);   // Sensor that reads a metric
+void printSamplingStats();                                    // Prints the sampling report
+
+#endif // ADAPTIVE_SAMPLING_H
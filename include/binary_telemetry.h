@@ -0,0 +1,24 @@
+#ifndef BINARY_TELEMETRY_H
+#define BINARY_TELEMETRY_H
+
+#include <Arduino.h>
+#include "include/sensor_registry.h"
+#include "include/telemetry_codec.h"
+
+// Set to 1 to also publish readings as compact binary frames (format in
+// include/telemetry_codec.h) for collectors on metered links. The Home
+// Assistant JSON topics are unchanged; backlog replay switches to frames.
+#define MQTT_BINARY_TELEMETRY 0
+
+#define TELEMETRY_TOPIC SENSOR_TOPIC_PREFIX "weather/telemetry"
+#define TELEMETRY_BATCH_SAMPLES 4       // Published readings per live frame
+#define TELEMETRY_FRAME_BYTES 448       // Frame buffer; fits the 512-byte MQTT buffer with the topic
+#define TELEMETRY_BACKLOG_SAMPLES 32    // Queued readings per backlog frame
+
+// Function declarations
+void telemetryAddReading(const SensorSnapshot &snap, uint32_t timestamp); // Batches a published reading, sends full frames
+bool telemetryFlush();                  // Sends the partial live frame (before deep sleep)
+bool telemetryPublishBacklog();         // Replays queued readings as frames
+void benchmarkTelemetry();              // Prints encoded size and encode time per sample
+
+#endif // BINARY_TELEMETRY_H
@@ -0,0 +1,58 @@
+#ifndef BMP390_FIFO_H
+#define BMP390_FIFO_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// BMP390 FIFO configuration
+#define BMP390_I2C_ADDRESS 0x77        // Default BMP390 address (SDO high)
+#define BMP390_FIFO_BYTES 512          // Hardware FIFO size
+#define BMP390_FIFO_FRAME_BYTES 7      // Header, 3 temperature and 3 pressure bytes
+#define BMP390_FIFO_MAX_FRAMES 73      // Whole frames in 512 bytes
+
+// FIFO_DATA is read in chunks of whole frames that fit the ESP32 Wire
+// buffer (18 frames, 126 bytes): the sensor discards the rest of a frame
+// that a read transaction ends inside of
+
+// Compensation coefficients read from the sensor NVM
+struct BMP390Calibration {
+    float t1, t2, t3;
+    float p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11;
+};
+
+// Normal-mode settings (register values)
+struct BMP390FifoConfig {
+    uint8_t osr;           // OSR: osr_t << 3 | osr_p (0 = x1 .. 5 = x32)
+    uint8_t odr;           // ODR: 200 Hz / 2^odr
+    uint8_t iir;           // CONFIG: iir_filter << 1 (0 = off, 2 = coefficient 3, 4 = 15)
+    uint8_t subsampling;   // FIFO stores 1 of 2^subsampling samples
+};
+
+// Result of one FIFO drain
+struct BMP390FifoReading {
+    uint16_t frames;       // Pressure+temperature frames averaged
+    float temperature;     // Mean temperature (°C)
+    float pressure;        // Mean pressure (Pa)
+};
+
+// Bus traffic counters of the FIFO driver
+struct BMP390FifoStats {
+    uint32_t drains;          // FIFO drains
+    uint32_t frames;          // Frames decoded
+    uint32_t bytes;           // FIFO bytes read
+    uint32_t transactions;    // I2C transactions used by drains
+    uint32_t configErrors;    // Drains that found a sensor configuration error frame
+};
+
+// Function declarations
+bool setupBMP390Fifo(const BMP390FifoConfig &config);    // Reads calibration and starts normal mode with FIFO
+bool configureBMP390Fifo(const BMP390FifoConfig &config); // Changes the normal-mode settings and flushes the FIFO
+bool readBMP390Fifo(BMP390FifoReading &out);             // Drains the FIFO in burst reads and averages the frames
+void getBMP390FifoStats(BMP390FifoStats &out);           // Copies the driver counters
+
+// Pure decoder: parses raw FIFO bytes into compensated samples
+// Returns the number of pressure+temperature frames written to temperature/pressure
+size_t decodeBMP390Fifo(const uint8_t *data, size_t len, const BMP390Calibration &cal,
+                        float *temperature, float *pressure, size_t maxFrames, bool *configError);
+
+#endif // BMP390_FIFO_H
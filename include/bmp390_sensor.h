@@ -4,15 +4,18 @@
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
 #include <Adafruit_BMP3XX.h>
+#include "include/sensor_snapshot.h"
 
-// External variable declarations for sensor readings
-extern float temperature;    // Current temperature (°C)
-extern float pressure;       // Current pressure (hPa)
-extern float altitude;       // Current altitude (meters)
+// Set to 1 to read the sensor through its hardware FIFO (normal mode,
+// 12.5 Hz filtered samples averaged per read) instead of one forced
+// measurement per read
+#define BMP390_USE_FIFO 1
 
 // Function declarations
 void setupBMP390Sensor();    // Initializes BMP390 sensor
-void readBMP390Sensor();     // Reads and processes sensor data
+void readBMP390Sensor();     // Reads sensor data and publishes it to the sensor snapshot
+void processBMP390Reading(float rawTemp, float rawPressure); // Offsets, smoothing and publishing of a raw reading
+void resetBMP390Smoothing(); // Makes the next reading seed the filter again
 float applySmoothing(float newValue, float prevValue, float alpha); // Applies exponential smoothing
 
 // External calibration offset declarations
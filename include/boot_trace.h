@@ -0,0 +1,24 @@
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <Arduino.h>
+
+// Milestones of the boot pipeline, in the order they usually happen
+enum BootEvent {
+    BOOT_SENSORS_READY,       // BMP390 and DHT11 initialized
+    BOOT_DISPLAY_READY,       // OLED initialized
+    BOOT_SCHEDULER_STARTED,   // Jobs running, setup() finished
+    BOOT_FIRST_READING,       // First reading in the sensor snapshot
+    BOOT_WIFI_CONNECTED,      // Wi-Fi associated and IP assigned
+    BOOT_TIME_SYNCED,         // NTP time received
+    BOOT_MQTT_CONNECTED,      // Broker connection established
+    BOOT_FIRST_PUBLISH,       // First sensor data published
+    BOOT_EVENT_COUNT
+};
+
+// Function declarations
+void bootTraceMark(BootEvent event);        // Records the first time an event happens
+uint32_t bootTraceTime(BootEvent event);    // ms since boot of an event, 0 if not reached yet
+void printBootTrace();                      // Prints the boot timeline
+
+#endif // BOOT_TRACE_H
@@ -0,0 +1,107 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <Arduino.h>
+
+// Log levels
+enum LogLevel {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR
+};
+
+// Logging configuration
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG   // Calls below this level are compiled out
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO    // Runtime threshold at boot, see logSetLevel()
+#define LOG_RING_RECORDS 64                 // Ring capacity (power of two)
+#define LOG_MAX_ARGS 6                      // Arguments per record
+#define LOG_TASK_TAG_CHARS 8                // Characters of the task name kept per record
+#define LOG_LINE_BYTES 192                  // Longest formatted line
+#define LOG_TASK_STACK 3072                 // Formatting task stack (bytes)
+#define LOG_TASK_PRIORITY (tskIDLE_PRIORITY + 1) // Below SCHEDULER_TASK_PRIORITY, so jobs never wait for the UART
+#define LOG_FLUSH_TIMEOUT_MS 250            // Longest wait for the ring to drain before deep sleep
+#define LOG_REPORT_BYTES 4096               // Report text waiting for the formatting task (power of two)
+
+/*
+ * Deferred logging: a call site stores the format string pointer, up to
+ * LOG_MAX_ARGS argument words, the time and the task name in a
+ * lock-free ring; a low-priority task formats and prints the records.
+ * Format strings are checked by the compiler like printf. Arguments are
+ * stored by value, so %s arguments must point to strings that outlive the
+ * record (literals and static tables); 64-bit arguments are not
+ * supported. Not for use in ISRs.
+ */
+#define LOG_AT(level, format, ...)                                          \
+    do {                                                                    \
+        if ((level) >= LOG_COMPILE_LEVEL && (level) >= logLevel) {          \
+            if (0) Serial.printf(format, ##__VA_ARGS__); /* Format check */ \
+            logWrite(level, format, ##__VA_ARGS__);                         \
+        }                                                                   \
+    } while (0)
+
+#define LOG_DEBUG(format, ...) LOG_AT(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) LOG_AT(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...) LOG_AT(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) LOG_AT(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+/*
+ * Reports: multi-line tables and periodic summaries are formatted by the
+ * caller, copied whole into a text buffer and written to the UART by the
+ * formatting task, so a scheduler job never waits for the serial port. A
+ * line that does not fit is dropped; before setupLog() lines are printed
+ * directly.
+ */
+
+// Counters for the profiling report
+struct LogStats {
+    uint32_t written;         // Records stored since boot
+    uint32_t dropped;         // Records lost because the ring was full
+    uint32_t reportDropped;   // Report lines lost because the text buffer was full
+    uint16_t maxReportBytes;  // Most report text waiting at once
+    uint16_t maxDepth;        // Most records waiting at once
+    uint32_t callCycles;      // Average CPU cycles per stored record
+    uint32_t maxCallCycles;   // Worst CPU cycles per stored record
+};
+
+extern volatile uint8_t logLevel;     // Runtime threshold
+
+// Argument packing: every argument becomes one word, wide enough for a
+// pointer (32 bits on the ESP32)
+typedef uintptr_t LogWord;
+
+inline LogWord logArg(int value) { return (uint32_t)value; }
+inline LogWord logArg(unsigned value) { return value; }
+inline LogWord logArg(long value) { return (uint32_t)value; }
+inline LogWord logArg(unsigned long value) { return (uint32_t)value; }
+inline LogWord logArg(const char *value) { return (uintptr_t)value; }
+inline LogWord logArg(const void *value) { return (uintptr_t)value; }
+inline LogWord logArg(double value) {
+    float f = (float)value;  // Stored as float; printf promotes it back
+    LogWord word = 0;
+    memcpy(&word, &f, sizeof(f));
+    return word;
+}
+
+// Function declarations
+void setupLog();                      // Prepares the ring and starts the formatting task
+void logPush(uint8_t level, const char *format, const LogWord *args, uint8_t argCount); // Stores one record
+void logSetLevel(uint8_t level);      // Changes the runtime threshold
+bool logIdle();                       // True when every record is taken and every report line written
+void logFlush(uint32_t timeoutMs);    // Waits until every record and report line is printed (before deep sleep)
+bool reportPrintln(const char *line); // Queues one report line, like Serial.println(); false if it was dropped
+void reportPrintf(const char *format, ...) __attribute__((format(printf, 1, 2))); // Queues report text, like Serial.printf()
+void getLogStats(LogStats &out);      // Copies the counters
+void printLogStats();                 // Prints the logging report
+
+/**
+ * Packs the arguments and stores one record; use the LOG_* macros
+ */
+template <typename... Args>
+inline void logWrite(uint8_t level, const char *format, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+    const LogWord words[sizeof...(Args) + 1] = {logArg(args)..., 0};
+    logPush(level, format, words, sizeof...(Args));
+}
+
+#endif // DEFERRED_LOG_H
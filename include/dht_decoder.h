@@ -0,0 +1,42 @@
+#ifndef DHT_DECODER_H
+#define DHT_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// DHT11 pulse windows (microseconds). The nominal timings are 80 us for
+// each half of the response and 50 us low + 26-28 us (0) or 70 us (1)
+// high per bit; the windows allow for sensor tolerance and ISR latency.
+#define DHT_RESPONSE_MIN_US 65
+#define DHT_RESPONSE_MAX_US 110
+#define DHT_BIT_LOW_MIN_US 30
+#define DHT_BIT_LOW_MAX_US 64
+#define DHT_BIT_HIGH_MIN_US 10
+#define DHT_BIT_HIGH_MAX_US 100
+#define DHT_BIT_ONE_MIN_US 48           // High pulses at least this long are a 1
+
+#define DHT_FRAME_BITS 40               // Humidity, temperature (2 bytes each) and checksum
+#define DHT_MAX_EDGES 96                // Release edge + response + 40 bits, with room for glitches
+
+// Outcome of decoding one captured pulse train
+enum DhtDecodeResult {
+    DHT_DECODE_OK,
+    DHT_DECODE_NO_RESPONSE,             // No 80/80 us response found
+    DHT_DECODE_TRUNCATED,               // Response found, but fewer than 40 bits followed
+    DHT_DECODE_BAD_TIMING,              // A bit pulse was outside its window
+    DHT_DECODE_BAD_CHECKSUM             // All 40 bits decoded, checksum mismatch
+};
+
+// One decoded DHT11 frame
+struct DhtReading {
+    uint8_t bytes[5];                   // Raw frame, checksum last
+    float humidity;                     // %
+    float temperature;                  // °C
+};
+
+// Function declarations (no Arduino dependencies, so they also build on a PC)
+DhtDecodeResult decodeDHTPulses(const uint32_t *edgeMicros, size_t edgeCount,
+                                DhtReading &reading);   // Decodes edge timestamps into a frame
+const char *dhtDecodeResultName(DhtDecodeResult result); // Short name for log messages
+
+#endif // DHT_DECODER_H
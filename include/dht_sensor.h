@@ -1,19 +1,24 @@
 #ifndef DHT_SENSOR_H
 #define DHT_SENSOR_H
 
-#include <Adafruit_Sensor.h>
-#include <DHT.h>
-#include <DHT_U.h>
+#include <Arduino.h>
+#include "include/sensor_snapshot.h"
+#include "include/dht_decoder.h"
 
-// DHT sensor configuration
-#define DHTPIN 4          // GPIO pin for DHT sensor connection
-#define DHTTYPE DHT11     // Specifies DHT11 sensor type
+// DHT sensor configuration (read interval: include/adaptive_sampling.h)
+#define DHTPIN 4                  // GPIO pin for DHT sensor connection
 
-// External variable declaration
-extern float humidity;    // Current humidity reading (%)
+// Non-blocking read timing: the start signal and the capture run as
+// separate steps, so the sensor scheduler runs other jobs in between
+#define DHT_START_LOW_MS 20       // Host start signal (DHT11 needs at least 18 ms)
+#define DHT_CAPTURE_MS 10         // Response and 40 bits take about 5 ms
+#define DHT_RETRY_DELAY_MS 1100   // DHT11 needs 1 s between conversions
+#define DHT_MAX_ATTEMPTS 3        // Attempts per reading before it is reported as failed
 
 // Function declarations
-void setupDHTSensor();    // Initializes DHT sensor
-void readDHTSensor();     // Reads humidity from DHT sensor
+void setupDHTSensor();            // Configures the data pin and the edge capture
+unsigned long readDHTSensor();    // Advances the read by one step, returns ms until the next step
+void readDHTSensorBlocking();     // Runs all steps of one reading, waiting in between
+void processDHTReading(float humidity); // Publishes a decoded humidity reading
 
 #endif // DHT_SENSOR_H
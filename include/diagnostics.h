@@ -0,0 +1,13 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <Arduino.h>
+
+// Runtime telemetry published next to the sensor topics
+#define DIAGNOSTICS_INTERVAL_MS (5UL * 60UL * 1000UL)  // Publish every 5 minutes
+#define DIAGNOSTICS_TOPIC "homeassistant/sensor/bmp390_weather/diagnostics"
+
+// Function declarations
+bool publishDiagnostics();  // Publishes system, job, bus timing and sampling documents
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,29 @@
+#ifndef DUTY_CYCLE_H
+#define DUTY_CYCLE_H
+
+#include <Arduino.h>
+
+// Set to 1 for solar sites: wake, sample, publish and deep-sleep again
+// instead of running the scheduler forever
+#define DUTY_CYCLE_MODE 0
+
+#define DUTY_CYCLE_PERIOD_S 300               // Wake period (seconds)
+#define DUTY_CYCLE_WIFI_TIMEOUT_MS 10000      // Give up on Wi-Fi after this long and queue the reading
+#define DUTY_CYCLE_NTP_TIMEOUT_MS 5000        // Wait for NTP after power-on so queued readings get real timestamps
+#define DUTY_CYCLE_BACKLOG_CALLS 4            // publishBacklog() calls per wake (readings replayed in bursts)
+
+// Duration of each phase of one wake cycle (ms since the app started)
+struct DutyCycleTiming {
+    uint32_t cycle;           // Wake count since power-on
+    uint32_t sampledMs;       // Wake → sensors read
+    uint32_t connectedMs;     // Wake → Wi-Fi and MQTT connected (0 if the connection failed)
+    uint32_t publishedMs;     // Wake → readings published (0 if not published)
+    uint32_t sleepMs;         // Wake → entering deep sleep
+    uint32_t failedCycles;    // Wakes since power-on whose readings were incomplete
+};
+
+// Function declarations
+void runDutyCycle();                                // Runs one wake cycle and deep-sleeps (never returns)
+bool getLastDutyCycleTiming(DutyCycleTiming &out);  // Timing of the previous cycle, kept in RTC memory
+
+#endif // DUTY_CYCLE_H
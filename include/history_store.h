@@ -0,0 +1,35 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <Arduino.h>
+
+// History configuration
+#define HISTORY_INTERVAL_MS 60000UL   // One history row per minute
+#define HISTORY_BLOCK_ROWS 60         // Rows per block (one absolute keyframe per block)
+#define HISTORY_BLOCKS 25             // Ring of blocks; always holds at least 24 hours of rows
+#define HISTORY_CAPACITY (HISTORY_BLOCK_ROWS * HISTORY_BLOCKS)
+
+// Metrics kept in the history
+enum HistoryMetric {
+    HISTORY_TEMPERATURE,   // °C, stored in 0.01 steps
+    HISTORY_PRESSURE,      // hPa, stored in 0.01 steps
+    HISTORY_HUMIDITY,      // %, stored in 0.1 steps
+    HISTORY_METRIC_COUNT
+};
+
+// Aggregate over a window of history rows
+struct HistoryStats {
+    float min;
+    float max;
+    float mean;
+    uint16_t rows;         // Number of rows in the window
+};
+
+// Function declarations
+void setupHistory();                                           // Creates the history lock
+void historyAddSample(HistoryMetric metric, float value);      // Feeds a new sensor sample
+uint16_t historyRowCount();                                    // Number of stored rows (minutes)
+bool historyGetValue(HistoryMetric metric, uint16_t minutesAgo, float &out);  // Value of one past row
+bool historyGetStats(HistoryMetric metric, uint16_t minutes, HistoryStats &out); // Min/max/mean over the newest rows
+
+#endif // HISTORY_STORE_H
@@ -0,0 +1,34 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Bus clock. The BMP390 supports up to 3.4 MHz, the SSD1306 is specified
+// for 400 kHz; many modules also run at 1000000, which halves frame time
+#define I2C_BUS_CLOCK_HZ 400000UL
+
+// Devices on the shared bus, highest arbitration priority first
+enum I2CDevice {
+    I2C_DEVICE_BMP390,    // Sensor reads: short, latency sensitive
+    I2C_DEVICE_SSD1306,   // Display flushes: long, can wait
+    I2C_DEVICE_COUNT
+};
+
+// Bus usage of one device over the current report window
+struct I2CDeviceStats {
+    uint32_t transactions;    // Completed bus transactions
+    uint32_t busyMicros;      // Time holding the bus (µs)
+    uint32_t waitMicros;      // Time spent waiting for the bus (µs)
+    uint32_t maxWaitMicros;   // Longest wait for the bus (µs)
+    float occupancyPercent;   // Share of the window this device held the bus
+};
+
+// Function declarations
+void setupI2CBus();                            // Starts Wire at I2C_BUS_CLOCK_HZ and creates the bus lock
+void i2cBegin(I2CDevice device);               // Waits for the bus; higher-priority devices go first
+void i2cEnd(I2CDevice device);                 // Releases the bus and records occupancy
+void getI2CDeviceStats(I2CDevice device, I2CDeviceStats &out); // Copies one device's counters
+void printI2CBusStats();                       // Prints per-device occupancy and starts a new window
+
+#endif // I2C_BUS_H
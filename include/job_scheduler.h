@@ -0,0 +1,51 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <Arduino.h>
+#include "include/perf_stats.h"
+
+// Set to 1 to let the chip enter light sleep whenever no job is due
+#define SCHEDULER_LIGHT_SLEEP 1
+
+#define SCHEDULER_MAX_JOBS 12           // Jobs across all schedulers
+#define SCHEDULER_COALESCE_MS 20        // Jobs due this soon run in the same wake-up
+#define SCHEDULER_TASK_PRIORITY (tskIDLE_PRIORITY + 2) // Above the log task (LOG_TASK_PRIORITY), which prints job output
+
+// Each scheduler is one FreeRTOS task running its jobs in deadline order
+enum SchedulerId {
+    SCHEDULER_SENSORS,   // Core 1: sensor reads and the display
+    SCHEDULER_NETWORK,   // Core 0: Wi-Fi, MQTT and serial reports
+    SCHEDULER_COUNT
+};
+
+typedef void (*JobFunction)();
+
+// Per-job counters for the scheduler report
+struct JobStats {
+    const char *name;
+    uint32_t runs;            // Completed runs
+    uint64_t totalMicros;     // Time spent running since boot (µs), 64 bits so it never wraps
+    uint32_t maxLateMs;       // Worst delay between deadline and start (ms)
+    uint32_t maxMicros;       // Longest run (µs)
+    LatencyHistogram histogram; // Distribution of run times
+};
+
+// Whole-system counters over the current report window
+struct SchedulerStats {
+    float wakeupsPerMinute;   // Scheduler wake-ups per minute, all schedulers
+    float idlePercent;        // Share of the window no job was running
+    uint32_t windowMs;        // Length of the window
+};
+
+// Function declarations
+int addJob(SchedulerId scheduler, const char *name, JobFunction function,
+           uint32_t periodMs, uint32_t firstDelayMs);     // Registers a periodic job, returns its id
+void startSchedulers();                                   // Configures power management and starts the scheduler tasks
+void scheduleJobIn(int job, uint32_t delayMs);            // Moves the next run of a job (any task)
+void triggerJob(int job);                                 // Runs a job as soon as possible (any task)
+bool getJobStats(int job, JobStats &out);                 // Copies the counters of one job
+void getSchedulerStats(SchedulerStats &out);              // Wake-up rate and idle share since the last reset
+void printSchedulerStats();                               // Prints the scheduler report and starts a new window
+uint32_t getSchedulerStackFree(SchedulerId scheduler);    // Smallest free stack seen on a scheduler task (bytes)
+
+#endif // JOB_SCHEDULER_H
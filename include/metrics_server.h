@@ -0,0 +1,45 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <Arduino.h>
+
+// Set to 0 to leave out the /metrics endpoint
+#define METRICS_SERVER 1
+
+// Server configuration
+#ifndef METRICS_PORT
+#define METRICS_PORT 80                     // TCP port of the endpoint
+#endif
+#define METRICS_PATH "/metrics"             // Only path served
+#define METRICS_PREFIX "weather_"           // Prefix of every metric name
+#define METRICS_MAX_CLIENTS 4               // Concurrent scrapes; more are answered with 503
+#define METRICS_REQUEST_BYTES 128           // Request line kept per client (headers are skipped)
+#define METRICS_CHUNK_BYTES 384             // Send buffer per client, holds one metric family
+#define METRICS_CLIENT_TIMEOUT_MS 5000      // Idle time before a client is dropped
+#define METRICS_LINGER_SLOTS 8              // Answered sockets waiting for the client to close
+#define METRICS_LINGER_MS 500               // Longest wait for the client to close
+#define METRICS_TASK_STACK 4096             // Server task stack (bytes)
+#define METRICS_TASK_PRIORITY (tskIDLE_PRIORITY + 1) // Below SCHEDULER_TASK_PRIORITY, so a scrape never delays a job
+
+/*
+ * Prometheus endpoint: a low-priority task serves GET /metrics to up to
+ * METRICS_MAX_CLIENTS clients at once over non-blocking sockets. Each
+ * scrape copies the sensor snapshot once and then writes one metric family
+ * at a time into a small per-client buffer, so the response is never held
+ * in memory as a whole and a slow client never blocks the sensor tasks.
+ */
+
+// Counters for the profiling report
+struct MetricsStats {
+    uint32_t scrapes;         // Completed /metrics responses
+    uint32_t refused;         // Connections answered with 503 (no free client slot)
+    uint32_t errors;          // Bad requests, timeouts and send failures
+    uint32_t bytesSent;       // Response bytes written to sockets
+};
+
+// Function declarations
+bool setupMetricsServer();               // Opens the listening socket and starts the server task
+void getMetricsStats(MetricsStats &out); // Copies the counters
+void printMetricsStats();                // Prints the scrape report
+
+#endif // METRICS_SERVER_H
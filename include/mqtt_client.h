@@ -1,15 +1,57 @@
-#ifndef MQTT_CLIENT_H
-#define MQTT_CLIENT_H
-
-#include <WiFi.h>
-#include <PubSubClient.h>
-#include "secrets.h"
-
-// External client declarations
-extern WiFiClient espClient;     // WiFi client instance
-extern PubSubClient client;      // MQTT client instance
-
-// Function declaration
-void setupMQTT();                // Sets up MQTT connection
-
-#endif // MQTT_CLIENT_H
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "secrets.h"
+
+// Connection manager configuration
+#define MQTT_PORT 1883
+#define MQTT_CONNECT_TIMEOUT_MS 3000       // TCP connect timeout per attempt
+#define MQTT_SOCKET_TIMEOUT_S 3            // Wait for CONNACK per attempt
+#define MQTT_KEEPALIVE_S 30                // Broker keepalive
+#define MQTT_BACKOFF_MIN_MS 1000           // First retry delay after a failed connect
+#define MQTT_BACKOFF_MAX_MS 60000          // Retry delay cap
+#define MQTT_LOOP_INTERVAL_MS 1000         // serviceMQTT() interval while connected
+#define MQTT_DNS_REFRESH_FAILURES 5        // Consecutive failures before the broker name is resolved again
+
+// Outbound queue: publishes are queued and sent back-to-back by serviceMQTT()
+#define MQTT_OUTBOX_SLOTS 8
+#define MQTT_OUTBOX_PAYLOAD_BYTES 160      // Largest payload copied into a slot
+
+// Latency distribution over the most recent samples
+struct LatencyPercentiles {
+    uint32_t count;           // Samples in the window
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+};
+
+// Connection manager counters
+struct MqttStats {
+    uint32_t connects;        // Successful connects since boot
+    uint32_t failures;        // Failed connect attempts since boot
+    uint32_t outboxDropped;   // Publishes rejected because the outbox was full
+    uint8_t outboxQueued;     // Publishes waiting to be sent
+    LatencyPercentiles reconnectMs;  // Connection lost → connected again (ms)
+    LatencyPercentiles publishUs;    // Queued → written to the socket (µs)
+};
+
+// External client declarations
+extern WiFiClient espClient;     // WiFi client instance
+extern PubSubClient client;      // MQTT client instance
+
+// Function declarations
+void setupMQTT();                // Configures the client; connecting is left to serviceMQTT()
+bool connectMQTT();              // Makes one bounded connect attempt
+unsigned long serviceMQTT();     // Connects with backoff, runs loop() and drains the outbox; returns ms until the next call
+bool mqttConnected();            // True while connected to the broker
+bool mqttEnqueue(const char *topic, const char *payload, bool retain, bool copy); // Queues a publish (copy=false for static payloads)
+bool mqttPublishNow(const char *topic, const char *payload, bool retain);        // Publishes immediately, bypassing the outbox
+bool mqttPublishBinary(const char *topic, const uint8_t *payload, size_t length, bool retain); // Same, for binary payloads
+void mqttFlush();                // Sends everything in the outbox now
+void getMqttStats(MqttStats &out);  // Copies counters and latency percentiles
+void printMqttStats();           // Prints the connection and latency report
+
+#endif // MQTT_CLIENT_H
@@ -3,12 +3,46 @@
 
 #include <PubSubClient.h>
 
+// Set to 1 to publish all readings as one JSON document on a single state
+// topic, or 0 to publish one document per sensor on its own topic
+#define MQTT_COMBINED_STATE 1
+
+// Publish policy: a reading is sent when any metric leaves its deadband
+// around the last published value, but never more often than the minimum
+// interval and never less often than the maximum interval
+#define PUBLISH_MIN_INTERVAL_MS 30000UL    // 30 seconds between publishes at most
+#define PUBLISH_MAX_INTERVAL_MS 300000UL   // 5 minutes between publishes at least
+#define DEADBAND_TEMPERATURE 0.3           // °C
+#define DEADBAND_HUMIDITY 2.0              // %
+#define DEADBAND_PRESSURE 0.5              // hPa
+#define DEADBAND_ALTITUDE 3.0              // meters
+#define PUBLISH_BOOT_GRACE_MS 60000UL      // Readings are not queued while the network first comes up
+
+// Store-and-forward replay batching
+#define BACKLOG_RECORDS_PER_MESSAGE 4      // Queued readings per backlog message
+#define BACKLOG_MESSAGES_PER_CALL 8        // Backlog messages sent per publishBacklog() call
+
+// Outcome of publishSensorData() calls since boot
+struct PublishStats {
+    uint32_t published;       // Readings queued on the outbox
+    uint32_t failed;          // Calls that found the broker disconnected or the outbox full
+    uint32_t trendFailed;     // Trend documents that could not be queued (not replayed later)
+};
+
 // External MQTT client declaration
 extern PubSubClient client;
+extern bool discoveryPublished;         // Set once discovery was sent (RTC memory, kept across deep sleep)
 
 // Function declarations
 void publishMQTTStatus(bool online);    // Publishes device online/offline status
-void publishDiscoveryMessages();        // Publishes sensor discovery messages
-void publishSensorData();               // Publishes current sensor readings
+bool publishDiscoveryMessages();        // Publishes sensor discovery messages
+bool publishSensorData();               // Publishes current sensor readings
+void queueSensorData();                 // Stores current readings for replay after an outage
+bool publishBacklog();                  // Replays a batch of stored readings
+bool sensorDataPublishDue(unsigned long now);        // Checks deadbands and intervals against the last publish
+void markSensorDataPublished(unsigned long now);     // Counts the current readings as published (trace replay)
+void resetPublishPolicy();                          // Forgets the last publish, as after boot (trace replay)
+unsigned long msUntilForcedPublish(unsigned long now); // Time left before the maximum interval forces a publish
+void getPublishStats(PublishStats &out);             // Copies the publish counters
 
 #endif // MQTT_PUBLISHER_H
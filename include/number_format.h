@@ -0,0 +1,28 @@
+#ifndef NUMBER_FORMAT_H
+#define NUMBER_FORMAT_H
+
+#include <Arduino.h>
+
+// Largest number of decimal places supported by the fixed-point formatter
+#define FORMAT_MAX_DECIMALS 6
+
+/*
+ * Allocation-free number formatting for sensor values.
+ * Every append function writes at position pos of a caller buffer of the
+ * given size, keeps it NUL-terminated, truncates instead of overflowing,
+ * and returns the new position. Output matches printf("%.<decimals>f")
+ * for magnitudes below 1.8e19 / 10^decimals; larger values print "inf".
+ * JSON values are written as null when NAN or infinite, since JSON has no
+ * such numbers.
+ */
+size_t appendText(char *buf, size_t size, size_t pos, const char *text);          // Appends a string
+size_t appendFixed(char *buf, size_t size, size_t pos, float value, uint8_t decimals); // Appends a number
+size_t appendUInt(char *buf, size_t size, size_t pos, uint32_t value);            // Appends an integer
+size_t appendJsonNumber(char *buf, size_t size, size_t pos, float value, uint8_t decimals); // Appends a number or null
+size_t appendJsonField(char *buf, size_t size, size_t pos, const char *name,
+                       float value, uint8_t decimals);                            // Appends "name":value
+size_t appendJsonUInt(char *buf, size_t size, size_t pos, const char *name, uint32_t value); // Appends "name":integer
+size_t appendJsonString(char *buf, size_t size, size_t pos, const char *name, const char *text); // Appends "name":"text"
+size_t formatFixed(char *buf, size_t size, float value, uint8_t decimals);        // Formats a number from pos 0
+
+#endif // NUMBER_FORMAT_H
@@ -14,6 +14,7 @@
 #define SCREEN_HEIGHT 64          // Height of the OLED screen in pixels
 #define OLED_RESET -1             // Reset pin for OLED (not used with SSD1306)
 #define SCREEN_ADDRESS 0x3C       // I2C address for SSD1306 display
+#define OLED_ROW_HEIGHT 10        // Pixels per text row
 
 // External OLED display instance
 extern Adafruit_SSD1306 display;
@@ -31,5 +32,6 @@ void setupOLED();                     // Initializes OLED display
 void updateOLED();                    // Updates content on OLED screen
 void turnOffOLED();                   // Turns off the OLED screen
 void turnOnOLED();                    // Turns on the OLED screen
+bool enableButtonWakeup();            // Lets the button wake the chip from light sleep
 
 #endif // OLED_DISPLAY_H
@@ -0,0 +1,23 @@
+#ifndef OLED_RENDERER_H
+#define OLED_RENDERER_H
+
+#include <Adafruit_SSD1306.h>
+
+// Unchanged gaps shorter than this are resent rather than split into two
+// column windows, since every window costs a command transaction
+#define OLED_RENDER_MERGE_GAP 8
+
+// Bus traffic counters of the dirty-page renderer
+struct OLEDRenderStats {
+    uint32_t frames;           // Frames flushed
+    uint32_t unchangedFrames;  // Frames that needed no bus traffic
+    uint32_t lastFrameBytes;   // Bytes transmitted for the last frame
+    uint32_t totalBytes;       // Bytes transmitted since boot
+};
+
+// Function declarations
+void syncOLEDRenderer(Adafruit_SSD1306 &display);      // Records the framebuffer as already on the panel
+uint32_t flushOLEDChanges(Adafruit_SSD1306 &display);  // Sends only changed columns, returns bytes transmitted
+void getOLEDRenderStats(OLEDRenderStats &out);        // Copies the renderer counters
+
+#endif // OLED_RENDERER_H
@@ -0,0 +1,90 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <Arduino.h>
+
+// Set to 0 to compile out all profiling hooks
+#define ENABLE_PERF_STATS 1
+
+// Interval between profiling reports on the serial console
+#define PERF_REPORT_INTERVAL_MS (10UL * 60UL * 1000UL)
+
+// Hot-loop functions tracked by the profiler
+enum PerfSlot {
+    PERF_READ_BMP390,         // readBMP390Sensor()
+    PERF_READ_DHT,            // readDHTSensor()
+    PERF_UPDATE_OLED,         // updateOLED()
+    PERF_PUBLISH_SENSOR_DATA, // publishSensorData()
+    PERF_SERIAL_OUTPUT,       // serialOutputTask report body
+    PERF_I2C_BMP390,          // One BMP390 register transaction
+    PERF_I2C_SSD1306,         // One OLED frame flush
+    PERF_MQTT_PUBLISH,        // One client.publish() call
+    PERF_METRICS_SCRAPE,      // One /metrics response, accept to close
+    PERF_SLOT_COUNT
+};
+
+// Fixed log2 buckets: bucket 0 counts durations below 128 µs, bucket i
+// durations below 2^(i+7) µs, and the last bucket everything from 131 ms up
+#define PERF_HISTOGRAM_BUCKETS 12
+
+struct LatencyHistogram {
+    uint32_t counts[PERF_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * Maps a duration to its histogram bucket with one count-leading-zeros
+ * @param micros Duration (µs)
+ * @return Bucket index
+ */
+inline uint8_t histogramBucket(uint32_t micros) {
+    uint32_t scaled = micros >> 7;  // 0 below 128 µs
+    uint8_t bucket = scaled ? 32 - __builtin_clz(scaled) : 0;
+    return bucket < PERF_HISTOGRAM_BUCKETS ? bucket : PERF_HISTOGRAM_BUCKETS - 1;
+}
+
+// Accumulated statistics for one profiled function
+struct PerfCounters {
+    uint32_t calls;           // Number of measured calls
+    uint64_t totalMicros;     // Sum of call durations since boot or resetPerfStats() (µs), 64 bits so it never wraps
+    uint32_t minMicros;       // Fastest call (µs)
+    uint32_t maxMicros;       // Slowest call (µs)
+    int32_t maxHeapDelta;     // Largest drop in free heap across one call (bytes)
+    uint32_t bytesOut;        // Bytes written to the I2C bus or MQTT broker
+    LatencyHistogram histogram; // Distribution of call durations
+};
+
+// Start-of-call sample returned by perfBegin()
+struct PerfToken {
+    uint32_t startMicros;
+    uint32_t startFreeHeap;
+};
+
+#if ENABLE_PERF_STATS
+PerfToken perfBegin();                                // Samples time and free heap before a call
+void perfEnd(PerfSlot slot, const PerfToken &token);  // Records duration and heap delta of a call
+void perfRecord(PerfSlot slot, uint32_t micros);      // Records a duration measured by the caller (no heap sample)
+void perfAddBytes(PerfSlot slot, uint32_t bytes);     // Adds bytes written by a call
+void getPerfCounters(PerfSlot slot, PerfCounters &out); // Copies the counters of one slot
+void printPerfStats();                                // Prints the profiling table to Serial
+void resetPerfStats();                                // Clears all counters
+const char *perfSlotName(PerfSlot slot);              // Display name of a slot
+#else
+inline PerfToken perfBegin() { return PerfToken(); }
+inline void perfEnd(PerfSlot, const PerfToken &) {}
+inline void perfRecord(PerfSlot, uint32_t) {}
+inline void perfAddBytes(PerfSlot, uint32_t) {}
+inline void getPerfCounters(PerfSlot, PerfCounters &out) { memset(&out, 0, sizeof(out)); }
+inline void printPerfStats() {}
+inline void resetPerfStats() {}
+inline const char *perfSlotName(PerfSlot) { return ""; }
+#endif
+
+// Measures a single call expression into the given slot
+#define PERF_MEASURE(slot, call)          \
+    do {                                  \
+        PerfToken perfToken = perfBegin(); \
+        call;                             \
+        perfEnd(slot, perfToken);         \
+    } while (0)
+
+#endif // PERF_STATS_H
@@ -0,0 +1,52 @@
+#ifndef PRESSURE_TREND_H
+#define PRESSURE_TREND_H
+
+#include <Arduino.h>
+#include "include/sensor_registry.h"
+
+// Trend configuration
+#define TREND_POINT_INTERVAL_S 60         // One trend point per minute (mean of the readings in it)
+#define TREND_SHORT_POINTS 60             // 1 h regression window
+#define TREND_LONG_POINTS 180             // 3 h regression window
+#define TREND_SHORT_MIN_POINTS 15         // Points before the 1 h rate is reported
+#define TREND_LONG_MIN_POINTS 170         // Points before the 3 h change, tendency and forecast are reported
+#define TREND_BASE_HPA 1000.0f            // Points are stored as 0.01 hPa steps around this
+#define ZAMBRETTI_TREND_HPA 1.6f          // 3 h change that counts as rising or falling for the forecast
+
+#define FORECAST_STATE_TOPIC SENSOR_TOPIC_PREFIX "forecast/state"
+
+// WMO pressure tendency classes, by the size of the 3 h change
+enum PressureTendency {
+    TENDENCY_UNKNOWN,
+    TENDENCY_FALLING_VERY_RAPIDLY,  // more than 6.0 hPa
+    TENDENCY_FALLING_QUICKLY,       // 3.6 .. 6.0 hPa
+    TENDENCY_FALLING,               // 1.6 .. 3.5 hPa
+    TENDENCY_FALLING_SLOWLY,        // 0.1 .. 1.5 hPa
+    TENDENCY_STEADY,                // less than 0.1 hPa
+    TENDENCY_RISING_SLOWLY,
+    TENDENCY_RISING,
+    TENDENCY_RISING_QUICKLY,
+    TENDENCY_RISING_VERY_RAPIDLY
+};
+
+// Latest trend results
+struct PressureTrend {
+    float seaLevelPressure; // Newest trend point (hPa)
+    float rate1h;           // Regression slope over the last hour (hPa/h, NAN until TREND_SHORT_MIN_POINTS)
+    float change3h;         // Regression change over 3 hours (hPa, NAN until TREND_LONG_MIN_POINTS)
+    uint8_t tendency;       // PressureTendency (unknown while change3h is NAN)
+    uint8_t zambretti;      // Zambretti forecast number 1-32 (0 = unknown, while change3h is NAN)
+    uint16_t points;        // Points in the 3 h window
+};
+
+// Function declarations
+void pressureTrendAddSample(float seaLevelPressure);    // Feeds a smoothed reading (sensor task)
+void resetPressureTrend();                              // Forgets all points, as after a power-on
+bool getPressureTrend(PressureTrend &out);              // Copies the latest results; false before the 1 h rate
+const char *pressureTendencyName(uint8_t tendency);     // "Falling slowly", ...
+const char *zambrettiForecast(uint8_t zambretti);       // Forecast text for MQTT
+const char *zambrettiForecastShort(uint8_t zambretti);  // Forecast text that fits an OLED row
+bool publishPressureTrendDiscovery();                   // Queues the discovery documents of the trend sensors
+bool publishPressureTrend();                            // Queues the trend and forecast state document
+
+#endif // PRESSURE_TREND_H
@@ -0,0 +1,30 @@
+#ifndef SENSOR_MATH_H
+#define SENSOR_MATH_H
+
+#include <Arduino.h>
+#include "include/perf_stats.h"
+
+// Station configuration for derived quantities
+#define STATION_ELEVATION_M 0.0f        // Height of the station above sea level (meters)
+#define SEA_LEVEL_PRESSURE_HPA 1013.25f // Reference pressure for barometric altitude
+
+// Range covered by the altitude table; pressures outside are extrapolated
+#define ALTITUDE_TABLE_MIN_HPA 300.0f
+#define ALTITUDE_TABLE_STEP_HPA 4.0f
+#define ALTITUDE_TABLE_SIZE 239         // 300 .. 1252 hPa
+
+// Unit conversions shared by every output path
+inline float celsiusToFahrenheit(float celsius) { return celsius * 1.8f + 32.0f; }
+inline float metersToFeet(float meters) { return meters * 3.28084f; }
+
+// Function declarations
+void setupSensorMath();                                    // Builds the altitude table and station constants
+float pressureToAltitude(float pressureHPa);               // Barometric altitude without pow()
+void pressureToAltitudeBatch(const float *pressureHPa, float *altitude, size_t count); // Same, for sample batches
+float seaLevelPressure(float pressureHPa);                 // Station pressure reduced to sea level (hPa)
+float dewPoint(float temperature, float humidity);         // Dew point (°C)
+float heatIndex(float temperature, float humidity);        // NOAA heat index (°C)
+float absoluteHumidity(float temperature, float humidity); // Water vapour density (g/m³)
+void benchmarkSensorMath();                                // Prints table kernel vs pow() timing and error
+
+#endif // SENSOR_MATH_H
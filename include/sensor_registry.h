@@ -0,0 +1,85 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <Arduino.h>
+#include "include/sensor_snapshot.h"
+#include "include/mqtt_publisher.h"
+
+// MQTT topic layout shared by every registered sensor
+#define SENSOR_TOPIC_PREFIX "homeassistant/sensor/bmp390_"
+#define STATE_TOPIC_COMBINED SENSOR_TOPIC_PREFIX "weather/state"
+#if MQTT_COMBINED_STATE
+#define SENSOR_STATE_TOPIC(key) STATE_TOPIC_COMBINED
+#else
+#define SENSOR_STATE_TOPIC(key) SENSOR_TOPIC_PREFIX key "/state"
+#endif
+#define SENSOR_DISCOVERY_TOPIC(key) SENSOR_TOPIC_PREFIX key "/config"
+
+/*
+ * Sensor registry: one line per published metric. Topics, discovery
+ * documents, state JSON, deadbands, OLED rows and the serial report are
+ * all generated from this table; adding a metric means adding a line here
+ * and its SensorSnapshot field. A measured (not derived) metric must also
+ * be stored in QueuedReading (include/store_forward.h), which changes the
+ * on-flash record layout, and be restored by queuedReadingToSnapshot();
+ * otherwise readings replayed after an outage carry null for it.
+ *
+ *   key         JSON key, topic suffix and unique_id suffix
+ *   name        Home Assistant entity name
+ *   unit        Published unit
+ *   classJson   device_class or icon member of the discovery document
+ *   field       SensorSnapshot member that is published
+ *   decimals    Published precision
+ *   deadband    Change (published unit) that triggers an early publish
+ *   label       OLED and serial label
+ *   local       SensorSnapshot member shown first on the OLED and serial report
+ *   localUnit   Unit of local; field is shown after it when they differ
+ *   localDecimals Precision on the OLED
+ *   serialDecimals Precision on the serial report
+ *   oled        1 to give the metric an OLED row
+ */
+#define SENSOR_REGISTRY(X)                                                                        \
+    X(temperature, "BMP390 Temperature", "°F", "\"device_class\":\"temperature\"",                \
+      temperatureF, 2, DEADBAND_TEMPERATURE * 1.8f, "Temp", temperature, "C", 1, 2, 1)            \
+    X(humidity, "BMP390 Humidity", "%", "\"device_class\":\"humidity\"",                          \
+      humidity, 1, DEADBAND_HUMIDITY, "Humidity", humidity, "%", 1, 1, 1)                         \
+    X(altitude, "BMP390 Altitude", "ft", "\"icon\":\"mdi:altimeter\"",                            \
+      altitudeFt, 0, DEADBAND_ALTITUDE * 3.28084f, "Alt", altitude, "m", 0, 0, 1)                 \
+    X(pressure, "BMP390 Pressure", "hPa", "\"device_class\":\"pressure\"",                        \
+      pressure, 0, DEADBAND_PRESSURE, "Pressure", pressure, "hPa", 0, 0, 1)
+
+// Sensor ids in registry order
+enum SensorId {
+#define SENSOR_ID(key, ...) SENSOR_##key,
+    SENSOR_REGISTRY(SENSOR_ID)
+#undef SENSOR_ID
+    SENSOR_COUNT
+};
+
+// One registry entry; all strings are literals in flash
+struct SensorDescriptor {
+    const char *key;                    // JSON key
+    const char *stateTopic;             // State topic (combined or per sensor)
+    const char *discoveryTopic;         // Home Assistant discovery topic
+    const char *discoveryPayload;       // Complete discovery document
+    float SensorSnapshot::*field;       // Published value
+    uint8_t decimals;                   // Published precision
+    float deadband;                     // Early-publish threshold (published unit)
+    const char *label;                  // OLED and serial label
+    float SensorSnapshot::*local;       // Value shown first on the OLED and serial report
+    const char *localUnit;              // Unit of local
+    uint8_t localDecimals;              // OLED precision
+    uint8_t serialDecimals;             // Serial report precision
+    const char *unit;                   // Published unit
+    bool oled;                          // Shown on the OLED
+};
+
+extern const SensorDescriptor sensorRegistry[SENSOR_COUNT];
+
+// Function declarations
+size_t appendSensorJson(char *buf, size_t size, size_t pos, const SensorSnapshot &snap);  // Appends "key":value for every sensor
+size_t appendSensorDisplay(char *buf, size_t size, size_t pos, int sensor,
+                           const SensorSnapshot &snap, uint8_t decimals);                // Appends "Label: value unit"
+bool sensorsOutsideDeadband(const SensorSnapshot &current, const SensorSnapshot &published); // Any metric left its deadband
+
+#endif // SENSOR_REGISTRY_H
@@ -0,0 +1,39 @@
+#ifndef SENSOR_SNAPSHOT_H
+#define SENSOR_SNAPSHOT_H
+
+#include <Arduino.h>
+
+typedef void (*SnapshotListener)();  // Called by the writer after every update
+
+// One consistent set of sensor readings shared between tasks
+struct SensorSnapshot {
+    float temperature;      // Temperature (°C)
+    float pressure;         // Smoothed pressure (hPa)
+    float altitude;         // Smoothed altitude (meters)
+    float humidity;         // Relative humidity (%)
+
+    // Derived quantities, computed once per update by the writer
+    float temperatureF;     // Temperature (°F)
+    float altitudeFt;       // Smoothed altitude (feet)
+    float seaLevelPressure; // Pressure reduced to sea level (hPa)
+    float dewPoint;         // Dew point (°C)
+    float heatIndex;        // Heat index (°C)
+    float absoluteHumidity; // Water vapour density (g/m³)
+
+    uint32_t timestampMs;   // millis() of the newest sample in this set
+    uint32_t sequence;      // Number of updates published so far (0 = no data yet)
+};
+
+// Writer functions (bmpTask and dhtTask)
+void updateBMPSnapshot(float temperature, float pressure, float altitude); // Publishes a new BMP390 reading
+void updateHumiditySnapshot(float humidity);                                // Publishes a new DHT humidity reading
+void clearSensorSnapshot();                                                 // Sets every reading back to NAN, as at boot
+
+// Reader function (any task, lock-free)
+void readSensorSnapshot(SensorSnapshot &out);  // Copies a consistent set of readings
+void deriveSensorReadings(SensorSnapshot &s);  // Fills the derived fields from the raw values
+
+// Change notification
+void setSnapshotListener(SnapshotListener listener);  // Function to call after every update
+
+#endif // SENSOR_SNAPSHOT_H
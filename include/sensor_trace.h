@@ -0,0 +1,62 @@
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <Arduino.h>
+
+// Recording: every raw BMP390/DHT11 reading (and every failed read) as one
+// text line "~T,<ms>,<source>,<status>,<value1>,<value2>"
+#define TRACE_RECORD_SERIAL 0               // Print trace lines on the Serial Monitor
+#define TRACE_RECORD_FLASH 0                // Append trace lines to TRACE_FILE on LittleFS
+#define TRACE_FILE "/trace.txt"
+#define TRACE_FLASH_MAX_BYTES (512UL * 1024) // Recording to flash stops here
+#define TRACE_BUFFER_BYTES 512              // Lines buffered in RAM before one flash write
+
+// Replay: boot into a replay of TRACE_FILE, or of trace lines sent over
+// Serial when the file does not exist, instead of normal operation
+#define TRACE_REPLAY_MODE 0
+#define TRACE_REPLAY_BAUD 921600            // Serial speed while receiving a trace
+#define TRACE_REPLAY_IDLE_MS 5000           // Serial replay ends after this long without input
+#define TRACE_REPLAY_PRINT_PUBLISHES 1      // Print a "~P" line for every publish decision
+
+// Trace sources
+#define TRACE_SOURCE_BMP390 'B'             // value1 = temperature (°C), value2 = pressure (hPa)
+#define TRACE_SOURCE_DHT11 'D'              // value1 = humidity (%); status = DhtDecodeResult
+
+// One parsed trace line
+struct TraceLine {
+    uint32_t ms;                // millis() of the reading on the station
+    char source;                // TRACE_SOURCE_BMP390 or TRACE_SOURCE_DHT11
+    uint8_t status;             // 0 for a good reading, otherwise the failure code
+    float value1;
+    float value2;
+};
+
+// Replay results
+struct TraceReplayStats {
+    uint32_t lines;             // Trace lines replayed
+    uint32_t bmpReadings;       // Good BMP390 readings
+    uint32_t bmpFailures;       // Failed BMP390 reads
+    uint32_t dhtReadings;       // Good DHT11 readings
+    uint32_t dhtFailures;       // Failed DHT11 read attempts
+    uint32_t reboots;           // Places where the trace clock restarted
+    uint32_t publishes;         // Publish decisions
+    float maxPressureLag;       // Largest |smoothed - raw| pressure (hPa)
+    uint64_t firstMs;           // Virtual time of the first line
+    uint64_t lastMs;            // Virtual time of the last line
+};
+
+// Function declarations
+void setupTraceRecorder();                  // Opens the trace file when recording to flash
+void traceRecord(char source, uint8_t status, float value1, float value2); // Records one raw reading
+void traceFlush();                          // Writes buffered trace lines to flash
+uint32_t traceClockMs();                    // millis(), or the trace time during replay
+
+// Replay engine (also built into the host tools)
+bool parseTraceLine(const char *line, TraceLine &out);             // Parses a "~T," line
+void traceReplayBegin(TraceReplayStats &stats);                     // Switches to the trace clock, clears stats
+bool traceReplayLine(const char *line, TraceReplayStats &stats);    // Replays one line, false if not a trace line
+void traceReplayEnd();                                              // Switches back to millis()
+void printTraceReplaySummary(const TraceReplayStats &stats, unsigned long wallMs); // Prints the replay summary
+void runTraceReplay();                      // Replays a trace from flash or Serial; does not return
+
+#endif // SENSOR_TRACE_H
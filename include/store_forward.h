@@ -0,0 +1,44 @@
+#ifndef STORE_FORWARD_H
+#define STORE_FORWARD_H
+
+#include <Arduino.h>
+#include "include/sensor_snapshot.h"
+
+// Store-and-forward configuration
+#define STORE_FORWARD_DIR "/sf"                 // LittleFS directory holding the log segments
+#define STORE_FORWARD_SEGMENT_BYTES 4096        // One flash block per segment
+#define STORE_FORWARD_MAX_SEGMENTS 16           // Oldest segment is dropped beyond this (4096 readings)
+#define STORE_FORWARD_FLUSH_RECORDS 8           // Readings buffered in RAM before one flash write
+#define QUEUED_TIME_UPTIME 0x80000000UL         // Timestamp flag: seconds since boot, taken before NTP sync
+
+// One queued reading, stored as a fixed 16-byte record
+struct QueuedReading {
+    uint32_t timestamp;     // Unix time of the sample (s), or uptime (s) | QUEUED_TIME_UPTIME
+    uint32_t pressure;      // Pressure (0.01 hPa)
+    int32_t altitude;       // Altitude (0.01 m)
+    int16_t temperature;    // Temperature (0.01 °C)
+    uint16_t humidity;      // Relative humidity (0.1 %)
+};
+
+// Counters for flash traffic and replay throughput
+struct StoreForwardStats {
+    uint32_t pending;            // Readings waiting to be replayed
+    uint32_t appended;           // Readings queued since boot
+    uint32_t replayed;           // Readings replayed since boot
+    uint32_t dropped;            // Readings lost to segment rotation or without a datable timestamp
+    uint32_t flashBytesWritten;  // Bytes written to flash (records and cursor)
+    uint32_t lastReplayRecords;  // Readings sent by the last completed replay
+    uint32_t lastReplayMs;       // Duration of the last completed replay
+};
+
+// Function declarations
+bool setupStoreForward();                                        // Mounts LittleFS and recovers the queue
+void storeForwardAppend(const SensorSnapshot &snap, uint32_t timestamp); // Queues an unsent reading
+void queuedReadingToSnapshot(const QueuedReading &r, SensorSnapshot &snap); // Rebuilds a queued reading with derived values
+void storeForwardFlush();                                        // Writes buffered readings to flash
+uint32_t storeForwardPending();                                  // Readings waiting to be replayed
+size_t storeForwardPeek(QueuedReading *out, size_t maxRecords);  // Reads the oldest queued readings
+void storeForwardConsume(size_t records);                        // Drops readings that were replayed
+void getStoreForwardStats(StoreForwardStats &out);               // Copies the counters
+
+#endif // STORE_FORWARD_H
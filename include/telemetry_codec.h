@@ -0,0 +1,57 @@
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compact binary telemetry frame (all integers little-endian):
+ *
+ *   offset  size  content
+ *   0       1     format version (TELEMETRY_FORMAT_VERSION)
+ *   1       1     field count N
+ *   2       1     sample count S
+ *   3       4     timestamp of the first sample (Unix time, s)
+ *   7       N     decimals of each field
+ *   7+N     ...   S samples
+ *
+ * Each sample is 1 + N zigzag varints (LEB128): the timestamp change from
+ * the previous sample, then for every field the change of
+ * round(value * 10^decimals) from the previous sample (from 0 for the
+ * first one). A missing value (NaN) is encoded as INT32_MIN; deltas use
+ * 32-bit wrap-around so every value round-trips exactly.
+ */
+#define TELEMETRY_FORMAT_VERSION 1
+#define TELEMETRY_MAX_FIELDS 16
+#define TELEMETRY_MAX_SAMPLES 255
+#define TELEMETRY_HEADER_BYTES(fields) ((size_t)7 + (fields))
+#define TELEMETRY_MAX_SAMPLE_BYTES(fields) ((size_t)5 * (1 + (fields)))  // Worst case per sample
+
+// Encoder state for one frame in a caller-provided buffer
+struct TelemetryEncoder {
+    uint8_t *buf;
+    size_t size;
+    size_t length;                      // Bytes written so far
+    uint8_t fieldCount;
+    uint8_t samples;                    // Samples in the frame
+    uint32_t lastTimestamp;
+    int32_t last[TELEMETRY_MAX_FIELDS]; // Scaled values of the previous sample
+    int32_t scale[TELEMETRY_MAX_FIELDS]; // 10^decimals of each field
+};
+
+// One decoded sample
+struct TelemetrySample {
+    uint32_t timestamp;                 // Unix time (s)
+    float values[TELEMETRY_MAX_FIELDS]; // NaN for missing values
+};
+
+// Function declarations (no Arduino dependencies, so the collector can build them)
+bool telemetryBegin(TelemetryEncoder &enc, uint8_t *buf, size_t size,
+                    const uint8_t *decimals, uint8_t fieldCount);     // Starts a frame
+bool telemetryAppend(TelemetryEncoder &enc, uint32_t timestamp,
+                     const float *values);                             // Adds a sample, false if it does not fit
+size_t telemetryLength(const TelemetryEncoder &enc);                   // Frame length, 0 while empty
+int telemetryDecode(const uint8_t *frame, size_t length, TelemetrySample *samples, size_t maxSamples,
+                    uint8_t &fieldCount);                              // Decodes a frame, -1 if malformed
+
+#endif // TELEMETRY_CODEC_H
@@ -4,7 +4,9 @@
 #include <time.h>
 
 // Function declarations
-void setupTime();           // Initializes NTP time synchronization
+void setupTime();           // Starts NTP time synchronization in the background
+bool timeSynced();          // True once NTP time has been received
+bool waitForTimeSync(unsigned long timeoutMs); // Blocks until synced or the timeout expires
 void updateTimeString();    // Updates formatted time string
 const char* getTimeString(); // Returns current formatted time string
 
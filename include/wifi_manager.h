@@ -4,8 +4,23 @@
 #include <WiFi.h>
 #include "include/secrets.h"  // Includes Wi-Fi credentials
 
+// Connection timing
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000   // Time allowed to join the cached access point before scanning
+#define WIFI_CONNECT_TIMEOUT_MS 15000       // Time allowed for a full scan and join before retrying
+#define WIFI_POLL_INTERVAL_MS 100           // maintainWiFi() interval while connecting
+#define WIFI_CHECK_INTERVAL_MS 10000        // maintainWiFi() interval while connected
+
+// Set to 1 to use a fixed address instead of DHCP
+#define WIFI_USE_STATIC_IP 0
+#define WIFI_STATIC_IP 192, 168, 1, 50
+#define WIFI_GATEWAY 192, 168, 1, 1
+#define WIFI_SUBNET 255, 255, 255, 0
+#define WIFI_DNS 192, 168, 1, 1
+
 // Function declarations
-void setupWiFi();     // Sets up Wi-Fi connection
-void maintainWiFi();  // Maintains Wi-Fi connection
+void setupWiFi();              // Starts connecting in the background
+unsigned long maintainWiFi();  // Advances the connection, returns ms until the next call
+bool wifiConnected();          // True while connected with an IP address
+bool connectWiFi(unsigned long timeoutMs);  // Connects once, without restarting on failure
 
 #endif // WIFI_MANAGER_H
@@ -6,158 +6,303 @@
 #include "include/mqtt_publisher.h"
 #include "include/oled_display.h"
 #include "include/time_manager.h"
+#include "include/perf_stats.h"
+#include "include/sensor_snapshot.h"
+#include "include/history_store.h"
+#include "include/store_forward.h"
+#include "include/number_format.h"
+#include "include/sensor_math.h"
+#include "include/job_scheduler.h"
+#include "include/duty_cycle.h"
+#include "include/boot_trace.h"
+#include "include/diagnostics.h"
+#include "include/i2c_bus.h"
+#include "include/sensor_registry.h"
+#include "include/binary_telemetry.h"
+#include "include/sensor_trace.h"
+#include "include/deferred_log.h"
+#include "include/pressure_trend.h"
+#include "include/adaptive_sampling.h"
+#include "include/metrics_server.h"
 
-// Task handle declarations for FreeRTOS tasks
-TaskHandle_t wifiTaskHandle;
-TaskHandle_t dhtTaskHandle;
-TaskHandle_t bmpTaskHandle;
-TaskHandle_t mqttTaskHandle;
-TaskHandle_t oledTaskHandle;
-TaskHandle_t serialOutputTaskHandle;
+// Job ids returned by the scheduler
+int wifiJobId = -1;
+int dhtJobId = -1;
+int bmpJobId = -1;
+int mqttJobId = -1;
 
-// Timing variable for serial output
-unsigned long lastSerialPrintTime = 0;
+// Set while the MQTT job waits for the next reading
+volatile bool mqttWaitingForReadings = false;
 
 /**
- * Wi-Fi task: Maintains Wi-Fi connection
+ * Wi-Fi job: Maintains Wi-Fi connection
+ * Polls quickly while a connection attempt is in progress
  */
-void wifiTask(void *pvParameters) {
-    setupWiFi();
-    while (1) {
-        maintainWiFi(); // Keep Wi-Fi connected
-        vTaskDelay(pdMS_TO_TICKS(10000)); // Check Wi-Fi every 10 seconds
-    }
+void wifiJob() {
+    scheduleJobIn(wifiJobId, maintainWiFi()); // Keep Wi-Fi connected
 }
 
 /**
- * DHT Sensor Task: Reads humidity sensor
+ * Queues a due reading while offline
+ * Nothing is queued during the first minute after boot, while the network
+ * is still coming up; those readings are simply published once connected.
  */
-void dhtTask(void *pvParameters) {
-    vTaskDelay(pdMS_TO_TICKS(2000));  // Initial delay for sensor initialization
-    while (1) {
-        readDHTSensor();
-        vTaskDelay(pdMS_TO_TICKS(2000)); // Read every 2 seconds
+void queueIfOffline() {
+    unsigned long now = millis();
+    if (now >= PUBLISH_BOOT_GRACE_MS && sensorDataPublishDue(now)) {
+        queueSensorData();
     }
 }
 
 /**
- * BMP390 Sensor Task: Reads temperature, pressure and altitude
+ * DHT Sensor job: Reads humidity sensor
+ * Runs once per read step (start signal, capture, decode)
+ */
+void dhtJob() {
+    unsigned long waitMs;
+    PERF_MEASURE(PERF_READ_DHT, waitMs = readDHTSensor());
+    scheduleJobIn(dhtJobId, waitMs);
+}
+
+/**
+ * BMP390 Sensor job: Reads temperature, pressure and altitude
+ * Reschedules itself at the adaptive read interval
  */
-void bmpTask(void *pvParameters) {
-    while (1) {
-        readBMP390Sensor();
-        vTaskDelay(pdMS_TO_TICKS(5000)); // Read every 5 seconds
+void bmpJob() {
+    PERF_MEASURE(PERF_READ_BMP390, readBMP390Sensor());
+    scheduleJobIn(bmpJobId, samplingIntervalMs(SAMPLING_BMP390));
+}
+
+/**
+ * OLED job: Refreshes the display
+ */
+void oledJob() {
+    PERF_MEASURE(PERF_UPDATE_OLED, updateOLED());
+}
+
+/**
+ * Snapshot listener: wakes the MQTT job after every new reading
+ */
+void onNewReading() {
+    if (mqttWaitingForReadings) {
+        triggerJob(mqttJobId);
     }
 }
 
 /**
- * MQTT Task: Handles MQTT communication
+ * MQTT job: Handles MQTT communication
+ * Services the connection manager at least every second and runs after
+ * every new reading while connected; publishes only when the deadband
+ * policy in sensorDataPublishDue() says so
  */
-void mqttTask(void *pvParameters) {
-    setupMQTT();  // Initial setup here
-    int reconnectAttempts = 0;
-    static bool discoveryPublished = false;  // Track if discovery has been sent
-    
-    // Delay for 1 minute to allow sensors to stabilize before first publish
-    vTaskDelay(pdMS_TO_TICKS(60000)); 
-    
-    while (1) {
-        if (!client.connected()) {
-            // Attempt to reconnect up to 3 times
-            while (!client.connected() && reconnectAttempts < 3) {
-                setupMQTT();  // Attempt to reconnect immediately
-                reconnectAttempts++;
-                if (!client.connected()) {
-                    vTaskDelay(pdMS_TO_TICKS(1666));
-                }
-            }
+void mqttJob() {
+    static bool listening = false;
 
-            if (!client.connected()) {
-                Serial.println("⚠️ MQTT Reconnection Failed after 3 attempts! Retrying in 5 seconds...");
-                reconnectAttempts = 0;
-                vTaskDelay(pdMS_TO_TICKS(5000));
-            } else {
-                reconnectAttempts = 0;
-            }
-        }
+    mqttWaitingForReadings = false;
+    if (!listening) {
+        setSnapshotListener(onNewReading);  // Wake on every new sensor reading
+        listening = true;
+    }
 
-        if (client.connected()) {
-            // Send discovery message before first publish if not already sent
-            if (!discoveryPublished) {
-                Serial.println("Sending MQTT Discovery messages...");
-                vTaskDelay(pdMS_TO_TICKS(1000));  // Wait a second for connection stability
-                discoveryPublished = publishDiscoveryMessages();
-            }
+    // Reconnect with backoff, keepalive and queued publishes
+    unsigned long serviceMs = serviceMQTT();
+    if (!mqttConnected()) {
+        // Keep readings that would have been published for later replay
+        queueIfOffline();
+        scheduleJobIn(mqttJobId, min(serviceMs, 1000UL));
+        return;
+    }
 
-            publishSensorData();
-            Serial.println("📡 MQTT Sensor Data Published!");
+    // Send discovery message before first publish if not already sent
+    if (!discoveryPublished) {
+        LOG_INFO("Sending MQTT Discovery messages...");
+        publishDiscoveryMessages();
+    }
+
+    if (sensorDataPublishDue(millis())) {
+        bool published = false;
+        PERF_MEASURE(PERF_PUBLISH_SENSOR_DATA, published = publishSensorData());
+        mqttFlush();  // Discovery and state go out back-to-back
+        if (published) {
+            LOG_INFO("📡 MQTT Sensor Data Published!");
+            if (bootTraceTime(BOOT_FIRST_PUBLISH) == 0) {
+                bootTraceMark(BOOT_FIRST_PUBLISH);
+                printBootTrace();
+            }
         } else {
-            vTaskDelay(pdMS_TO_TICKS(5000));
-            continue;
+            queueSensorData();
         }
+    }
 
-        client.loop();
-        vTaskDelay(pdMS_TO_TICKS(300000)); // Publish every 5 minutes
+    // Replay readings stored during an outage, once NTP can date them
+    if (storeForwardPending() > 0 && timeSynced()) {
+        publishBacklog();
+        if (storeForwardPending() > 0) {
+            scheduleJobIn(mqttJobId, 100);  // Keep replaying the backlog
+            return;
+        }
     }
+
+    // Sleep until a sensor job posts a new reading, the connection needs
+    // servicing or the maximum interval runs out
+    unsigned long waitMs = max(msUntilForcedPublish(millis()), 1000UL);  // Retry a due publish after 1 second
+    scheduleJobIn(mqttJobId, min(waitMs, serviceMs));
+    mqttWaitingForReadings = true;
 }
 
 /**
- * Serial output task: Prints sensor data periodically
+ * Serial report job: Prints sensor data every minute
  */
-void serialOutputTask(void *pvParameters) {
-    while (1) {
-        unsigned long currentTime = millis();
+void serialReportJob() {
+    PerfToken perfToken = perfBegin();
+
+    updateTimeString();  // Ensure timestamp is updated
 
-        if (currentTime - lastSerialPrintTime >= 60000) {  // Print every 1 minute
-            lastSerialPrintTime = currentTime;
+    // Take one consistent set of readings for the report
+    SensorSnapshot snap;
+    readSensorSnapshot(snap);
 
-            updateTimeString();  // Ensure timestamp is updated
+    // Print every registered sensor in registry order
+    char line[160];
+    size_t len = appendText(line, sizeof(line), 0, getTimeString());
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        len = appendText(line, sizeof(line), len, " | ");
+        len = appendSensorDisplay(line, sizeof(line), len, i, snap, sensorRegistry[i].serialDecimals);
+    }
+    reportPrintln(line);
+    perfEnd(PERF_SERIAL_OUTPUT, perfToken);
+}
+
+/**
+ * History report job: Prints the 24-hour summary and the pressure trend every hour
+ */
+void historyReportJob() {
+    HistoryStats tempStats, pressureStats;
+    float pressure3hAgo;
+    if (historyGetStats(HISTORY_TEMPERATURE, 24 * 60, tempStats) &&
+        historyGetStats(HISTORY_PRESSURE, 24 * 60, pressureStats) &&
+        historyGetValue(HISTORY_PRESSURE, 3 * 60, pressure3hAgo)) {
+        float pressureNow;
+        historyGetValue(HISTORY_PRESSURE, 0, pressureNow);
+        float pressureChange = pressureNow - pressure3hAgo;
 
-            // Convert and Smooth Values
-            float temperatureF = (temperature * 9 / 5) + 32;
-            float altitudeFt = altitude * 3.28084;
-            float smoothedAltitudeM = altitude;  // Placeholder for smoothing logic if needed
-            float smoothedAltitudeF = altitudeFt;
+        char line[128];
+        size_t len = appendText(line, sizeof(line), 0, "📈 Last ");
+        len = appendUInt(line, sizeof(line), len, tempStats.rows);
+        len = appendText(line, sizeof(line), len, " min | Temp: ");
+        len = appendFixed(line, sizeof(line), len, tempStats.min, 1);
+        len = appendText(line, sizeof(line), len, "..");
+        len = appendFixed(line, sizeof(line), len, tempStats.max, 1);
+        len = appendText(line, sizeof(line), len, " C | Pressure: ");
+        len = appendFixed(line, sizeof(line), len, pressureStats.min, 1);
+        len = appendText(line, sizeof(line), len, "..");
+        len = appendFixed(line, sizeof(line), len, pressureStats.max, 1);
+        len = appendText(line, sizeof(line), len, signbit(pressureChange) ? " hPa | 3h change: " : " hPa | 3h change: +");
+        len = appendFixed(line, sizeof(line), len, pressureChange, 1);
+        appendText(line, sizeof(line), len, " hPa");
+        reportPrintln(line);
+    }
 
-            // Print Serial Output in Correct Order
-            Serial.printf("%s | Temp: %.2f C / %.2f F | Humidity: %.1f%% | Alt: %.0f m / %.0f ft | Pressure: %.0f hPa\n",
-                          getTimeString(), temperature, temperatureF, humidity, smoothedAltitudeM, smoothedAltitudeF, pressure);
+    PressureTrend trend;
+    if (getPressureTrend(trend)) {
+        char line[128];
+        size_t len = appendText(line, sizeof(line), 0, "🌦️ Trend: ");
+        len = appendFixed(line, sizeof(line), len, trend.rate1h, 2);
+        len = appendText(line, sizeof(line), len, " hPa/h");
+        if (isnan(trend.change3h)) {
+            appendText(line, sizeof(line), len, " | 3h change and forecast once 3 hours are recorded");
+        } else {
+            len = appendText(line, sizeof(line), len, ", ");
+            len = appendFixed(line, sizeof(line), len, trend.change3h, 1);
+            len = appendText(line, sizeof(line), len, " hPa/3h, ");
+            len = appendText(line, sizeof(line), len, pressureTendencyName(trend.tendency));
+            len = appendText(line, sizeof(line), len, " | Forecast: ");
+            appendText(line, sizeof(line), len, zambrettiForecast(trend.zambretti));
         }
-
-        vTaskDelay(pdMS_TO_TICKS(1000));  // Task runs every second, but serial prints every minute
+        reportPrintln(line);
     }
 }
 
-// Declaration of oledTask function before setup
-void oledTask(void *pvParameters);
+/**
+ * Profiling report job: Prints the profiling, scheduler, MQTT, I2C, logging and sampling tables every 10 minutes
+ */
+void perfReportJob() {
+    printPerfStats();
+    printSchedulerStats();
+    printMqttStats();
+    printI2CBusStats();
+    printLogStats();
+    printSamplingStats();
+#if METRICS_SERVER
+    printMetricsStats();
+#endif
+}
+
+/**
+ * Diagnostics job: Publishes runtime telemetry every 5 minutes
+ */
+void diagnosticsJob() {
+    publishDiagnostics();
+}
 
 void setup() {
     Serial.begin(115200);
+    setupLog();  // Before anything that logs
+
+#if DUTY_CYCLE_MODE
+    runDutyCycle();  // Samples, publishes and deep-sleeps; does not return
+#endif
+#if TRACE_REPLAY_MODE
+    runTraceReplay();  // Replays a recorded trace offline; does not return
+#endif
     
-    setupWiFi();
-    setupTime();
+    // Local hardware first, so readings and the display come up immediately
+    setupI2CBus();
+    setupSensorMath();
     setupDHTSensor();
     setupBMP390Sensor();
-    setupMQTT();
+    bootTraceMark(BOOT_SENSORS_READY);
     setupOLED();
+    bootTraceMark(BOOT_DISPLAY_READY);
 
-    // Initialize FreeRTOS Tasks
-    xTaskCreatePinnedToCore(wifiTask, "WiFiTask", 4096, NULL, 1, &wifiTaskHandle, 0);
-    xTaskCreatePinnedToCore(dhtTask, "DHTTask", 3072, NULL, 1, &dhtTaskHandle, 1);
-    xTaskCreatePinnedToCore(bmpTask, "BMPTask", 2048, NULL, 1, &bmpTaskHandle, 1);
-    xTaskCreatePinnedToCore(mqttTask, "MQTTTask", 4096, NULL, 1, &mqttTaskHandle, 0);
-    xTaskCreatePinnedToCore(oledTask, "OLEDTask", 4096, NULL, 1, &oledTaskHandle, 1);
-    xTaskCreatePinnedToCore(serialOutputTask, "SerialOutputTask", 4096, NULL, 1, &serialOutputTaskHandle, 0);
-}
+    // Networking converges in the background: the Wi-Fi job completes the
+    // connection, SNTP syncs on its own and the MQTT job connects once
+    // Wi-Fi is up
+    setupWiFi();
+    setupTime();
+    setupMQTT();
+#if METRICS_SERVER
+    setupMetricsServer();  // Serves /metrics from its own task once Wi-Fi is up
+#endif
 
-void loop() {
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    setupHistory();
+    setupStoreForward();
+    setupTraceRecorder();
+    benchmarkSensorMath();
+    benchmarkTelemetry();
+
+    // Sensors and display share one scheduler task on core 1
+    dhtJobId = addJob(SCHEDULER_SENSORS, "readDHT", dhtJob,
+                      SAMPLING_DHT11_DEFAULT_MS, 1000);                // Adaptive, DHT11 needs 1 s after power-up
+    bmpJobId = addJob(SCHEDULER_SENSORS, "readBMP390", bmpJob,
+                      SAMPLING_BMP390_DEFAULT_MS, 0);                  // Adaptive, 2-60 s
+    addJob(SCHEDULER_SENSORS, "updateOLED", oledJob, 3000, 0);         // Every 3 s
+
+    // Networking and reports share one scheduler task on core 0
+    wifiJobId = addJob(SCHEDULER_NETWORK, "maintainWiFi", wifiJob,
+                       WIFI_CHECK_INTERVAL_MS, WIFI_POLL_INTERVAL_MS); // Polls while connecting, then every 10 s
+    mqttJobId = addJob(SCHEDULER_NETWORK, "mqtt", mqttJob,
+                       PUBLISH_MAX_INTERVAL_MS, 0);                    // Publishes as soon as Wi-Fi and both sensors are up
+    addJob(SCHEDULER_NETWORK, "serialReport", serialReportJob, 60000, 60000);
+    addJob(SCHEDULER_NETWORK, "historyReport", historyReportJob, 3600000, 3600000);
+    addJob(SCHEDULER_NETWORK, "perfReport", perfReportJob, PERF_REPORT_INTERVAL_MS, PERF_REPORT_INTERVAL_MS);
+    addJob(SCHEDULER_NETWORK, "diagnostics", diagnosticsJob, DIAGNOSTICS_INTERVAL_MS, DIAGNOSTICS_INTERVAL_MS);
+
+    startSchedulers();
+    bootTraceMark(BOOT_SCHEDULER_STARTED);
 }
 
-// Implementation of oledTask after setup
-void oledTask(void *pvParameters) {
-    while (1) {
-        updateOLED();
-        vTaskDelay(pdMS_TO_TICKS(3000));
-    }
+void loop() {
+    // All work runs as scheduler jobs; free the Arduino loop task and its stack
+    vTaskDelete(NULL);
 }
@@ -0,0 +1,221 @@
+#include "include/adaptive_sampling.h"
+#include "include/deferred_log.h"
+#include "include/sensor_trace.h"
+#include "include/duty_cycle.h"
+
+/*
+ * Each metric keeps an exponentially weighted mean and variance whose
+ * weight depends on the time since the previous reading, so the window is
+ * SAMPLING_TAU_MS long whatever the read rate. When any metric of a sensor
+ * moves by more than its threshold the sensor drops to its fastest
+ * interval at once; after SAMPLING_HOLD_MS of calm the interval doubles,
+ * step by step, up to the slowest interval.
+ */
+struct MetricConfig {
+    SamplingSource source;
+    float threshold;          // Standard deviation that counts as moving
+    const char *name;
+    const char *unit;
+};
+
+struct SourceConfig {
+    const char *name;
+    uint32_t minMs;
+    uint32_t maxMs;
+    uint32_t defaultMs;
+};
+
+static const MetricConfig metricConfig[SAMPLING_METRIC_COUNT] = {
+    {SAMPLING_BMP390, SAMPLING_ACTIVITY_PRESSURE, "pressure", "hPa"},
+    {SAMPLING_BMP390, SAMPLING_ACTIVITY_TEMPERATURE, "temperature", "C"},
+    {SAMPLING_DHT11, SAMPLING_ACTIVITY_HUMIDITY, "humidity", "%"}
+};
+
+static const SourceConfig sourceConfig[SAMPLING_SOURCE_COUNT] = {
+    {"BMP390", SAMPLING_BMP390_MIN_MS, SAMPLING_BMP390_MAX_MS, SAMPLING_BMP390_DEFAULT_MS},
+    {"DHT11", SAMPLING_DHT11_MIN_MS, SAMPLING_DHT11_MAX_MS, SAMPLING_DHT11_DEFAULT_MS}
+};
+
+struct MetricState {
+    bool seeded;
+    float mean;
+    float variance;
+    uint32_t lastMs;          // Time of the previous reading
+};
+
+struct SourceState {
+    uint32_t intervalMs;
+    uint32_t lastActiveMs;    // Last reading with activity at or above 1
+    uint32_t lastChangeMs;    // Last interval change
+    uint32_t firstMs;         // First reading
+    uint32_t lastMs;          // Latest reading
+    uint32_t samples;
+    uint32_t minimumMs;       // Time spent at the fastest interval
+    uint16_t faster;
+    uint16_t slower;
+};
+
+static MetricState metrics[SAMPLING_METRIC_COUNT];
+static SourceState sources[SAMPLING_SOURCE_COUNT] = {
+    {SAMPLING_BMP390_DEFAULT_MS, 0, 0, 0, 0, 0, 0, 0, 0},
+    {SAMPLING_DHT11_DEFAULT_MS, 0, 0, 0, 0, 0, 0, 0, 0}
+};
+static portMUX_TYPE samplingMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Updates a metric's moving mean and variance with a new reading
+ * @param metric Metric
+ * @param value Reading (offsets applied, before smoothing)
+ */
+void samplingAddReading(SamplingMetric metric, float value) {
+    if (isnan(value)) return;
+    MetricState &m = metrics[metric];
+    uint32_t now = traceClockMs();
+
+    taskENTER_CRITICAL(&samplingMux);
+    if (!m.seeded || (int32_t)(now - m.lastMs) < 0) {
+        m.seeded = true;
+        m.mean = value;
+        m.variance = 0;
+    } else {
+        // Weight of the new reading grows with the time since the last one
+        float alpha = 1.0f - expf(-(float)(now - m.lastMs) / SAMPLING_TAU_MS);
+        float diff = value - m.mean;
+        float increment = alpha * diff;
+        m.mean += increment;
+        m.variance = (1.0f - alpha) * (m.variance + diff * increment);
+    }
+    m.lastMs = now;
+    taskEXIT_CRITICAL(&samplingMux);
+}
+
+/**
+ * Returns the largest activity among a sensor's metrics
+ * @return Standard deviation relative to the threshold
+ */
+static float sourceActivity(SamplingSource source) {
+    float activity = 0;
+    for (int i = 0; i < SAMPLING_METRIC_COUNT; i++) {
+        if (metricConfig[i].source != source || !metrics[i].seeded) continue;
+        activity = max(activity, sqrtf(metrics[i].variance) / metricConfig[i].threshold);
+    }
+    return activity;
+}
+
+/**
+ * Adapts a sensor's read interval after a successful reading
+ * Moving readings select the fastest interval at once; calm readings
+ * double it after SAMPLING_HOLD_MS, up to the slowest interval
+ *
+ * @param source Sensor that was read
+ * @return Interval until the next reading (ms)
+ */
+unsigned long samplingUpdate(SamplingSource source) {
+    const SourceConfig &c = sourceConfig[source];
+    SourceState &s = sources[source];
+    uint32_t now = traceClockMs();
+
+    taskENTER_CRITICAL(&samplingMux);
+    if (s.samples == 0) {
+        s.firstMs = now;
+        s.lastActiveMs = now;
+        s.lastChangeMs = now;
+    } else if (s.intervalMs == c.minMs) {
+        s.minimumMs += now - s.lastMs;
+    }
+    s.lastMs = now;
+    s.samples++;
+
+#if ADAPTIVE_SAMPLING && !DUTY_CYCLE_MODE
+    float activity = sourceActivity(source);
+    if (activity >= 1.0f) {
+        s.lastActiveMs = now;
+        if (s.intervalMs != c.minMs) {
+            s.intervalMs = c.minMs;
+            s.lastChangeMs = now;
+            s.faster++;
+        }
+    } else if (activity < SAMPLING_CALM_RATIO && s.intervalMs < c.maxMs &&
+               now - s.lastActiveMs >= SAMPLING_HOLD_MS && now - s.lastChangeMs >= SAMPLING_HOLD_MS) {
+        s.intervalMs = min(s.intervalMs * 2, c.maxMs);
+        s.lastChangeMs = now;
+        s.slower++;
+    }
+#endif
+    uint32_t interval = s.intervalMs;
+    taskEXIT_CRITICAL(&samplingMux);
+    return interval;
+}
+
+/**
+ * Returns a sensor's current read interval
+ * @param source Sensor
+ * @return Interval (ms)
+ */
+unsigned long samplingIntervalMs(SamplingSource source) {
+    return sources[source].intervalMs;
+}
+
+/**
+ * Copies a sensor's read rate counters
+ * @param source Sensor
+ * @param out Destination for the counters
+ */
+void getSamplingStats(SamplingSource source, SamplingStats &out) {
+    taskENTER_CRITICAL(&samplingMux);
+    SourceState s = sources[source];
+    taskEXIT_CRITICAL(&samplingMux);
+
+    uint32_t span = s.lastMs - s.firstMs;
+    out.name = sourceConfig[source].name;
+    out.intervalMs = s.intervalMs;
+    out.samples = s.samples;
+    out.averageMs = s.samples > 1 ? span / (s.samples - 1) : s.intervalMs;
+    out.minimumPercent = span ? 100.0f * s.minimumMs / span : 0;
+    out.faster = s.faster;
+    out.slower = s.slower;
+}
+
+/**
+ * Returns the moving standard deviation of a metric
+ * @param metric Metric
+ * @return Standard deviation (metric unit), NAN before the first reading
+ */
+float samplingDeviation(SamplingMetric metric) {
+    return metrics[metric].seeded ? sqrtf(metrics[metric].variance) : NAN;
+}
+
+/**
+ * Returns the name of a metric
+ * @param metric Metric
+ */
+const char *samplingMetricName(SamplingMetric metric) {
+    return metricConfig[metric].name;
+}
+
+/**
+ * Returns the sensor that reads a metric
+ * @param metric Metric
+ */
+SamplingSource samplingMetricSource(SamplingMetric metric) {
+    return metricConfig[metric].source;
+}
+
+/**
+ * Prints the read interval of every sensor and the activity of its metrics
+ */
+void printSamplingStats() {
+    reportPrintln("🎚️ Sampling:");
+    for (int i = 0; i < SAMPLING_SOURCE_COUNT; i++) {
+        SamplingStats stats;
+        getSamplingStats((SamplingSource)i, stats);
+        reportPrintf("   %-6s every %5.1f s (avg %5.1f s, %4.1f%% at %.1f s), %lu reads, %u faster, %u slower\n",
+                     stats.name, stats.intervalMs / 1000.0f, stats.averageMs / 1000.0f, stats.minimumPercent,
+                     sourceConfig[i].minMs / 1000.0f, (unsigned long)stats.samples, stats.faster, stats.slower);
+        for (int m = 0; m < SAMPLING_METRIC_COUNT; m++) {
+            if (metricConfig[m].source != i) continue;
+            reportPrintf("      %-12s sd %7.3f %-3s (moving above %.3f)\n", metricConfig[m].name,
+                         samplingDeviation((SamplingMetric)m), metricConfig[m].unit, metricConfig[m].threshold);
+        }
+    }
+}
@@ -0,0 +1,172 @@
+#include "include/binary_telemetry.h"
+#include "include/mqtt_client.h"
+#include "include/mqtt_publisher.h"
+#include "include/store_forward.h"
+#include "include/number_format.h"
+#include "include/perf_stats.h"
+#include "include/deferred_log.h"
+
+/*
+ * Frames carry the registry fields in registry order with their published
+ * precision, so a collector only needs the registry keys to label them.
+ */
+static uint8_t liveFrame[TELEMETRY_FRAME_BYTES];
+static TelemetryEncoder liveEncoder;        // buf stays NULL until the first reading
+static uint32_t droppedReadings = 0;        // Readings lost because frames could not be sent
+
+/**
+ * Starts a frame with the registry's field layout
+ */
+static void beginFrame(TelemetryEncoder &enc, uint8_t *buf, size_t size) {
+    uint8_t decimals[SENSOR_COUNT];
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        decimals[i] = sensorRegistry[i].decimals;
+    }
+    telemetryBegin(enc, buf, size, decimals, SENSOR_COUNT);
+}
+
+/**
+ * Adds one reading to a frame
+ * @return false if the frame is full
+ */
+static bool appendReading(TelemetryEncoder &enc, const SensorSnapshot &snap, uint32_t timestamp) {
+    float values[SENSOR_COUNT];
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        values[i] = snap.*sensorRegistry[i].field;
+    }
+    return telemetryAppend(enc, timestamp, values);
+}
+
+/**
+ * Publishes a frame to the telemetry topic
+ */
+static bool publishFrame(const TelemetryEncoder &enc) {
+    return mqttPublishBinary(TELEMETRY_TOPIC, enc.buf, telemetryLength(enc), false);
+}
+
+/**
+ * Batches a published reading and sends the frame once it holds
+ * TELEMETRY_BATCH_SAMPLES readings
+ * A frame that cannot be sent keeps collecting readings; when it is full
+ * it is dropped and counted
+ *
+ * @param snap Readings that were published
+ * @param timestamp Unix time of the readings (s)
+ */
+void telemetryAddReading(const SensorSnapshot &snap, uint32_t timestamp) {
+    if (liveEncoder.buf == NULL) {
+        beginFrame(liveEncoder, liveFrame, sizeof(liveFrame));
+    }
+    if (!appendReading(liveEncoder, snap, timestamp)) {
+        droppedReadings += liveEncoder.samples;
+        LOG_WARN("⚠️ Telemetry frame dropped (%lu readings lost since boot)", (unsigned long)droppedReadings);
+        beginFrame(liveEncoder, liveFrame, sizeof(liveFrame));
+        appendReading(liveEncoder, snap, timestamp);
+    }
+    if (liveEncoder.samples >= TELEMETRY_BATCH_SAMPLES) {
+        telemetryFlush();
+    }
+}
+
+/**
+ * Sends the live frame even if it is not full
+ * @return bool Returns true if nothing is left to send
+ */
+bool telemetryFlush() {
+    if (liveEncoder.buf == NULL || liveEncoder.samples == 0) return true;
+    if (!publishFrame(liveEncoder)) return false;
+    beginFrame(liveEncoder, liveFrame, sizeof(liveFrame));
+    return true;
+}
+
+/**
+ * Replays queued readings as frames of up to TELEMETRY_BACKLOG_SAMPLES
+ * @return bool Returns false if a publish failed and replay should stop
+ */
+bool telemetryPublishBacklog() {
+    QueuedReading batch[TELEMETRY_BACKLOG_SAMPLES];
+    uint8_t frame[TELEMETRY_FRAME_BYTES];
+
+    for (int message = 0; message < BACKLOG_MESSAGES_PER_CALL; message++) {
+        size_t count = storeForwardPeek(batch, TELEMETRY_BACKLOG_SAMPLES);
+        if (count == 0) break;
+
+        TelemetryEncoder enc;
+        beginFrame(enc, frame, sizeof(frame));
+        size_t encoded = 0;
+        while (encoded < count) {
+            SensorSnapshot snap;
+            queuedReadingToSnapshot(batch[encoded], snap);
+            if (!appendReading(enc, snap, batch[encoded].timestamp)) break;
+            encoded++;
+        }
+
+        if (!publishFrame(enc)) {
+            return false;
+        }
+        storeForwardConsume(encoded);
+    }
+    return true;
+}
+
+#if ENABLE_PERF_STATS
+/**
+ * Benchmarks the binary encoding against the JSON backlog format
+ * Encodes a frame of synthetic readings, decodes it back and prints bytes
+ * and encode time per sample for both formats
+ */
+void benchmarkTelemetry() {
+    const size_t count = TELEMETRY_BACKLOG_SAMPLES;
+    static SensorSnapshot readings[count];
+    for (size_t n = 0; n < count; n++) {
+        SensorSnapshot &s = readings[n];
+        s.temperature = 21.0f + 0.07f * n;
+        s.humidity = 45.0f - 0.3f * (n % 5);
+        s.pressure = 1013.0f + 0.1f * (n % 7);
+        s.altitude = 85.0f - 0.8f * (n % 7);
+        deriveSensorReadings(s);
+    }
+    uint32_t timestamp = 1700000000;
+
+    uint8_t frame[TELEMETRY_FRAME_BYTES];
+    TelemetryEncoder enc;
+    unsigned long start = micros();
+    beginFrame(enc, frame, sizeof(frame));
+    size_t encoded = 0;
+    while (encoded < count && appendReading(enc, readings[encoded], timestamp + 30 * encoded)) {
+        encoded++;
+    }
+    unsigned long binaryMicros = micros() - start;
+    size_t binaryBytes = telemetryLength(enc);
+
+    char json[160];
+    size_t jsonBytes = 0;
+    start = micros();
+    for (size_t n = 0; n < encoded; n++) {
+        size_t len = appendText(json, sizeof(json), 0, "{\"ts\":");
+        len = appendUInt(json, sizeof(json), len, timestamp + 30 * n);
+        len = appendSensorJson(json, sizeof(json), len, readings[n]);
+        jsonBytes += appendText(json, sizeof(json), len, "},");
+    }
+    unsigned long jsonMicros = micros() - start;
+
+    // Round trip: every value must come back within half a unit of its last digit
+    static TelemetrySample decoded[count];
+    uint8_t fields;
+    int samples = telemetryDecode(frame, binaryBytes, decoded, count, fields);
+    float maxError = 0;
+    for (int n = 0; n < samples; n++) {
+        for (int i = 0; i < SENSOR_COUNT; i++) {
+            float error = fabsf(decoded[n].values[i] - readings[n].*sensorRegistry[i].field);
+            if (error > maxError) maxError = error;
+        }
+    }
+
+    reportPrintf("📦 Telemetry: %.1f B/sample binary (JSON %.1f), %.2f us/sample encode (JSON %.2f), %d/%u decoded, max error %.3f\n",
+                 binaryBytes / (float)encoded, jsonBytes / (float)encoded,
+                 binaryMicros / (float)encoded, jsonMicros / (float)encoded,
+                 samples, (unsigned)encoded, maxError);
+}
+#else
+void benchmarkTelemetry() {}
+#endif // ENABLE_PERF_STATS
@@ -0,0 +1,288 @@
+#include "include/bmp390_fifo.h"
+#include "include/perf_stats.h"
+#include "include/i2c_bus.h"
+
+/*
+ * Register-level BMP390 FIFO driver.
+ * The sensor runs in normal mode and stores filtered pressure+temperature
+ * frames in its 512-byte FIFO. Each readBMP390Fifo() call reads the fill
+ * level, pulls the whole FIFO in a few burst reads of FIFO_DATA, and
+ * decodes and averages all frames in one pass, so one drain every few
+ * seconds replaces a forced-mode transaction per sample.
+ */
+
+// Registers
+#define REG_ERR 0x02
+#define REG_FIFO_LENGTH 0x12
+#define REG_FIFO_DATA 0x14
+#define REG_FIFO_CONFIG_1 0x17
+#define REG_FIFO_CONFIG_2 0x18
+#define REG_PWR_CTRL 0x1B
+#define REG_OSR 0x1C
+#define REG_ODR 0x1D
+#define REG_CONFIG 0x1F
+#define REG_CALIB 0x31
+#define REG_CMD 0x7E
+
+// Register values
+#define CMD_FIFO_FLUSH 0xB0
+#define PWR_NORMAL_PRESS_TEMP 0x33      // mode = normal, press_en, temp_en
+#define FIFO_ENABLE_PRESS_TEMP 0x19     // fifo_mode, fifo_press_en, fifo_temp_en
+#define FIFO_FILTERED_DATA (1 << 3)     // data_select = filtered
+
+// Frame headers
+#define FRAME_PRESS_TEMP 0x94
+#define FRAME_TEMP 0x90
+#define FRAME_PRESS 0x84
+#define FRAME_TIME 0xA0
+#define FRAME_EMPTY 0x80
+#define FRAME_CONFIG_CHANGE 0x48
+#define FRAME_CONFIG_ERROR 0x44
+
+#ifdef I2C_BUFFER_LENGTH
+#define FIFO_READ_CHUNK (I2C_BUFFER_LENGTH / BMP390_FIFO_FRAME_BYTES * BMP390_FIFO_FRAME_BYTES)  // 126
+#else
+#define FIFO_READ_CHUNK (32 / BMP390_FIFO_FRAME_BYTES * BMP390_FIFO_FRAME_BYTES)
+#endif
+
+static BMP390Calibration calibration;
+static BMP390FifoStats fifoStats;
+
+/**
+ * Writes one register
+ */
+static bool writeRegister(uint8_t reg, uint8_t value) {
+    i2cBegin(I2C_DEVICE_BMP390);
+    uint32_t start = micros();
+    Wire.beginTransmission(BMP390_I2C_ADDRESS);
+    Wire.write(reg);
+    Wire.write(value);
+    bool ok = Wire.endTransmission() == 0;
+    i2cEnd(I2C_DEVICE_BMP390);
+    perfRecord(PERF_I2C_BMP390, micros() - start);
+    return ok;
+}
+
+/**
+ * Reads consecutive registers (or the FIFO data port) in one transaction
+ */
+static bool readRegisters(uint8_t reg, uint8_t *data, size_t len) {
+    i2cBegin(I2C_DEVICE_BMP390);
+    uint32_t start = micros();
+    bool ok = false;
+    Wire.beginTransmission(BMP390_I2C_ADDRESS);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) == 0 &&
+        Wire.requestFrom((uint8_t)BMP390_I2C_ADDRESS, (uint8_t)len) == len) {
+        for (size_t i = 0; i < len; i++) {
+            data[i] = Wire.read();
+        }
+        ok = true;
+    }
+    i2cEnd(I2C_DEVICE_BMP390);
+    perfRecord(PERF_I2C_BMP390, micros() - start);
+    return ok;
+}
+
+/**
+ * Reads the NVM trimming coefficients and scales them (datasheet section 8.4)
+ */
+static bool readCalibration() {
+    uint8_t nvm[21];
+    if (!readRegisters(REG_CALIB, nvm, sizeof(nvm))) return false;
+
+    uint16_t t1 = nvm[0] | (nvm[1] << 8);
+    uint16_t t2 = nvm[2] | (nvm[3] << 8);
+    int8_t t3 = (int8_t)nvm[4];
+    int16_t p1 = (int16_t)(nvm[5] | (nvm[6] << 8));
+    int16_t p2 = (int16_t)(nvm[7] | (nvm[8] << 8));
+    int8_t p3 = (int8_t)nvm[9];
+    int8_t p4 = (int8_t)nvm[10];
+    uint16_t p5 = nvm[11] | (nvm[12] << 8);
+    uint16_t p6 = nvm[13] | (nvm[14] << 8);
+    int8_t p7 = (int8_t)nvm[15];
+    int8_t p8 = (int8_t)nvm[16];
+    int16_t p9 = (int16_t)(nvm[17] | (nvm[18] << 8));
+    int8_t p10 = (int8_t)nvm[19];
+    int8_t p11 = (int8_t)nvm[20];
+
+    calibration.t1 = t1 * 256.0f;                       // / 2^-8
+    calibration.t2 = t2 / 1073741824.0f;                // / 2^30
+    calibration.t3 = t3 / 281474976710656.0f;           // / 2^48
+    calibration.p1 = (p1 - 16384) / 1048576.0f;         // (- 2^14) / 2^20
+    calibration.p2 = (p2 - 16384) / 536870912.0f;       // (- 2^14) / 2^29
+    calibration.p3 = p3 / 4294967296.0f;                // / 2^32
+    calibration.p4 = p4 / 137438953472.0f;              // / 2^37
+    calibration.p5 = p5 * 8.0f;                         // / 2^-3
+    calibration.p6 = p6 / 64.0f;                        // / 2^6
+    calibration.p7 = p7 / 256.0f;                       // / 2^8
+    calibration.p8 = p8 / 32768.0f;                     // / 2^15
+    calibration.p9 = p9 / 281474976710656.0f;           // / 2^48
+    calibration.p10 = p10 / 281474976710656.0f;         // / 2^48
+    calibration.p11 = p11 / 36893488147419103232.0f;    // / 2^65
+    return true;
+}
+
+/**
+ * Reads the calibration and switches the sensor to normal mode with the
+ * FIFO collecting filtered pressure+temperature frames
+ * Must run after bmp.begin_I2C(), which resets and identifies the sensor
+ * @param config Normal-mode settings
+ * @return true if the FIFO is running
+ */
+bool setupBMP390Fifo(const BMP390FifoConfig &config) {
+    if (!readCalibration()) return false;
+    return configureBMP390Fifo(config);
+}
+
+/**
+ * Changes the normal-mode settings; frames still in the FIFO are dropped
+ * The conversion time of the oversampling must fit the ODR period
+ * @param config Normal-mode settings
+ * @return true if the sensor accepted the settings
+ */
+bool configureBMP390Fifo(const BMP390FifoConfig &config) {
+    bool ok = writeRegister(REG_PWR_CTRL, 0x00) &&          // Sleep while reconfiguring
+              writeRegister(REG_OSR, config.osr) &&
+              writeRegister(REG_ODR, config.odr) &&
+              writeRegister(REG_CONFIG, config.iir) &&
+              writeRegister(REG_FIFO_CONFIG_2, FIFO_FILTERED_DATA | config.subsampling) &&
+              writeRegister(REG_FIFO_CONFIG_1, FIFO_ENABLE_PRESS_TEMP) &&
+              writeRegister(REG_CMD, CMD_FIFO_FLUSH) &&
+              writeRegister(REG_PWR_CTRL, PWR_NORMAL_PRESS_TEMP);
+    if (!ok) return false;
+
+    uint8_t err = 0;
+    return readRegisters(REG_ERR, &err, 1) && (err & 0x04) == 0;  // conf_err
+}
+
+/**
+ * Compensates a raw temperature (datasheet section 8.5)
+ */
+static inline float compensateTemperature(uint32_t raw, const BMP390Calibration &cal) {
+    float d1 = (float)raw - cal.t1;
+    float d2 = d1 * cal.t2;
+    return d2 + (d1 * d1) * cal.t3;
+}
+
+/**
+ * Compensates a raw pressure using the compensated temperature (datasheet section 8.6)
+ */
+static inline float compensatePressure(uint32_t raw, float t, const BMP390Calibration &cal) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    float up = (float)raw;
+
+    float out1 = cal.p5 + cal.p6 * t + cal.p7 * t2 + cal.p8 * t3;
+    float out2 = up * (cal.p1 + cal.p2 * t + cal.p3 * t2 + cal.p4 * t3);
+    float up2 = up * up;
+    float out3 = up2 * (cal.p9 + cal.p10 * t) + up2 * up * cal.p11;
+    return out1 + out2 + out3;
+}
+
+/**
+ * Parses raw FIFO bytes into compensated samples
+ * Only pressure+temperature frames produce samples; sensor time, config
+ * change and temperature-only frames are skipped. Parsing stops at an
+ * empty frame, an unknown header or a truncated frame.
+ * @param data FIFO bytes as read from FIFO_DATA
+ * @param len Number of bytes
+ * @param cal Calibration coefficients
+ * @param temperature Output temperatures (°C)
+ * @param pressure Output pressures (Pa)
+ * @param maxFrames Capacity of the output arrays
+ * @param configError Set to true if a configuration error frame was seen (may be NULL)
+ * @return Number of samples written
+ */
+size_t decodeBMP390Fifo(const uint8_t *data, size_t len, const BMP390Calibration &cal,
+                        float *temperature, float *pressure, size_t maxFrames, bool *configError) {
+    size_t frames = 0;
+    size_t i = 0;
+
+    while (i < len && frames < maxFrames) {
+        uint8_t header = data[i];
+        size_t frameLen;
+        switch (header) {
+            case FRAME_PRESS_TEMP: frameLen = BMP390_FIFO_FRAME_BYTES; break;
+            case FRAME_TEMP:
+            case FRAME_PRESS:
+            case FRAME_TIME: frameLen = 4; break;
+            case FRAME_CONFIG_ERROR:
+                if (configError) *configError = true;
+                frameLen = 2;
+                break;
+            case FRAME_CONFIG_CHANGE: frameLen = 2; break;
+            default: return frames;  // Empty frame or corrupt data
+        }
+        if (i + frameLen > len) break;
+
+        if (header == FRAME_PRESS_TEMP) {
+            const uint8_t *f = data + i + 1;
+            uint32_t rawT = f[0] | (f[1] << 8) | ((uint32_t)f[2] << 16);
+            uint32_t rawP = f[3] | (f[4] << 8) | ((uint32_t)f[5] << 16);
+            float t = compensateTemperature(rawT, cal);
+            temperature[frames] = t;
+            pressure[frames] = compensatePressure(rawP, t, cal);
+            frames++;
+        }
+        i += frameLen;
+    }
+    return frames;
+}
+
+/**
+ * Drains the FIFO and averages all buffered frames
+ * @param out Mean temperature and pressure of the drained frames
+ * @return true if at least one frame was read
+ */
+bool readBMP390Fifo(BMP390FifoReading &out) {
+    uint8_t lengthBytes[2];
+    if (!readRegisters(REG_FIFO_LENGTH, lengthBytes, 2)) return false;
+    size_t length = min((size_t)((lengthBytes[0] | (lengthBytes[1] << 8)) & 0x1FF), (size_t)BMP390_FIFO_BYTES);
+    uint32_t transactions = 1;
+
+    // Burst-read the FIFO; the data port does not auto-increment, so
+    // successive reads continue the frame stream as long as each read
+    // ends on a frame boundary
+    static uint8_t fifo[BMP390_FIFO_BYTES];
+    size_t read = 0;
+    while (read < length) {
+        size_t chunk = min(length - read, (size_t)FIFO_READ_CHUNK);
+        if (!readRegisters(REG_FIFO_DATA, fifo + read, chunk)) break;
+        read += chunk;
+        transactions++;
+    }
+
+    static float temperatures[BMP390_FIFO_MAX_FRAMES];
+    static float pressures[BMP390_FIFO_MAX_FRAMES];
+    bool configError = false;
+    size_t frames = decodeBMP390Fifo(fifo, read, calibration, temperatures, pressures,
+                                     BMP390_FIFO_MAX_FRAMES, &configError);
+
+    fifoStats.drains++;
+    fifoStats.frames += frames;
+    fifoStats.bytes += read;
+    fifoStats.transactions += transactions;
+    if (configError) fifoStats.configErrors++;
+
+    if (frames == 0) return false;
+
+    // Batched mean of the drained frames
+    float tempSum = 0, pressSum = 0;
+    for (size_t i = 0; i < frames; i++) {
+        tempSum += temperatures[i];
+        pressSum += pressures[i] - pressures[0];  // Sum offsets to keep float precision
+    }
+    out.frames = frames;
+    out.temperature = tempSum / frames;
+    out.pressure = pressures[0] + pressSum / frames;
+    return true;
+}
+
+/**
+ * Copies the FIFO driver counters
+ * @param out Destination for the counters
+ */
+void getBMP390FifoStats(BMP390FifoStats &out) {
+    out = fifoStats;
+}
@@ -1,37 +1,96 @@
 #include "include/bmp390_sensor.h"
+#include "include/history_store.h"
+#include "include/bmp390_fifo.h"
+#include "include/perf_stats.h"
+#include "include/sensor_math.h"
+#include "include/duty_cycle.h"
+#include "include/i2c_bus.h"
+#include "include/sensor_trace.h"
+#include "include/pressure_trend.h"
+#include "include/adaptive_sampling.h"
+#include "include/deferred_log.h"
 
-// Global BMP390 sensor instance and measurement variables
+// Global BMP390 sensor instance
 Adafruit_BMP3XX bmp;  // BMP390 pressure and temperature sensor object
-float temperature = 0.0;  // Current temperature reading (°C)
-float pressure = 0.0;     // Current pressure reading (hPa)
-float altitude = 0.0;     // Current altitude reading (meters)
 
-// Calibration offsets
-float tempOffset = 0.0;     // Temperature offset for sensor drift compensation
-float pressureOffset = 0.0; // Pressure offset for barometric calibration
-float altitudeOffset = 0.0; // Altitude offset for known height difference
+// Calibration offsets (RTC memory, kept across deep sleep)
+RTC_DATA_ATTR float tempOffset = 0.0;     // Temperature offset for sensor drift compensation
+RTC_DATA_ATTR float pressureOffset = 0.0; // Pressure offset for barometric calibration
+RTC_DATA_ATTR float altitudeOffset = 0.0; // Altitude offset for known height difference
 
-// Variables for smoothing calculations
-float prevPressure = 0.0;   // Previous pressure reading for smoothing
-float prevAltitude = 0.0;   // Previous altitude reading for smoothing
+// True when samples come from the hardware FIFO instead of forced measurements
+static bool fifoActive = false;
+
+/*
+ * Measurement profiles, picked from the adaptive read interval. In FIFO
+ * mode the output data rate keeps the FIFO (73 frames) from overflowing
+ * between reads, and slower rates afford more oversampling. Forced reads
+ * take more oversampling and less IIR filtering as reads become rarer,
+ * since the filter steps once per read.
+ */
+struct BMP390Profile {
+    uint32_t maxIntervalMs;   // Longest read interval the profile covers
+    BMP390FifoConfig fifo;    // Normal-mode settings
+    uint8_t forcedTempOsr;    // Forced-read settings
+    uint8_t forcedPressOsr;
+    uint8_t forcedIir;
+    const char *name;
+};
+
+static const BMP390Profile bmp390Profiles[] = {
+    // t x1, p x16 (35 ms) at 25 Hz, every 2nd sample kept: 5.8 s fit, IIR 3
+    {5000, {(0 << 3) | 4, 0x03, 2 << 1, 1},
+     BMP3_OVERSAMPLING_8X, BMP3_OVERSAMPLING_4X, BMP3_IIR_FILTER_COEFF_3, "fast"},
+    // t x2, p x32 (69 ms) at 3.1 Hz: 23 s fit, IIR 7
+    {20000, {(1 << 3) | 5, 0x06, 3 << 1, 0},
+     BMP3_OVERSAMPLING_2X, BMP3_OVERSAMPLING_16X, BMP3_IIR_FILTER_COEFF_1, "normal"},
+    // t x2, p x32 at 0.78 Hz: 93 s fit, IIR 15
+    {SAMPLING_BMP390_MAX_MS, {(1 << 3) | 5, 0x08, 4 << 1, 0},
+     BMP3_OVERSAMPLING_2X, BMP3_OVERSAMPLING_32X, BMP3_IIR_FILTER_DISABLE, "slow"}
+};
+#define BMP390_PROFILE_COUNT (sizeof(bmp390Profiles) / sizeof(bmp390Profiles[0]))
+
+static uint8_t activeProfile = 0;  // setupBMP390Sensor() starts with the first profile
+
+// Variables for smoothing calculations (RTC memory, so duty-cycled wakes continue the filter)
+RTC_DATA_ATTR float prevPressure = 0.0;   // Previous pressure reading for smoothing
+RTC_DATA_ATTR float prevAltitude = 0.0;   // Previous altitude reading for smoothing
+RTC_DATA_ATTR bool smoothingSeeded = false; // False until the first reading seeds the filter
 
 /**
  * Initializes the BMP390 pressure and temperature sensor
  * This function attempts to start the sensor and configures settings.
  */
 void setupBMP390Sensor() {
-    if (!bmp.begin_I2C()) {  // Use I2C initialization for BMP390
-        Serial.println("❌ BMP390 Sensor not detected! Check wiring.");
+    i2cBegin(I2C_DEVICE_BMP390);
+    bool found = bmp.begin_I2C();  // Use I2C initialization for BMP390
+    if (found) {
+        // Configure BMP390 settings
+        const BMP390Profile &profile = bmp390Profiles[0];
+        bmp.setTemperatureOversampling(profile.forcedTempOsr);
+        bmp.setPressureOversampling(profile.forcedPressOsr);
+        bmp.setIIRFilterCoeff(profile.forcedIir);
+        bmp.setOutputDataRate(BMP3_ODR_50_HZ);
+        activeProfile = 0;
+    }
+    i2cEnd(I2C_DEVICE_BMP390);
+
+    if (!found) {
+        LOG_ERROR("❌ BMP390 Sensor not detected! Check wiring.");
         return;
     }
 
-    Serial.println("✅ BMP390 Sensor Initialized.");
+    LOG_INFO("✅ BMP390 Sensor Initialized.");
 
-    // Configure BMP390 settings
-    bmp.setTemperatureOversampling(BMP3_OVERSAMPLING_8X);
-    bmp.setPressureOversampling(BMP3_OVERSAMPLING_4X);
-    bmp.setIIRFilterCoeff(BMP3_IIR_FILTER_COEFF_3);
-    bmp.setOutputDataRate(BMP3_ODR_50_HZ);
+#if BMP390_USE_FIFO && !DUTY_CYCLE_MODE
+    // Switch to normal mode with the FIFO collecting samples between reads
+    fifoActive = setupBMP390Fifo(bmp390Profiles[0].fifo);
+    if (fifoActive) {
+        LOG_INFO("✅ BMP390 FIFO burst mode enabled.");
+    } else {
+        LOG_WARN("⚠️ BMP390 FIFO setup failed! Using forced measurements.");
+    }
+#endif
 }
 
 /**
@@ -45,28 +104,109 @@ float applySmoothing(float newValue, float prevValue, float alpha) {
     return (alpha * newValue) + ((1 - alpha) * prevValue);
 }
 
+/**
+ * Restarts the smoothing filter, as after a power-on
+ * The next reading seeds the filter again
+ */
+void resetBMP390Smoothing() {
+    smoothingSeeded = false;
+}
+
+/**
+ * Switches to the measurement profile that suits a read interval
+ * @param intervalMs Time until the next read
+ */
+static void applyBMP390Profile(unsigned long intervalMs) {
+    uint8_t index = 0;
+    while (index < BMP390_PROFILE_COUNT - 1 && intervalMs > bmp390Profiles[index].maxIntervalMs) {
+        index++;
+    }
+    if (index == activeProfile) return;
+
+    const BMP390Profile &profile = bmp390Profiles[index];
+    bool ok;
+    if (fifoActive) {
+        ok = configureBMP390Fifo(profile.fifo);
+    } else {
+        // Stored by the library and sent with the next forced measurement
+        ok = bmp.setTemperatureOversampling(profile.forcedTempOsr) &&
+             bmp.setPressureOversampling(profile.forcedPressOsr) &&
+             bmp.setIIRFilterCoeff(profile.forcedIir);
+    }
+    if (!ok) {
+        LOG_WARN("⚠️ BMP390 %s profile not applied!", profile.name);
+        return;
+    }
+    activeProfile = index;
+    LOG_INFO("🎚️ BMP390 %s profile, reading every %lu s", profile.name, intervalMs / 1000);
+}
+
 /**
  * Reads and processes data from the BMP390 sensor
  * This function reads raw sensor values, applies offsets and smoothing,
- * and stores the results
+ * publishes the results to the sensor snapshot and adapts the read
+ * interval and measurement profile to how much the readings move
  */
 void readBMP390Sensor() {
-    if (!bmp.performReading()) {
-        Serial.println("❌ Failed to read from BMP390 sensor!");
-        return;
+    float rawTemp;      // °C
+    float rawPressure;  // hPa
+
+    if (fifoActive) {
+        // Drain all samples collected since the last read and average them
+        BMP390FifoReading reading;
+        if (!readBMP390Fifo(reading)) {
+            LOG_ERROR("❌ Failed to read BMP390 FIFO!");
+            traceRecord(TRACE_SOURCE_BMP390, 1, NAN, NAN);
+            return;
+        }
+        rawTemp = reading.temperature;
+        rawPressure = reading.pressure / 100.0; // Convert Pa to hPa
+        perfAddBytes(PERF_READ_BMP390, reading.frames * 7);
+    } else {
+        i2cBegin(I2C_DEVICE_BMP390);
+        bool ok = bmp.performReading();
+        i2cEnd(I2C_DEVICE_BMP390);
+        if (!ok) {
+            LOG_ERROR("❌ Failed to read from BMP390 sensor!");
+            traceRecord(TRACE_SOURCE_BMP390, 1, NAN, NAN);
+            return;
+        }
+
+        // Read raw sensor values
+        rawTemp = bmp.temperature;  // °C
+        rawPressure = bmp.pressure / 100.0; // Convert Pa to hPa
     }
 
-    // Read raw sensor values
-    float rawTemp = bmp.temperature;  // °C
-    float rawPressure = bmp.pressure / 100.0; // Convert Pa to hPa
+    traceRecord(TRACE_SOURCE_BMP390, 0, rawTemp, rawPressure);
+    processBMP390Reading(rawTemp, rawPressure);
+    applyBMP390Profile(samplingUpdate(SAMPLING_BMP390));
+}
 
-    // Calculate altitude using standard formula
-    float rawAltitude = 44330 * (1.0 - pow(rawPressure / 1013.25, 0.1903));
+/**
+ * Applies offsets and smoothing to a raw reading and publishes it
+ * Shared by live reads and trace replay
+ * @param rawTemp Raw temperature (°C)
+ * @param rawPressure Raw pressure (hPa)
+ */
+void processBMP390Reading(float rawTemp, float rawPressure) {
+    // Calculate altitude using standard formula (table kernel, no pow())
+    float rawAltitude = pressureToAltitude(rawPressure);
 
     // Apply calibration offsets
-    temperature = rawTemp + tempOffset;
-    pressure = rawPressure + pressureOffset;
-    altitude = rawAltitude + altitudeOffset;
+    float temperature = rawTemp + tempOffset;
+    float pressure = rawPressure + pressureOffset;
+    float altitude = rawAltitude + altitudeOffset;
+
+    // Variance before smoothing drives the adaptive read interval
+    samplingAddReading(SAMPLING_PRESSURE, pressure);
+    samplingAddReading(SAMPLING_TEMPERATURE, temperature);
+
+    // Seed the filter with the first reading instead of ramping up from zero
+    if (!smoothingSeeded) {
+        prevPressure = pressure;
+        prevAltitude = altitude;
+        smoothingSeeded = true;
+    }
 
     // Apply exponential smoothing to reduce noise
     pressure = applySmoothing(pressure, prevPressure, 0.2);
@@ -75,4 +215,9 @@ void readBMP390Sensor() {
     // Store current values for next smoothing iteration
     prevPressure = pressure;
     prevAltitude = altitude;
+
+    updateBMPSnapshot(temperature, pressure, altitude);
+    historyAddSample(HISTORY_TEMPERATURE, temperature);
+    historyAddSample(HISTORY_PRESSURE, pressure);
+    pressureTrendAddSample(seaLevelPressure(pressure));
 }
@@ -0,0 +1,51 @@
+#include "include/boot_trace.h"
+#include "include/deferred_log.h"
+
+// Time of each milestone in ms since boot (0 = not reached yet)
+static volatile uint32_t bootEventMs[BOOT_EVENT_COUNT];
+
+static const char *bootEventNames[BOOT_EVENT_COUNT] = {
+    "sensors ready",
+    "display ready",
+    "scheduler started",
+    "first reading",
+    "Wi-Fi connected",
+    "time synced",
+    "MQTT connected",
+    "first publish",
+};
+
+/**
+ * Records the first occurrence of a boot milestone
+ * Later calls for the same event are ignored, so this is safe on hot paths.
+ * @param event Milestone that was reached
+ */
+void bootTraceMark(BootEvent event) {
+    if (bootEventMs[event] == 0) {
+        uint32_t now = millis();
+        bootEventMs[event] = now ? now : 1;
+    }
+}
+
+/**
+ * Returns when a boot milestone was reached
+ * @param event Milestone to look up
+ * @return ms since boot, 0 if not reached yet
+ */
+uint32_t bootTraceTime(BootEvent event) {
+    return bootEventMs[event];
+}
+
+/**
+ * Prints the boot timeline in the order milestones were reached
+ */
+void printBootTrace() {
+    reportPrintln("🚀 Boot timeline:");
+    for (int i = 0; i < BOOT_EVENT_COUNT; i++) {
+        if (bootEventMs[i] == 0) {
+            reportPrintf("   %-18s        -\n", bootEventNames[i]);
+        } else {
+            reportPrintf("   %-18s %6lu ms\n", bootEventNames[i], (unsigned long)bootEventMs[i]);
+        }
+    }
+}
@@ -0,0 +1,387 @@
+#include "include/deferred_log.h"
+#include <atomic>
+
+/*
+ * Bounded multi-producer ring (Vyukov): each slot carries a sequence
+ * number. A producer claims a slot with one compare-and-swap on the write
+ * position and publishes it by advancing the slot's sequence; the single
+ * consumer (the formatting task) frees it the same way. A full ring drops
+ * the new record instead of blocking the caller.
+ */
+struct LogRecord {
+    std::atomic<uint32_t> sequence;
+    uint32_t timestampMs;
+    const char *format;
+    uint8_t level;
+    uint8_t argCount;
+    char task[LOG_TASK_TAG_CHARS];
+    LogWord args[LOG_MAX_ARGS];
+};
+
+static LogRecord ring[LOG_RING_RECORDS];
+static std::atomic<uint32_t> writePos(0);
+static std::atomic<uint32_t> readPos(0);    // Advanced by the formatting task only
+static TaskHandle_t logTaskHandle = NULL;
+static bool logReady = false;
+
+volatile uint8_t logLevel = LOG_DEFAULT_LEVEL;
+
+// Counters
+static std::atomic<uint32_t> writtenCount(0);
+static std::atomic<uint32_t> droppedCount(0);
+static std::atomic<uint32_t> totalCycles(0);
+static uint32_t maxCycles = 0;
+static uint16_t maxDepth = 0;
+
+static const char levelLetters[] = {'D', 'I', 'W', 'E'};
+
+/*
+ * Report text: a byte FIFO (LOG_REPORT_BYTES, power of two) guarded by a
+ * critical section. A producer copies a whole line in one go, so lines from
+ * different tasks never interleave; the formatting task takes whole lines
+ * out and writes them after releasing the lock.
+ */
+static char reportText[LOG_REPORT_BYTES];
+static std::atomic<uint32_t> reportHead(0);  // Bytes queued since boot
+static std::atomic<uint32_t> reportTail(0);  // Bytes taken by the formatting task
+static portMUX_TYPE reportMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint32_t> reportDroppedCount(0);
+static uint16_t maxReportBytes = 0;
+
+/**
+ * Stores one record in the ring
+ * Takes one compare-and-swap and a copy of at most LOG_MAX_ARGS words;
+ * never blocks. The cost of every call is measured in CPU cycles.
+ *
+ * @param level Log level
+ * @param format printf format string (static storage)
+ * @param args Packed arguments
+ * @param argCount Number of arguments
+ */
+void logPush(uint8_t level, const char *format, const LogWord *args, uint8_t argCount) {
+    if (!logReady) return;
+    uint32_t startCycles = ESP.getCycleCount();
+
+    uint32_t pos = writePos.load(std::memory_order_relaxed);
+    LogRecord *record;
+    while (true) {
+        record = &ring[pos & (LOG_RING_RECORDS - 1)];
+        int32_t diff = (int32_t)(record->sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);  // Ring full
+            return;
+        } else {
+            pos = writePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    record->timestampMs = millis();
+    record->format = format;
+    record->level = level;
+    record->argCount = argCount;
+    strncpy(record->task, pcTaskGetName(NULL), LOG_TASK_TAG_CHARS);
+    memcpy(record->args, args, argCount * sizeof(LogWord));
+    record->sequence.store(pos + 1, std::memory_order_release);
+
+    uint16_t depth = (uint16_t)(pos + 1 - readPos.load(std::memory_order_relaxed));
+    if (depth > maxDepth) maxDepth = depth;  // Racy maximum, good enough for a report
+    uint32_t cycles = ESP.getCycleCount() - startCycles;
+    totalCycles.fetch_add(cycles, std::memory_order_relaxed);
+    if (cycles > maxCycles) maxCycles = cycles;
+    writtenCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (logTaskHandle != NULL) {
+        xTaskNotifyGive(logTaskHandle);
+    }
+}
+
+/**
+ * Queues report text whole, or drops it if the buffer is full
+ * Holds the lock for one copy of at most LOG_LINE_BYTES; never blocks on
+ * the UART. Before setupLog() the text is printed directly.
+ *
+ * @param text Report text
+ * @param length Bytes of text
+ * @return false if the text was dropped
+ */
+static bool reportPush(const char *text, size_t length) {
+    if (!logReady) {
+        Serial.write(text, length);
+        return true;
+    }
+
+    bool stored = false;
+    portENTER_CRITICAL(&reportMux);
+    uint32_t head = reportHead.load(std::memory_order_relaxed);
+    uint32_t used = head - reportTail.load(std::memory_order_relaxed);
+    if (length <= LOG_REPORT_BYTES - used) {
+        uint32_t start = head & (LOG_REPORT_BYTES - 1);
+        size_t first = min(length, (size_t)(LOG_REPORT_BYTES - start));
+        memcpy(reportText + start, text, first);
+        memcpy(reportText, text + first, length - first);
+        reportHead.store(head + length, std::memory_order_relaxed);
+        used += length;
+        if (used > maxReportBytes) maxReportBytes = used;
+        stored = true;
+    }
+    portEXIT_CRITICAL(&reportMux);
+
+    if (!stored) {
+        reportDroppedCount.fetch_add(1, std::memory_order_relaxed);
+    } else if (logTaskHandle != NULL) {
+        xTaskNotifyGive(logTaskHandle);
+    }
+    return stored;
+}
+
+/**
+ * Queues one report line for the formatting task
+ * Lines longer than LOG_LINE_BYTES - 3 characters are cut.
+ *
+ * @param line Text without the line ending
+ * @return false if the buffer was full and the line was dropped
+ */
+bool reportPrintln(const char *line) {
+    char text[LOG_LINE_BYTES];
+    size_t length = min(strlen(line), sizeof(text) - 3);
+    memcpy(text, line, length);
+    text[length++] = '\r';
+    text[length++] = '\n';
+    return reportPush(text, length);
+}
+
+/**
+ * Formats report text on the caller's stack and queues it
+ * Text longer than LOG_LINE_BYTES - 1 is cut and still ends its line.
+ *
+ * @param format printf format string; include the line ending as with Serial.printf()
+ */
+void reportPrintf(const char *format, ...) {
+    char text[LOG_LINE_BYTES];
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (written <= 0) return;
+
+    size_t length = (size_t)written;
+    if (length >= sizeof(text)) {
+        length = sizeof(text) - 1;
+        text[length - 1] = '\n';
+    }
+    reportPush(text, length);
+}
+
+/**
+ * Formats a record's message, one conversion at a time
+ * Length modifiers in the format are ignored; integers are printed from
+ * their 32-bit words and floating-point values from the stored float
+ *
+ * @return Length of the message
+ */
+static size_t formatMessage(char *out, size_t size, const char *format, const LogWord *args, uint8_t argCount) {
+    size_t pos = 0;
+    uint8_t next = 0;
+    const char *p = format;
+    while (*p && pos + 1 < size) {
+        if (*p != '%') {
+            out[pos++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[pos++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Copy flags, width and precision; drop length modifiers
+        char spec[16];
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && n < sizeof(spec) - 3) spec[n++] = *p++;
+        while (*p && strchr("hlLqjzt", *p)) p++;
+        char conversion = *p;
+        if (conversion == '\0') break;
+        p++;
+
+        LogWord word = next < argCount ? args[next++] : 0;
+        int written = 0;
+        if (strchr("diouxX", conversion)) {
+            spec[n++] = 'l';
+            spec[n++] = conversion;
+            spec[n] = '\0';
+            if (conversion == 'd' || conversion == 'i') {
+                written = snprintf(out + pos, size - pos, spec, (long)(int32_t)word);
+            } else {
+                written = snprintf(out + pos, size - pos, spec, (unsigned long)word);
+            }
+        } else if (strchr("fFeEgG", conversion)) {
+            float value;
+            memcpy(&value, &word, sizeof(value));
+            spec[n++] = conversion;
+            spec[n] = '\0';
+            written = snprintf(out + pos, size - pos, spec, (double)value);
+        } else if (conversion == 's') {
+            spec[n++] = 's';
+            spec[n] = '\0';
+            const char *text = (const char *)(uintptr_t)word;
+            written = snprintf(out + pos, size - pos, spec, text ? text : "(null)");
+        } else if (conversion == 'c') {
+            out[pos++] = (char)word;
+        } else if (conversion == 'p') {
+            written = snprintf(out + pos, size - pos, "%p", (void *)(uintptr_t)word);
+        }
+        if (written > 0) {
+            pos += min((size_t)written, size - pos - 1);
+        }
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+/**
+ * Prints the oldest record, if any
+ * @return false if the ring is empty
+ */
+static bool printNextRecord() {
+    uint32_t pos = readPos.load(std::memory_order_relaxed);
+    LogRecord &record = ring[pos & (LOG_RING_RECORDS - 1)];
+    if (record.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+
+    char line[LOG_LINE_BYTES];
+    char task[LOG_TASK_TAG_CHARS + 1];
+    memcpy(task, record.task, LOG_TASK_TAG_CHARS);
+    task[LOG_TASK_TAG_CHARS] = '\0';
+    int len = snprintf(line, sizeof(line), "%5lu.%03lu %c %-8s ",
+                       (unsigned long)(record.timestampMs / 1000), (unsigned long)(record.timestampMs % 1000),
+                       levelLetters[record.level & 3], task);
+    if (len < 0) len = 0;
+    formatMessage(line + len, sizeof(line) - len, record.format, record.args, record.argCount);
+
+    // Free the slot before the slow UART write
+    record.sequence.store(pos + LOG_RING_RECORDS, std::memory_order_release);
+    readPos.store(pos + 1, std::memory_order_relaxed);
+    Serial.println(line);
+    return true;
+}
+
+/**
+ * Writes the oldest whole report lines, up to LOG_LINE_BYTES
+ * @return false if no report text is waiting
+ */
+static bool printNextReportChunk() {
+    char chunk[LOG_LINE_BYTES];
+    size_t length = 0;
+    portENTER_CRITICAL(&reportMux);
+    uint32_t tail = reportTail.load(std::memory_order_relaxed);
+    size_t available = min((size_t)(reportHead.load(std::memory_order_relaxed) - tail), sizeof(chunk));
+    for (size_t i = 0; i < available; i++) {
+        chunk[i] = reportText[(tail + i) & (LOG_REPORT_BYTES - 1)];
+        if (chunk[i] == '\n') length = i + 1;  // End at the last complete line
+    }
+    if (length == 0) length = available;  // Text without a line ending
+    portEXIT_CRITICAL(&reportMux);
+
+    if (length == 0) return false;
+    Serial.write(chunk, length);
+    reportTail.store(tail + length, std::memory_order_release);  // Only this task moves the tail
+    return true;
+}
+
+/**
+ * Formatting task: prints records as they arrive, report text between
+ * them, and reports drops
+ */
+static void logTask(void *parameter) {
+    uint32_t reportedDrops = 0;
+    uint32_t reportedReportDrops = 0;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (printNextRecord() || printNextReportChunk()) {  // Records first, so a log line waits at most one chunk
+        }
+        uint32_t drops = droppedCount.load(std::memory_order_relaxed);
+        if (drops != reportedDrops) {
+            Serial.printf("⚠️ %lu log records dropped (ring full)\n", (unsigned long)(drops - reportedDrops));
+            reportedDrops = drops;
+        }
+        drops = reportDroppedCount.load(std::memory_order_relaxed);
+        if (drops != reportedReportDrops) {
+            Serial.printf("⚠️ %lu report lines dropped (buffer full)\n", (unsigned long)(drops - reportedReportDrops));
+            reportedReportDrops = drops;
+        }
+    }
+}
+
+/**
+ * Prepares the ring and starts the formatting task
+ * Call right after Serial.begin(); records pushed earlier are ignored
+ */
+void setupLog() {
+    for (uint32_t i = 0; i < LOG_RING_RECORDS; i++) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    logReady = true;
+    xTaskCreate(logTask, "log", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, &logTaskHandle);
+}
+
+/**
+ * Changes the runtime threshold
+ * @param level Lowest level that is recorded
+ */
+void logSetLevel(uint8_t level) {
+    logLevel = level;
+}
+
+/**
+ * Checks whether the formatting task has taken every record and written
+ * every report line
+ * @return true if nothing is waiting
+ */
+bool logIdle() {
+    return readPos.load(std::memory_order_relaxed) == writePos.load(std::memory_order_relaxed) &&
+           reportTail.load(std::memory_order_relaxed) == reportHead.load(std::memory_order_relaxed);
+}
+
+/**
+ * Waits until the formatting task has printed every record and report line
+ * @param timeoutMs Longest wait
+ */
+void logFlush(uint32_t timeoutMs) {
+    unsigned long start = millis();
+    while (!logIdle() && millis() - start < timeoutMs) {
+        delay(1);
+    }
+    Serial.flush();
+}
+
+/**
+ * Copies the logging counters
+ * @param out Destination for the counters
+ */
+void getLogStats(LogStats &out) {
+    out.written = writtenCount.load(std::memory_order_relaxed);
+    out.dropped = droppedCount.load(std::memory_order_relaxed);
+    out.reportDropped = reportDroppedCount.load(std::memory_order_relaxed);
+    out.maxReportBytes = maxReportBytes;
+    out.maxDepth = maxDepth;
+    out.callCycles = out.written ? totalCycles.load(std::memory_order_relaxed) / out.written : 0;
+    out.maxCallCycles = maxCycles;
+}
+
+/**
+ * Prints record counts, ring high-water mark, call-site cost and report
+ * buffer use
+ */
+void printLogStats() {
+    LogStats stats;
+    getLogStats(stats);
+    float cyclesPerMicro = getCpuFrequencyMhz();
+    reportPrintf("📝 Log: %lu written, %lu dropped, max depth %u/%u, call %.2f us avg, %.2f us max\n",
+                 (unsigned long)stats.written, (unsigned long)stats.dropped,
+                 stats.maxDepth, (unsigned)LOG_RING_RECORDS,
+                 stats.callCycles / cyclesPerMicro, stats.maxCallCycles / cyclesPerMicro);
+    reportPrintf("   reports %lu lines dropped, max %u/%u B waiting\n",
+                 (unsigned long)stats.reportDropped, stats.maxReportBytes, (unsigned)LOG_REPORT_BYTES);
+}
@@ -0,0 +1,93 @@
+#include "include/dht_decoder.h"
+
+/*
+ * The capture holds the time of every edge on the data line after the
+ * host releases it. The decoder looks for the sensor's response (two
+ * pulses of about 80 us), then reads 40 low/high pulse pairs: the length
+ * of each high pulse is the bit. Edges before the response (such as the
+ * host's own release edge) are skipped, and every pulse is checked
+ * against its window so noise is reported instead of decoded.
+ */
+
+static bool inWindow(uint32_t micros, uint32_t minMicros, uint32_t maxMicros) {
+    return micros >= minMicros && micros <= maxMicros;
+}
+
+/**
+ * Decodes a DHT11 pulse train from edge timestamps
+ * @param edgeMicros Time of each edge in microseconds (wrap-around safe)
+ * @param edgeCount Number of edges captured
+ * @param reading Receives the raw bytes, humidity and temperature
+ * @return DHT_DECODE_OK, or why the capture could not be decoded
+ */
+DhtDecodeResult decodeDHTPulses(const uint32_t *edgeMicros, size_t edgeCount, DhtReading &reading) {
+    DhtDecodeResult result = DHT_DECODE_NO_RESPONSE;
+
+    for (size_t start = 0; start + 2 < edgeCount; start++) {
+        // Response: ~80 us low followed by ~80 us high
+        uint32_t responseLow = edgeMicros[start + 1] - edgeMicros[start];
+        uint32_t responseHigh = edgeMicros[start + 2] - edgeMicros[start + 1];
+        if (!inWindow(responseLow, DHT_RESPONSE_MIN_US, DHT_RESPONSE_MAX_US) ||
+            !inWindow(responseHigh, DHT_RESPONSE_MIN_US, DHT_RESPONSE_MAX_US)) {
+            continue;
+        }
+
+        // Each bit needs a low and a high pulse, i.e. two more edges
+        const uint32_t *bitEdges = edgeMicros + start + 2;
+        if (edgeCount - start - 2 < 2 * DHT_FRAME_BITS + 1) {
+            result = DHT_DECODE_TRUNCATED;
+            continue;
+        }
+
+        uint8_t bytes[5] = {0, 0, 0, 0, 0};
+        bool timingOk = true;
+        for (int bit = 0; bit < DHT_FRAME_BITS; bit++) {
+            uint32_t low = bitEdges[2 * bit + 1] - bitEdges[2 * bit];
+            uint32_t high = bitEdges[2 * bit + 2] - bitEdges[2 * bit + 1];
+            if (!inWindow(low, DHT_BIT_LOW_MIN_US, DHT_BIT_LOW_MAX_US) ||
+                !inWindow(high, DHT_BIT_HIGH_MIN_US, DHT_BIT_HIGH_MAX_US)) {
+                timingOk = false;
+                break;
+            }
+            bytes[bit / 8] = (uint8_t)((bytes[bit / 8] << 1) | (high >= DHT_BIT_ONE_MIN_US ? 1 : 0));
+        }
+        if (!timingOk) {
+            result = DHT_DECODE_BAD_TIMING;
+            continue;
+        }
+
+        for (int i = 0; i < 5; i++) {
+            reading.bytes[i] = bytes[i];
+        }
+        if ((uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]) != bytes[4]) {
+            return DHT_DECODE_BAD_CHECKSUM;
+        }
+
+        // Same scaling as the Adafruit DHT library: integral byte plus tenths,
+        // sign in bit 7 of the temperature decimal byte
+        reading.humidity = bytes[0] + bytes[1] * 0.1f;
+        float temperature = bytes[2];
+        if (bytes[3] & 0x80) {
+            temperature = -1.0f - temperature;
+        }
+        reading.temperature = temperature + (bytes[3] & 0x0F) * 0.1f;
+        return DHT_DECODE_OK;
+    }
+    return result;
+}
+
+/**
+ * Short name of a decode result for log messages
+ * @param result Decode result
+ * @return Static string
+ */
+const char *dhtDecodeResultName(DhtDecodeResult result) {
+    switch (result) {
+        case DHT_DECODE_OK: return "ok";
+        case DHT_DECODE_NO_RESPONSE: return "no response";
+        case DHT_DECODE_TRUNCATED: return "truncated";
+        case DHT_DECODE_BAD_TIMING: return "bad timing";
+        case DHT_DECODE_BAD_CHECKSUM: return "bad checksum";
+    }
+    return "unknown";
+}
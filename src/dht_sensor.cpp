@@ -1,32 +1,150 @@
 #include "include/dht_sensor.h"
+#include "include/history_store.h"
+#include "include/sensor_trace.h"
+#include "include/deferred_log.h"
+#include "include/adaptive_sampling.h"
 
-// Global DHT sensor instance and humidity variable
-DHT dht(DHTPIN, DHTTYPE);  // DHT sensor object with predefined pin and type
-float humidity = 0.0;      // Variable to store current humidity reading
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+/*
+ * The DHT library reads the sensor by busy-waiting about 20 ms with
+ * interrupts disabled. Here the start signal is held while the scheduler
+ * sleeps, the sensor's answer is timestamped by an edge interrupt, and the
+ * pulse train is decoded afterwards by decodeDHTPulses().
+ */
+
+// Read state machine
+enum DhtState {
+    DHT_IDLE,                     // Line released, waiting for the next reading
+    DHT_START_SIGNAL,             // Host holds the line low
+    DHT_CAPTURING                 // Line released, edge interrupt recording the answer
+};
+
+static DhtState dhtState = DHT_IDLE;
+static uint8_t dhtAttempts = 0;   // Failed attempts for the current reading
+
+// Edge capture, written by the ISR
+static volatile uint32_t edgeMicros[DHT_MAX_EDGES];
+static volatile uint8_t edgeCount = 0;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t dhtPmLock = NULL;  // Keeps light sleep off while a read is in flight
+#endif
+
+/**
+ * Edge ISR: Records the time of every level change on the data line
+ */
+static void IRAM_ATTR handleDHTEdge() {
+    uint8_t count = edgeCount;
+    if (count < DHT_MAX_EDGES) {
+        edgeMicros[count] = micros();
+        edgeCount = count + 1;
+    }
+}
 
 /**
  * Initializes the DHT humidity sensor
- * This function starts the sensor and logs its initialization
+ * The line idles high; a reading starts on the first readDHTSensor() call
  */
 void setupDHTSensor() {
-    dht.begin();  // Initialize DHT sensor communication
-    Serial.println("DHT Sensor Initialized.");
+    pinMode(DHTPIN, INPUT_PULLUP);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "dht", &dhtPmLock);
+#endif
+    LOG_INFO("DHT Sensor Initialized.");
+}
+
+/**
+ * Decodes the captured pulse train and publishes a valid reading
+ * @return ms until the next read should start
+ */
+static unsigned long finishDHTRead() {
+    uint32_t edges[DHT_MAX_EDGES];
+    size_t count = edgeCount;
+    for (size_t i = 0; i < count; i++) {
+        edges[i] = edgeMicros[i];
+    }
+
+    DhtReading reading;
+    DhtDecodeResult result = decodeDHTPulses(edges, count, reading);
+    traceRecord(TRACE_SOURCE_DHT11, result, result == DHT_DECODE_OK ? reading.humidity : NAN, 0);
+    if (result == DHT_DECODE_OK) {
+        dhtAttempts = 0;
+        processDHTReading(reading.humidity);
+        return samplingUpdate(SAMPLING_DHT11) - DHT_START_LOW_MS - DHT_CAPTURE_MS;
+    }
+
+    // Retry after the sensor's minimum interval before reporting a failure
+    if (++dhtAttempts < DHT_MAX_ATTEMPTS) {
+        return DHT_RETRY_DELAY_MS;
+    }
+    dhtAttempts = 0;
+    LOG_WARN("Failed to read from DHT sensor! (%s, %u edges)",
+             dhtDecodeResultName(result), (unsigned)count);
+    return samplingIntervalMs(SAMPLING_DHT11) - DHT_START_LOW_MS - DHT_CAPTURE_MS;
+}
+
+/**
+ * Publishes a decoded humidity reading
+ * Shared by live reads and trace replay
+ * @param humidity Relative humidity (%)
+ */
+void processDHTReading(float humidity) {
+    updateHumiditySnapshot(humidity);  // Publish valid humidity reading
+    samplingAddReading(SAMPLING_HUMIDITY, humidity);
+    historyAddSample(HISTORY_HUMIDITY, humidity);
+    // Note: Value is stored but not printed to avoid excessive logging
+}
+
+/**
+ * Reads data from the DHT humidity sensor without blocking
+ * Each call performs one step of the read: start signal, capture, decode.
+ * @return ms until the next call
+ */
+unsigned long readDHTSensor() {
+    switch (dhtState) {
+        case DHT_IDLE:
+#if CONFIG_PM_ENABLE
+            if (dhtPmLock) esp_pm_lock_acquire(dhtPmLock);
+#endif
+            // Start signal: pull the line low while other jobs run
+            digitalWrite(DHTPIN, LOW);
+            pinMode(DHTPIN, OUTPUT);
+            dhtState = DHT_START_SIGNAL;
+            return DHT_START_LOW_MS;
+
+        case DHT_START_SIGNAL:
+            // Arm the capture before releasing the line; the sensor answers
+            // 20-40 us later. The release edge itself is skipped by the decoder.
+            edgeCount = 0;
+            attachInterrupt(DHTPIN, handleDHTEdge, CHANGE);
+            pinMode(DHTPIN, INPUT_PULLUP);
+            dhtState = DHT_CAPTURING;
+            return DHT_CAPTURE_MS;
+
+        case DHT_CAPTURING:
+        default:
+            detachInterrupt(DHTPIN);
+#if CONFIG_PM_ENABLE
+            if (dhtPmLock) esp_pm_lock_release(dhtPmLock);
+#endif
+            dhtState = DHT_IDLE;
+            return finishDHTRead();
+    }
 }
 
 /**
- * Reads data from the DHT humidity sensor
- * This function attempts to read humidity and stores valid readings
+ * Reads the DHT sensor outside the scheduler (duty-cycle mode)
+ * Runs the read steps with delay() in between, including retries
  */
-void readDHTSensor() {
-    float hum = dht.readHumidity();  // Attempt to read humidity value
-
-    // Check if reading is valid
-    if (!isnan(hum)) {
-        humidity = hum;  // Store valid humidity reading
-        // Note: Value is stored but not printed to avoid excessive logging
-    } else {
-        // Handle reading failure
-        Serial.println("Failed to read from DHT sensor!");
-        // Error message is printed only when reading fails
+void readDHTSensorBlocking() {
+    while (true) {
+        unsigned long waitMs = readDHTSensor();
+        if (dhtState == DHT_IDLE && dhtAttempts == 0) {
+            return;  // Published, or failed after all attempts
+        }
+        delay(waitMs);
     }
 }
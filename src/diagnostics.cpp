@@ -0,0 +1,149 @@
+#include "include/diagnostics.h"
+#include "include/mqtt_client.h"
+#include "include/perf_stats.h"
+#include "include/job_scheduler.h"
+#include "include/number_format.h"
+#include "include/adaptive_sampling.h"
+
+/*
+ * Diagnostics documents. Everything here is read from counters the hot
+ * paths already maintain, so publishing costs nothing between reports.
+ *
+ *   DIAGNOSTICS_TOPIC          uptime, heap, stack watermarks, idle, MQTT
+ *   DIAGNOSTICS_TOPIC/job/X    runs, timing and run-time histogram of job X
+ *   DIAGNOSTICS_TOPIC/perf/X   calls, timing, bytes and histogram of slot X
+ *
+ * Histograms are cumulative since boot; "hist" holds PERF_HISTOGRAM_BUCKETS
+ * counts, bucket i covering durations below 2^(i+7) µs.
+ */
+
+/**
+ * Appends "hist":[n0,n1,...] to a JSON object
+ */
+static size_t appendHistogram(char *buf, size_t size, size_t pos, const LatencyHistogram &h) {
+    pos = appendText(buf, size, pos, ",\"hist\":[");
+    for (int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        if (i) pos = appendText(buf, size, pos, ",");
+        pos = appendUInt(buf, size, pos, h.counts[i]);
+    }
+    return appendText(buf, size, pos, "]");
+}
+
+/**
+ * Publishes the system document: uptime, heap, stacks, scheduler and MQTT
+ */
+static bool publishSystemDiagnostics() {
+    SchedulerStats sched;
+    getSchedulerStats(sched);
+    MqttStats mqtt;
+    getMqttStats(mqtt);
+
+    char payload[320];
+    size_t len = appendText(payload, sizeof(payload), 0, "{");
+    len = appendJsonUInt(payload, sizeof(payload), len, "uptime_s", millis() / 1000);
+    len = appendJsonUInt(payload, sizeof(payload), len, "free_heap", ESP.getFreeHeap());
+    len = appendJsonUInt(payload, sizeof(payload), len, "min_free_heap", ESP.getMinFreeHeap());
+    len = appendJsonUInt(payload, sizeof(payload), len, "stack_free_sensors", getSchedulerStackFree(SCHEDULER_SENSORS));
+    len = appendJsonUInt(payload, sizeof(payload), len, "stack_free_network", getSchedulerStackFree(SCHEDULER_NETWORK));
+    len = appendJsonField(payload, sizeof(payload), len, "wakeups_per_min", sched.wakeupsPerMinute, 1);
+    len = appendJsonField(payload, sizeof(payload), len, "idle_pct", sched.idlePercent, 2);
+    len = appendJsonUInt(payload, sizeof(payload), len, "mqtt_connects", mqtt.connects);
+    len = appendJsonUInt(payload, sizeof(payload), len, "mqtt_failures", mqtt.failures);
+    len = appendJsonUInt(payload, sizeof(payload), len, "reconnect_p90_ms", mqtt.reconnectMs.p90);
+    len = appendJsonUInt(payload, sizeof(payload), len, "publish_p90_us", mqtt.publishUs.p90);
+    appendText(payload, sizeof(payload), len, "}");
+    return mqttPublishNow(DIAGNOSTICS_TOPIC, payload, false);
+}
+
+/**
+ * Publishes one document per scheduler job
+ */
+static bool publishJobDiagnostics() {
+    char topic[96];
+    char payload[256];
+    JobStats job;
+    for (int i = 0; getJobStats(i, job); i++) {
+        size_t t = appendText(topic, sizeof(topic), 0, DIAGNOSTICS_TOPIC "/job/");
+        appendText(topic, sizeof(topic), t, job.name);
+
+        size_t len = appendText(payload, sizeof(payload), 0, "{");
+        len = appendJsonUInt(payload, sizeof(payload), len, "runs", job.runs);
+        len = appendJsonUInt(payload, sizeof(payload), len, "avg_us", job.runs ? (uint32_t)(job.totalMicros / job.runs) : 0);
+        len = appendJsonUInt(payload, sizeof(payload), len, "max_us", job.maxMicros);
+        len = appendJsonUInt(payload, sizeof(payload), len, "max_late_ms", job.maxLateMs);
+        len = appendHistogram(payload, sizeof(payload), len, job.histogram);
+        appendText(payload, sizeof(payload), len, "}");
+        if (!mqttPublishNow(topic, payload, false)) return false;
+    }
+    return true;
+}
+
+/**
+ * Publishes one document per profiled function or bus operation
+ */
+static bool publishPerfDiagnostics() {
+    char topic[96];
+    char payload[256];
+    for (int i = 0; i < PERF_SLOT_COUNT; i++) {
+        PerfCounters c;
+        getPerfCounters((PerfSlot)i, c);
+        if (c.calls == 0) continue;
+
+        size_t t = appendText(topic, sizeof(topic), 0, DIAGNOSTICS_TOPIC "/perf/");
+        appendText(topic, sizeof(topic), t, perfSlotName((PerfSlot)i));
+
+        size_t len = appendText(payload, sizeof(payload), 0, "{");
+        len = appendJsonUInt(payload, sizeof(payload), len, "calls", c.calls);
+        len = appendJsonUInt(payload, sizeof(payload), len, "avg_us", (uint32_t)(c.totalMicros / c.calls));
+        len = appendJsonUInt(payload, sizeof(payload), len, "max_us", c.maxMicros);
+        len = appendJsonUInt(payload, sizeof(payload), len, "bytes", c.bytesOut);
+        len = appendHistogram(payload, sizeof(payload), len, c.histogram);
+        appendText(payload, sizeof(payload), len, "}");
+        if (!mqttPublishNow(topic, payload, false)) return false;
+    }
+    return true;
+}
+
+/**
+ * Publishes one document per adaptively sampled sensor
+ */
+static bool publishSamplingDiagnostics() {
+    char topic[96];
+    char payload[256];
+    char key[24];
+    for (int i = 0; i < SAMPLING_SOURCE_COUNT; i++) {
+        SamplingStats s;
+        getSamplingStats((SamplingSource)i, s);
+
+        size_t t = appendText(topic, sizeof(topic), 0, DIAGNOSTICS_TOPIC "/sampling/");
+        appendText(topic, sizeof(topic), t, s.name);
+
+        size_t len = appendText(payload, sizeof(payload), 0, "{");
+        len = appendJsonUInt(payload, sizeof(payload), len, "interval_ms", s.intervalMs);
+        len = appendJsonUInt(payload, sizeof(payload), len, "avg_interval_ms", s.averageMs);
+        len = appendJsonUInt(payload, sizeof(payload), len, "reads", s.samples);
+        len = appendJsonField(payload, sizeof(payload), len, "fastest_pct", s.minimumPercent, 1);
+        len = appendJsonUInt(payload, sizeof(payload), len, "faster", s.faster);
+        len = appendJsonUInt(payload, sizeof(payload), len, "slower", s.slower);
+        for (int m = 0; m < SAMPLING_METRIC_COUNT; m++) {
+            float deviation = samplingDeviation((SamplingMetric)m);
+            if (samplingMetricSource((SamplingMetric)m) != i || isnan(deviation)) continue;
+            size_t k = appendText(key, sizeof(key), 0, samplingMetricName((SamplingMetric)m));
+            appendText(key, sizeof(key), k, "_sd");
+            len = appendJsonField(payload, sizeof(payload), len, key, deviation, 3);
+        }
+        appendText(payload, sizeof(payload), len, "}");
+        if (!mqttPublishNow(topic, payload, false)) return false;
+    }
+    return true;
+}
+
+/**
+ * Publishes the diagnostics documents
+ * @return bool Returns true if every document was sent
+ */
+bool publishDiagnostics() {
+    if (!mqttConnected()) return false;
+    return publishSystemDiagnostics() && publishJobDiagnostics() && publishPerfDiagnostics() &&
+           publishSamplingDiagnostics();
+}
@@ -0,0 +1,172 @@
+#include "include/duty_cycle.h"
+#include "include/wifi_manager.h"
+#include "include/time_manager.h"
+#include "include/dht_sensor.h"
+#include "include/bmp390_sensor.h"
+#include "include/mqtt_client.h"
+#include "include/mqtt_publisher.h"
+#include "include/store_forward.h"
+#include "include/history_store.h"
+#include "include/sensor_math.h"
+#include "include/sensor_snapshot.h"
+#include "include/number_format.h"
+#include "include/i2c_bus.h"
+#include "include/binary_telemetry.h"
+#include "include/sensor_trace.h"
+#include "include/deferred_log.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+
+// MQTT topic for the timing of the previous wake cycle
+const char* topic_duty_cycle = "homeassistant/sensor/bmp390_weather/duty_cycle";
+
+/*
+ * State that survives deep sleep. RTC slow memory keeps its contents while
+ * the chip sleeps and is only reinitialized on power-on, so a cold boot is
+ * recognized by dutyCycleCount being zero. The smoothing filter, offsets and
+ * discovery flag live next to their owners, also in RTC memory.
+ */
+RTC_DATA_ATTR static uint32_t dutyCycleCount = 0;
+RTC_DATA_ATTR static DutyCycleTiming lastCycleTiming;
+RTC_DATA_ATTR static bool lastCycleValid = false;
+RTC_DATA_ATTR static uint32_t failedCycleCount = 0;
+
+/**
+ * Milliseconds since the app started after this wake
+ */
+static uint32_t msSinceWake() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/**
+ * Publishes the timing of the previous cycle
+ * The current cycle is still running, so each wake reports the one before.
+ */
+static void publishLastCycleTiming() {
+    if (!lastCycleValid) return;
+
+    char payload[192];
+    size_t len = appendText(payload, sizeof(payload), 0, "{");
+    len = appendJsonUInt(payload, sizeof(payload), len, "cycle", lastCycleTiming.cycle);
+    len = appendJsonUInt(payload, sizeof(payload), len, "sampled_ms", lastCycleTiming.sampledMs);
+    len = appendJsonUInt(payload, sizeof(payload), len, "connected_ms", lastCycleTiming.connectedMs);
+    len = appendJsonUInt(payload, sizeof(payload), len, "published_ms", lastCycleTiming.publishedMs);
+    len = appendJsonUInt(payload, sizeof(payload), len, "sleep_ms", lastCycleTiming.sleepMs);
+    len = appendJsonUInt(payload, sizeof(payload), len, "failed_cycles", lastCycleTiming.failedCycles);
+    appendText(payload, sizeof(payload), len, "}");
+    mqttEnqueue(topic_duty_cycle, payload, false, true);
+}
+
+/**
+ * Checks that both sensors delivered a reading this wake
+ * @return false if pressure or humidity is missing
+ */
+static bool readingsComplete() {
+    SensorSnapshot snap;
+    readSensorSnapshot(snap);
+    return !isnan(snap.pressure) && !isnan(snap.humidity);
+}
+
+/**
+ * Runs one wake cycle: sample, connect, publish, then deep-sleep
+ * A reading that cannot be published is queued on flash and replayed on
+ * the next wake that gets a connection. A wake without a complete reading
+ * neither publishes nor queues one and counts as a failed cycle.
+ */
+void runDutyCycle() {
+    DutyCycleTiming timing = {};
+    timing.cycle = ++dutyCycleCount;
+    bool coldBoot = (dutyCycleCount == 1);
+
+    // Sample
+    setupI2CBus();
+    setupSensorMath();
+    setupHistory();
+    setupStoreForward();
+    setupTraceRecorder();
+    setupDHTSensor();
+    setupBMP390Sensor();
+    readBMP390Sensor();
+    readDHTSensorBlocking();
+    timing.sampledMs = msSinceWake();
+    bool sampled = readingsComplete();
+    if (!sampled) {
+        failedCycleCount++;
+        LOG_WARN("⚠️ Incomplete reading, nothing published or queued this cycle");
+    }
+    timing.failedCycles = failedCycleCount;
+
+    // Connect
+    bool published = false;
+    if (connectWiFi(DUTY_CYCLE_WIFI_TIMEOUT_MS)) {
+        setupTime();
+        if (coldBoot) {
+            waitForTimeSync(DUTY_CYCLE_NTP_TIMEOUT_MS);  // The RTC keeps wall-clock time across deep sleep
+        }
+        setupMQTT();
+        connectMQTT();
+    }
+
+    // Publish
+    if (mqttConnected()) {
+        timing.connectedMs = msSinceWake();
+        if (!discoveryPublished) {
+            publishDiscoveryMessages();
+        }
+        published = sampled && publishSensorData();
+#if MQTT_BINARY_TELEMETRY
+        telemetryFlush();  // The live frame does not survive deep sleep
+#endif
+        publishLastCycleTiming();
+        mqttFlush();  // Discovery, state and timing go out back-to-back
+
+        MqttStats mqtt;
+        getMqttStats(mqtt);
+        bool outboxClear = mqtt.outboxQueued == 0;
+        published = published && outboxClear;
+        for (int i = 0; outboxClear && i < DUTY_CYCLE_BACKLOG_CALLS && storeForwardPending() > 0; i++) {
+            if (!publishBacklog()) break;
+        }
+        if (published) {
+            timing.publishedMs = msSinceWake();
+        }
+        client.loop();
+        client.disconnect();
+    }
+
+    if (sampled && !published) {
+        queueSensorData();
+    }
+    storeForwardFlush();  // RAM buffers are lost in deep sleep
+    traceFlush();
+    logFlush(LOG_FLUSH_TIMEOUT_MS);  // Print queued log records before the summary
+
+    // Sleep
+    WiFi.disconnect(true);
+    timing.sleepMs = msSinceWake();
+    lastCycleTiming = timing;
+    lastCycleValid = true;
+
+    Serial.printf("😴 Cycle %lu: sampled %lu ms, connected %lu ms, published %lu ms, sleeping at %lu ms, %lu failed\n",
+                  (unsigned long)timing.cycle, (unsigned long)timing.sampledMs, (unsigned long)timing.connectedMs,
+                  (unsigned long)timing.publishedMs, (unsigned long)timing.sleepMs,
+                  (unsigned long)timing.failedCycles);
+    Serial.flush();
+
+    // Keep the wake period fixed regardless of how long this cycle took
+    uint64_t periodMs = DUTY_CYCLE_PERIOD_S * 1000ULL;
+    uint64_t sleepMs = timing.sleepMs + 1000 < periodMs ? periodMs - timing.sleepMs : 1000;
+    esp_sleep_enable_timer_wakeup(sleepMs * 1000ULL);
+    esp_deep_sleep_start();
+}
+
+/**
+ * Copies the timing of the previous wake cycle
+ * @param out Destination for the timing
+ * @return false if no cycle completed since power-on
+ */
+bool getLastDutyCycleTiming(DutyCycleTiming &out) {
+    if (!lastCycleValid) return false;
+    out = lastCycleTiming;
+    return true;
+}
@@ -0,0 +1,246 @@
+#include "include/history_store.h"
+#include "include/sensor_trace.h"
+
+/*
+ * Fixed-size time series of one row per minute.
+ * Each metric is stored as fixed-point integers. Rows are grouped into
+ * blocks of HISTORY_BLOCK_ROWS: a block keeps the absolute value of its
+ * first row plus min/max/sum summaries, and every other row is an 8-bit
+ * delta from the previous row. Deltas larger than ±127 steps are clamped
+ * and the remainder is carried into the next rows, so the stored series
+ * always tracks the input. Appends are O(1); window queries use the block
+ * summaries and decode at most one partial block.
+ */
+
+// Fixed-point steps per unit, in HistoryMetric order
+static const float historyScale[HISTORY_METRIC_COUNT] = { 100.0f, 100.0f, 10.0f };
+
+// Keyframe and summaries of one block, in fixed-point steps
+struct HistoryBlock {
+    int32_t base[HISTORY_METRIC_COUNT];
+    int32_t min[HISTORY_METRIC_COUNT];
+    int32_t max[HISTORY_METRIC_COUNT];
+    int32_t sum[HISTORY_METRIC_COUNT];
+};
+
+static int8_t historyDeltas[HISTORY_CAPACITY][HISTORY_METRIC_COUNT];  // Row deltas (0 for block starts)
+static HistoryBlock historyBlocks[HISTORY_BLOCKS];
+static uint32_t historyTotalRows = 0;                                 // Rows appended since boot
+static int32_t historyLastValue[HISTORY_METRIC_COUNT];                // Decoded value of the newest row
+
+// Accumulators for the row being collected
+static float pendingSum[HISTORY_METRIC_COUNT];
+static uint16_t pendingCount[HISTORY_METRIC_COUNT];
+static float latestSample[HISTORY_METRIC_COUNT];
+static uint8_t seenMetrics = 0;                                       // Bit per metric that has reported
+static unsigned long rowStartTime = 0;
+
+static SemaphoreHandle_t historyMutex = NULL;
+
+/**
+ * Creates the lock shared by the sensor tasks and history readers
+ */
+void setupHistory() {
+    historyMutex = xSemaphoreCreateMutex();
+}
+
+/**
+ * Converts a reading to fixed-point steps
+ */
+static int32_t toFixed(HistoryMetric metric, float value) {
+    return (int32_t)lroundf(value * historyScale[metric]);
+}
+
+/**
+ * Appends one row of fixed-point values
+ * @param values One value per metric
+ */
+static void appendRow(const int32_t *values) {
+    uint32_t row = historyTotalRows;
+    uint32_t slot = row % HISTORY_CAPACITY;
+    HistoryBlock &block = historyBlocks[(row / HISTORY_BLOCK_ROWS) % HISTORY_BLOCKS];
+    bool blockStart = (row % HISTORY_BLOCK_ROWS) == 0;
+
+    for (int m = 0; m < HISTORY_METRIC_COUNT; m++) {
+        int32_t value;
+        if (blockStart) {
+            value = values[m];
+            historyDeltas[slot][m] = 0;
+            block.base[m] = value;
+            block.min[m] = value;
+            block.max[m] = value;
+            block.sum[m] = 0;
+        } else {
+            int32_t delta = constrain(values[m] - historyLastValue[m], (int32_t)-127, (int32_t)127);
+            historyDeltas[slot][m] = (int8_t)delta;
+            value = historyLastValue[m] + delta;
+            if (value < block.min[m]) block.min[m] = value;
+            if (value > block.max[m]) block.max[m] = value;
+        }
+        block.sum[m] += value;
+        historyLastValue[m] = value;
+    }
+    historyTotalRows++;
+}
+
+/**
+ * Closes every row whose minute has elapsed
+ * Missed minutes repeat the newest values so rows stay one minute apart
+ * @param now Current time (millis)
+ */
+static void commitElapsedRows(unsigned long now) {
+    uint32_t elapsedRows = (now - rowStartTime) / HISTORY_INTERVAL_MS;
+    if (elapsedRows == 0) return;
+
+    int32_t values[HISTORY_METRIC_COUNT];
+    for (int m = 0; m < HISTORY_METRIC_COUNT; m++) {
+        float value = pendingCount[m] ? pendingSum[m] / pendingCount[m] : latestSample[m];
+        values[m] = toFixed((HistoryMetric)m, value);
+        pendingSum[m] = 0;
+        pendingCount[m] = 0;
+    }
+
+    uint32_t rows = min(elapsedRows, (uint32_t)HISTORY_CAPACITY);
+    for (uint32_t i = 0; i < rows; i++) {
+        appendRow(values);
+    }
+    rowStartTime += elapsedRows * HISTORY_INTERVAL_MS;
+}
+
+/**
+ * Feeds a new sensor sample into the row being collected
+ * Rows start once every metric has reported at least one sample
+ * @param metric Metric the sample belongs to
+ * @param value Sample value in the metric's unit
+ */
+void historyAddSample(HistoryMetric metric, float value) {
+    if (historyMutex == NULL || isnan(value)) return;
+    xSemaphoreTake(historyMutex, portMAX_DELAY);
+
+    unsigned long now = traceClockMs();  // Trace time during replay
+    const uint8_t allMetrics = (1 << HISTORY_METRIC_COUNT) - 1;
+    if (seenMetrics == allMetrics) {
+        commitElapsedRows(now);
+    }
+
+    latestSample[metric] = value;
+    pendingSum[metric] += value;
+    pendingCount[metric]++;
+
+    if (seenMetrics != allMetrics) {
+        seenMetrics |= 1 << metric;
+        rowStartTime = now;  // The first row starts with the first complete set
+    }
+
+    xSemaphoreGive(historyMutex);
+}
+
+/**
+ * Returns the absolute number of the oldest row still stored
+ */
+static uint32_t oldestRow() {
+    if (historyTotalRows == 0) return 0;
+    uint32_t newestBlock = (historyTotalRows - 1) / HISTORY_BLOCK_ROWS;
+    uint32_t oldestBlock = newestBlock >= HISTORY_BLOCKS - 1 ? newestBlock - (HISTORY_BLOCKS - 1) : 0;
+    return oldestBlock * HISTORY_BLOCK_ROWS;
+}
+
+/**
+ * Decodes one stored row from its block keyframe
+ * @param metric Metric to decode
+ * @param row Absolute row number (must be stored)
+ * @return Fixed-point value of the row
+ */
+static int32_t decodeRow(HistoryMetric metric, uint32_t row) {
+    uint32_t first = row - (row % HISTORY_BLOCK_ROWS);
+    int32_t value = historyBlocks[(row / HISTORY_BLOCK_ROWS) % HISTORY_BLOCKS].base[metric];
+    for (uint32_t r = first + 1; r <= row; r++) {
+        value += historyDeltas[r % HISTORY_CAPACITY][metric];
+    }
+    return value;
+}
+
+/**
+ * Returns the number of stored rows (one per minute)
+ */
+uint16_t historyRowCount() {
+    if (historyMutex == NULL) return 0;
+    xSemaphoreTake(historyMutex, portMAX_DELAY);
+    uint16_t rows = historyTotalRows - oldestRow();
+    xSemaphoreGive(historyMutex);
+    return rows;
+}
+
+/**
+ * Looks up the value of a metric some minutes ago
+ * @param metric Metric to read
+ * @param minutesAgo Age of the row (0 = newest row)
+ * @param out Decoded value in the metric's unit
+ * @return true if the row is still stored
+ */
+bool historyGetValue(HistoryMetric metric, uint16_t minutesAgo, float &out) {
+    if (historyMutex == NULL) return false;
+    xSemaphoreTake(historyMutex, portMAX_DELAY);
+
+    bool found = minutesAgo < historyTotalRows - oldestRow();
+    if (found) {
+        out = decodeRow(metric, historyTotalRows - 1 - minutesAgo) / historyScale[metric];
+    }
+
+    xSemaphoreGive(historyMutex);
+    return found;
+}
+
+/**
+ * Computes min/max/mean of a metric over the newest rows
+ * Whole blocks are taken from their summaries; only a block cut by the
+ * start of the window is decoded row by row
+ * @param metric Metric to aggregate
+ * @param minutes Window length in rows (clamped to the stored rows)
+ * @param out Aggregate in the metric's unit
+ * @return true if at least one row was aggregated
+ */
+bool historyGetStats(HistoryMetric metric, uint16_t minutes, HistoryStats &out) {
+    if (historyMutex == NULL || minutes == 0) return false;
+    xSemaphoreTake(historyMutex, portMAX_DELAY);
+
+    uint32_t end = historyTotalRows;                   // One past the newest row
+    uint32_t stored = end - oldestRow();
+    uint32_t start = end - min((uint32_t)minutes, stored);
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    int64_t sum = 0;
+
+    uint32_t row = start;
+    if (row < end && row % HISTORY_BLOCK_ROWS != 0) {
+        // Partial block at the start of the window
+        uint32_t blockEnd = min(end, row - (row % HISTORY_BLOCK_ROWS) + HISTORY_BLOCK_ROWS);
+        int32_t value = decodeRow(metric, row);
+        for (;;) {
+            lo = min(lo, value);
+            hi = max(hi, value);
+            sum += value;
+            if (++row >= blockEnd) break;
+            value += historyDeltas[row % HISTORY_CAPACITY][metric];
+        }
+    }
+    while (row < end) {
+        // Whole blocks (the newest block summarizes every row written so far)
+        const HistoryBlock &block = historyBlocks[(row / HISTORY_BLOCK_ROWS) % HISTORY_BLOCKS];
+        lo = min(lo, block.min[metric]);
+        hi = max(hi, block.max[metric]);
+        sum += block.sum[metric];
+        row = min(end, row + HISTORY_BLOCK_ROWS);
+    }
+
+    bool found = end > start;
+    if (found) {
+        float scale = historyScale[metric];
+        out.rows = end - start;
+        out.min = lo / scale;
+        out.max = hi / scale;
+        out.mean = (float)sum / out.rows / scale;
+    }
+
+    xSemaphoreGive(historyMutex);
+    return found;
+}
@@ -0,0 +1,135 @@
+#include "include/i2c_bus.h"
+#include "include/deferred_log.h"
+
+/*
+ * Shared I2C bus manager.
+ * Every driver brackets each bus transaction with i2cBegin()/i2cEnd(), so
+ * the bus is handed over between transactions rather than between whole
+ * operations: a display flush is a series of short chunks, and a sensor
+ * read that arrives meanwhile runs after the current chunk instead of
+ * after the whole frame. Waiters are served in device priority order;
+ * a device defers while any higher-priority device is waiting, and the
+ * FreeRTOS mutex hands over to the longest waiter among the rest.
+ */
+static SemaphoreHandle_t busMutex = NULL;
+static volatile uint8_t waiting[I2C_DEVICE_COUNT];  // Tasks waiting per device
+static portMUX_TYPE waitingMux = portMUX_INITIALIZER_UNLOCKED;
+
+static I2CDeviceStats deviceStats[I2C_DEVICE_COUNT];
+static uint32_t holdStartMicros = 0;                // When the current owner took the bus
+static uint32_t windowStartMs = 0;
+
+static const char *deviceNames[I2C_DEVICE_COUNT] = { "bmp390", "ssd1306" };
+
+/**
+ * Starts the I2C peripheral and creates the bus lock
+ * Must run before any device driver touches Wire
+ */
+void setupI2CBus() {
+    Wire.begin();
+    Wire.setClock(I2C_BUS_CLOCK_HZ);
+    busMutex = xSemaphoreCreateMutex();
+    windowStartMs = millis();
+}
+
+/**
+ * Checks whether a device with higher priority is waiting for the bus
+ */
+static bool higherPriorityWaiting(I2CDevice device) {
+    for (int i = 0; i < device; i++) {
+        if (waiting[i] > 0) return true;
+    }
+    return false;
+}
+
+/**
+ * Acquires the bus for one transaction
+ * @param device Device about to be addressed
+ */
+void i2cBegin(I2CDevice device) {
+    if (busMutex == NULL) return;
+    uint32_t start = micros();
+
+    portENTER_CRITICAL(&waitingMux);
+    waiting[device]++;
+    portEXIT_CRITICAL(&waitingMux);
+
+    while (true) {
+        while (higherPriorityWaiting(device)) {
+            vTaskDelay(1);
+        }
+        xSemaphoreTake(busMutex, portMAX_DELAY);
+        if (!higherPriorityWaiting(device)) break;
+        xSemaphoreGive(busMutex);  // Someone more urgent arrived while we queued
+    }
+
+    portENTER_CRITICAL(&waitingMux);
+    waiting[device]--;
+    portEXIT_CRITICAL(&waitingMux);
+
+    holdStartMicros = micros();
+    uint32_t waited = holdStartMicros - start;
+    I2CDeviceStats &s = deviceStats[device];
+    s.waitMicros += waited;
+    if (waited > s.maxWaitMicros) s.maxWaitMicros = waited;
+}
+
+/**
+ * Releases the bus after a transaction
+ * @param device Device that was addressed
+ */
+void i2cEnd(I2CDevice device) {
+    if (busMutex == NULL) return;
+    I2CDeviceStats &s = deviceStats[device];
+    s.busyMicros += micros() - holdStartMicros;
+    s.transactions++;
+    xSemaphoreGive(busMutex);
+}
+
+/**
+ * Copies one device's counters and computes its bus occupancy
+ * The caller holds busMutex, which i2cBegin()/i2cEnd() update them under.
+ */
+static void copyDeviceStats(I2CDevice device, I2CDeviceStats &out) {
+    out = deviceStats[device];
+    uint32_t windowMs = millis() - windowStartMs;
+    out.occupancyPercent = windowMs ? out.busyMicros / (windowMs * 10.0f) : 0;
+}
+
+/**
+ * Copies one device's counters and computes its bus occupancy
+ * @param device Device to read
+ * @param out Destination for the counters
+ */
+void getI2CDeviceStats(I2CDevice device, I2CDeviceStats &out) {
+    if (busMutex != NULL) xSemaphoreTake(busMutex, portMAX_DELAY);
+    copyDeviceStats(device, out);
+    if (busMutex != NULL) xSemaphoreGive(busMutex);
+}
+
+/**
+ * Prints per-device bus occupancy and starts a new measurement window
+ * The remaining share is the headroom for additional I2C devices.
+ */
+void printI2CBusStats() {
+    // Copy and reset in one hold of the bus so no transaction is split
+    // between the windows; print after releasing it
+    I2CDeviceStats stats[I2C_DEVICE_COUNT];
+    if (busMutex != NULL) xSemaphoreTake(busMutex, portMAX_DELAY);
+    for (int i = 0; i < I2C_DEVICE_COUNT; i++) {
+        copyDeviceStats((I2CDevice)i, stats[i]);
+    }
+    windowStartMs = millis();
+    memset(deviceStats, 0, sizeof(deviceStats));
+    if (busMutex != NULL) xSemaphoreGive(busMutex);
+
+    float total = 0;
+    reportPrintf("🔌 I2C @ %lu kHz:\n", (unsigned long)(I2C_BUS_CLOCK_HZ / 1000));
+    for (int i = 0; i < I2C_DEVICE_COUNT; i++) {
+        const I2CDeviceStats &s = stats[i];
+        total += s.occupancyPercent;
+        reportPrintf("   %-8s %6.2f%% busy %8lu transactions %6lu max wait us\n", deviceNames[i],
+                     s.occupancyPercent, (unsigned long)s.transactions, (unsigned long)s.maxWaitMicros);
+    }
+    reportPrintf("   headroom %.2f%%\n", 100.0f - total);
+}
@@ -0,0 +1,316 @@
+#include "include/job_scheduler.h"
+#include "include/deferred_log.h"
+#include <WiFi.h>
+#include <atomic>
+
+#if SCHEDULER_LIGHT_SLEEP && CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+#include "esp_pm.h"
+#include "include/oled_display.h"
+#endif
+
+#define NO_REQUEST 0xFFFFFFFFUL  // No pending scheduleJobIn() for a job
+
+/*
+ * Deadline scheduler.
+ * Each scheduler task keeps its jobs in a binary min-heap ordered by the
+ * next due time, runs everything that is due (plus anything due within
+ * SCHEDULER_COALESCE_MS, so neighbouring deadlines share one wake-up) and
+ * then blocks on its task notification until the earliest deadline. With
+ * tickless idle both cores stay asleep between deadlines.
+ * Other tasks never touch the heap: scheduleJobIn() stores the request in
+ * the job and notifies the owning scheduler, which applies it.
+ */
+struct Job {
+    JobFunction function;
+    uint32_t periodMs;
+    uint32_t dueMs;                          // Next deadline (millis)
+    std::atomic<uint32_t> requestedDelayMs;  // Pending scheduleJobIn(), NO_REQUEST if none
+    SchedulerId scheduler;
+    JobStats stats;
+};
+
+struct Scheduler {
+    TaskHandle_t task;
+    uint8_t heap[SCHEDULER_MAX_JOBS];        // Job ids, earliest deadline first
+    uint8_t count;
+    uint32_t wakeups;                        // Returns from the idle wait in this window
+    uint32_t busyMicros;                     // Time spent in jobs in this window
+};
+
+static Job jobs[SCHEDULER_MAX_JOBS];
+static int jobCount = 0;
+static Scheduler schedulers[SCHEDULER_COUNT];
+static uint32_t windowStartMs = 0;
+
+static const char *schedulerNames[SCHEDULER_COUNT] = { "SensorScheduler", "NetworkScheduler" };
+static const BaseType_t schedulerCores[SCHEDULER_COUNT] = { 1, 0 };
+static const uint32_t schedulerStacks[SCHEDULER_COUNT] = { 4096, 6144 };
+
+/**
+ * Checks whether deadline a comes before deadline b (wrap-safe)
+ */
+static bool dueBefore(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+/**
+ * Restores the heap property below position i
+ */
+static void siftDown(Scheduler &s, int i) {
+    while (true) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < s.count && dueBefore(jobs[s.heap[left]].dueMs, jobs[s.heap[smallest]].dueMs)) smallest = left;
+        if (right < s.count && dueBefore(jobs[s.heap[right]].dueMs, jobs[s.heap[smallest]].dueMs)) smallest = right;
+        if (smallest == i) return;
+        uint8_t tmp = s.heap[i];
+        s.heap[i] = s.heap[smallest];
+        s.heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+/**
+ * Restores the heap property above position i
+ */
+static void siftUp(Scheduler &s, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!dueBefore(jobs[s.heap[i]].dueMs, jobs[s.heap[parent]].dueMs)) return;
+        uint8_t tmp = s.heap[i];
+        s.heap[i] = s.heap[parent];
+        s.heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+/**
+ * Applies scheduleJobIn() requests made since the last pass
+ * Deadlines may move in both directions, so the heap is rebuilt; with a
+ * handful of jobs that is cheaper than tracking heap positions.
+ */
+static void applyRequests(Scheduler &s, uint32_t now) {
+    bool changed = false;
+    for (int i = 0; i < s.count; i++) {
+        Job &job = jobs[s.heap[i]];
+        uint32_t delayMs = job.requestedDelayMs.exchange(NO_REQUEST);
+        if (delayMs != NO_REQUEST) {
+            job.dueMs = now + delayMs;
+            changed = true;
+        }
+    }
+    if (changed) {
+        for (int i = s.count / 2 - 1; i >= 0; i--) siftDown(s, i);
+    }
+}
+
+/**
+ * Runs the job at the top of the heap and queues its next run
+ */
+static void runNextJob(Scheduler &s, uint32_t now) {
+    uint8_t id = s.heap[0];
+    Job &job = jobs[id];
+
+    uint32_t late = dueBefore(job.dueMs, now) ? now - job.dueMs : 0;
+    if (late > job.stats.maxLateMs) job.stats.maxLateMs = late;
+
+    uint32_t start = micros();
+    job.function();
+    uint32_t elapsed = micros() - start;
+    job.stats.runs++;
+    job.stats.totalMicros += elapsed;
+    if (elapsed > job.stats.maxMicros) job.stats.maxMicros = elapsed;
+    job.stats.histogram.counts[histogramBucket(elapsed)]++;
+    s.busyMicros += elapsed;
+
+    // Next period from the deadline, not the finish time, so jobs don't
+    // drift; runs missed while the scheduler was busy are skipped
+    job.dueMs += job.periodMs;
+    now = millis();
+    if (dueBefore(job.dueMs, now)) job.dueMs = now + job.periodMs;
+    siftDown(s, 0);
+}
+
+/**
+ * Scheduler task: runs due jobs, then sleeps until the next deadline
+ * @param pvParameters SchedulerId of this task
+ */
+static void schedulerTask(void *pvParameters) {
+    Scheduler &s = schedulers[(int)(intptr_t)pvParameters];
+
+    while (1) {
+        uint32_t now = millis();
+        applyRequests(s, now);
+        while (s.count > 0 && dueBefore(jobs[s.heap[0]].dueMs, now + SCHEDULER_COALESCE_MS + 1)) {
+            runNextJob(s, now);
+            now = millis();
+            applyRequests(s, now);
+        }
+
+        uint32_t waitMs = s.count > 0 ? jobs[s.heap[0]].dueMs - now : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, s.count > 0 ? pdMS_TO_TICKS(waitMs) : portMAX_DELAY);
+        s.wakeups++;
+    }
+}
+
+/**
+ * Registers a periodic job; must be called before startSchedulers()
+ * @param scheduler Scheduler task that runs the job
+ * @param name Name shown in the report
+ * @param function Job body, runs to completion on the scheduler task
+ * @param periodMs Interval between runs (ms)
+ * @param firstDelayMs Delay before the first run (ms)
+ * @return Job id, or -1 if the job table is full
+ */
+int addJob(SchedulerId scheduler, const char *name, JobFunction function,
+           uint32_t periodMs, uint32_t firstDelayMs) {
+    if (jobCount >= SCHEDULER_MAX_JOBS) {
+        LOG_WARN("⚠️ Scheduler full, job %s not added", name);
+        return -1;
+    }
+    int id = jobCount++;
+    Job &job = jobs[id];
+    job.function = function;
+    job.periodMs = periodMs;
+    job.dueMs = millis() + firstDelayMs;
+    job.requestedDelayMs.store(NO_REQUEST);
+    job.scheduler = scheduler;
+    job.stats.name = name;
+
+    Scheduler &s = schedulers[scheduler];
+    s.heap[s.count++] = id;
+    siftUp(s, s.count - 1);
+    return id;
+}
+
+/**
+ * Enables automatic light sleep when the core supports it
+ * Needs an Arduino core built with CONFIG_PM_ENABLE and tickless idle; the
+ * stock core lacks tickless idle and keeps Wi-Fi modem sleep only.
+ */
+static void setupPowerManagement() {
+#if SCHEDULER_LIGHT_SLEEP
+    WiFi.setSleep(true);  // Modem sleep between beacons, required for light sleep with Wi-Fi
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    esp_pm_config_esp32_t pm = {};
+    pm.max_freq_mhz = 240;
+    pm.min_freq_mhz = 80;
+    pm.light_sleep_enable = true;
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err == ESP_OK) {
+        // Let the OLED button wake the chip so its press is not lost
+        if (!enableButtonWakeup()) LOG_WARN("⚠️ OLED button cannot wake the chip from light sleep");
+        LOG_INFO("💤 Automatic light sleep enabled");
+    } else {
+        LOG_WARN("⚠️ Light sleep configuration failed! Error: %d", err);
+    }
+#else
+    LOG_INFO("💤 Core built without tickless idle; idling with Wi-Fi modem sleep only");
+#endif
+#endif
+}
+
+/**
+ * Configures power management and starts one task per scheduler
+ */
+void startSchedulers() {
+    setupPowerManagement();
+    windowStartMs = millis();
+    for (int i = 0; i < SCHEDULER_COUNT; i++) {
+        xTaskCreatePinnedToCore(schedulerTask, schedulerNames[i], schedulerStacks[i],
+                                (void *)(intptr_t)i, SCHEDULER_TASK_PRIORITY, &schedulers[i].task, schedulerCores[i]);
+    }
+}
+
+/**
+ * Moves the next run of a job; safe from any task, including the job itself
+ * @param job Job id from addJob()
+ * @param delayMs Delay from now (ms)
+ */
+void scheduleJobIn(int job, uint32_t delayMs) {
+    if (job < 0 || job >= jobCount) return;
+    jobs[job].requestedDelayMs.store(delayMs);
+    TaskHandle_t task = schedulers[jobs[job].scheduler].task;
+    if (task != NULL && task != xTaskGetCurrentTaskHandle()) {
+        xTaskNotifyGive(task);
+    }
+}
+
+/**
+ * Runs a job as soon as its scheduler is free
+ * @param job Job id from addJob()
+ */
+void triggerJob(int job) {
+    scheduleJobIn(job, 0);
+}
+
+/**
+ * Copies the counters of one job
+ * @param job Job id from addJob()
+ * @param out Destination for the counters
+ * @return false if the id is unknown
+ */
+bool getJobStats(int job, JobStats &out) {
+    if (job < 0 || job >= jobCount) return false;
+    out = jobs[job].stats;
+    return true;
+}
+
+/**
+ * Computes the wake-up rate and idle share since the last report
+ * Idle is measured per scheduler task and averaged, so 100% means neither
+ * task ran a job during the window.
+ * @param out Destination for the statistics
+ */
+void getSchedulerStats(SchedulerStats &out) {
+    uint32_t windowMs = millis() - windowStartMs;
+    uint32_t wakeups = 0;
+    uint64_t busyMicros = 0;
+    for (int i = 0; i < SCHEDULER_COUNT; i++) {
+        wakeups += schedulers[i].wakeups;
+        busyMicros += schedulers[i].busyMicros;
+    }
+
+    out.windowMs = windowMs;
+    if (windowMs == 0) {
+        out.wakeupsPerMinute = 0;
+        out.idlePercent = 100;
+        return;
+    }
+    out.wakeupsPerMinute = wakeups * 60000.0f / windowMs;
+    out.idlePercent = 100.0f - (busyMicros / 10.0f) / ((float)windowMs * SCHEDULER_COUNT);
+}
+
+/**
+ * Returns the stack high-water mark of a scheduler task
+ * @param scheduler Scheduler to check
+ * @return Smallest amount of free stack seen so far (bytes), 0 if not started
+ */
+uint32_t getSchedulerStackFree(SchedulerId scheduler) {
+    TaskHandle_t task = schedulers[scheduler].task;
+    return task != NULL ? uxTaskGetStackHighWaterMark(task) : 0;
+}
+
+/**
+ * Prints the scheduler report and starts a new measurement window
+ */
+void printSchedulerStats() {
+    SchedulerStats stats;
+    getSchedulerStats(stats);
+    reportPrintf("⏰ Scheduler: %.1f wake-ups/min, %.2f%% idle over %lu s, stack free %lu/%lu B\n",
+                 stats.wakeupsPerMinute, stats.idlePercent, (unsigned long)(stats.windowMs / 1000),
+                 (unsigned long)getSchedulerStackFree(SCHEDULER_SENSORS),
+                 (unsigned long)getSchedulerStackFree(SCHEDULER_NETWORK));
+    for (int i = 0; i < jobCount; i++) {
+        const JobStats &j = jobs[i].stats;
+        reportPrintf("   %-16s %8lu runs %8lu avg us %6lu max late ms\n", j.name, (unsigned long)j.runs,
+                     (unsigned long)(j.runs ? j.totalMicros / j.runs : 0), (unsigned long)j.maxLateMs);
+    }
+
+    windowStartMs = millis();
+    for (int i = 0; i < SCHEDULER_COUNT; i++) {
+        schedulers[i].wakeups = 0;
+        schedulers[i].busyMicros = 0;
+    }
+}
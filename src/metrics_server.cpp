@@ -0,0 +1,611 @@
+#include "include/metrics_server.h"
+#include "include/sensor_snapshot.h"
+#include "include/pressure_trend.h"
+#include "include/adaptive_sampling.h"
+#include "include/mqtt_client.h"
+#include "include/mqtt_publisher.h"
+#include "include/store_forward.h"
+#include "include/wifi_manager.h"
+#include "include/deferred_log.h"
+#include "include/perf_stats.h"
+#include "include/number_format.h"
+#include "lwip/sockets.h"
+
+/*
+ * Single-task server over lwIP sockets. select() sleeps until a client
+ * connects, sends or can take more data, so the task costs nothing between
+ * scrapes. A response is produced one step at a time: the status line and
+ * headers, then one metric family per step, each written into the
+ * client's METRICS_CHUNK_BYTES buffer only after the previous one has
+ * reached the socket. The end of the response is marked by closing the
+ * connection (no Content-Length).
+ *
+ * A socket closed with unread request bytes makes lwIP answer with a
+ * reset, which can discard the response before the client has read it.
+ * Answered sockets (including 503 refusals, which never read the request)
+ * are therefore only shut down for sending and kept in a small linger list
+ * that discards incoming bytes until the client closes or
+ * METRICS_LINGER_MS pass.
+ *
+ * Readings come from one snapshot copy taken when the request arrives, so
+ * all values in a scrape belong together; counters are read as each family
+ * is written.
+ */
+
+enum MetricsPhase : uint8_t {
+    METRICS_FREE,             // Slot unused
+    METRICS_READ,             // Collecting the request
+    METRICS_WRITE             // Streaming the response
+};
+
+// One connected client
+struct MetricsClient {
+    int fd;
+    uint8_t phase;            // MetricsPhase
+    bool scrape;              // Response is a /metrics body (counts as a scrape)
+    bool lineStart;           // Last request byte ended a line
+    bool requestLineDone;     // Request line complete, skipping headers
+    uint8_t step;             // Next family to write
+    uint16_t requestLen;      // Bytes in request
+    uint16_t outLen;          // Bytes in out
+    uint16_t outSent;         // Bytes of out already sent
+    uint32_t lastActivityMs;  // Last byte received or sent
+    uint32_t startMicros;     // Connection accepted
+    uint32_t bytes;           // Response bytes sent
+    char request[METRICS_REQUEST_BYTES];
+    char out[METRICS_CHUNK_BYTES];
+    SensorSnapshot snap;      // Readings served by this scrape
+};
+
+// Answered socket waiting for the client to close
+struct LingeringSocket {
+    int fd;                   // -1 if unused
+    uint32_t sinceMs;         // Sending side shut down
+};
+
+static int listenFd = -1;
+static MetricsClient clients[METRICS_MAX_CLIENTS];
+static LingeringSocket lingering[METRICS_LINGER_SLOTS];
+static MetricsStats stats = {0, 0, 0, 0};  // Written by the server task under statsMux
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char okHeader[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: close\r\n\r\n";
+static const char notFoundResponse[] =
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Type: text/plain\r\n"
+    "Connection: close\r\n\r\n"
+    "Not found, try " METRICS_PATH "\n";
+static const char methodResponse[] =
+    "HTTP/1.1 405 Method Not Allowed\r\n"
+    "Allow: GET\r\n"
+    "Connection: close\r\n\r\n";
+static const char busyResponse[] =
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Retry-After: 1\r\n"
+    "Connection: close\r\n\r\n";
+
+// Gauges read straight from the snapshot (skipped while NAN)
+struct SnapshotGauge {
+    const char *name;
+    const char *help;
+    float SensorSnapshot::*field;
+    uint8_t decimals;
+};
+
+static const SnapshotGauge snapshotGauges[] = {
+    {"temperature_celsius", "Air temperature (BMP390)", &SensorSnapshot::temperature, 2},
+    {"humidity_percent", "Relative humidity (DHT11)", &SensorSnapshot::humidity, 1},
+    {"pressure_hectopascals", "Smoothed station pressure (BMP390)", &SensorSnapshot::pressure, 2},
+    {"sea_level_pressure_hectopascals", "Pressure reduced to sea level", &SensorSnapshot::seaLevelPressure, 2},
+    {"altitude_meters", "Smoothed barometric altitude", &SensorSnapshot::altitude, 1},
+    {"dew_point_celsius", "Dew point", &SensorSnapshot::dewPoint, 2},
+    {"heat_index_celsius", "Heat index", &SensorSnapshot::heatIndex, 2},
+    {"absolute_humidity_grams_per_cubic_meter", "Water vapour density", &SensorSnapshot::absoluteHumidity, 2},
+};
+#define SNAPSHOT_GAUGE_COUNT (sizeof(snapshotGauges) / sizeof(snapshotGauges[0]))
+
+// Families after the snapshot gauges, in response order
+enum MetricsFamily {
+    FAMILY_SAMPLE_AGE,
+    FAMILY_PRESSURE_RATE,
+    FAMILY_PRESSURE_CHANGE,
+    FAMILY_FORECAST,
+    FAMILY_SENSOR_READS,
+    FAMILY_SENSOR_INTERVAL,
+    FAMILY_UPTIME,
+    FAMILY_FREE_HEAP,
+    FAMILY_WIFI_RSSI,
+    FAMILY_PUBLISHED,
+    FAMILY_PUBLISH_FAILED,
+    FAMILY_TREND_FAILED,
+    FAMILY_MQTT_CONNECTS,
+    FAMILY_MQTT_FAILURES,
+    FAMILY_MQTT_QUEUED,
+    FAMILY_MQTT_DROPPED,
+    FAMILY_BACKLOG_PENDING,
+    FAMILY_BACKLOG_DROPPED,
+    FAMILY_LOG_DROPPED,
+    FAMILY_SCRAPES,
+    FAMILY_REFUSED,
+    FAMILY_COUNT
+};
+
+#define METRICS_STEP_COUNT (SNAPSHOT_GAUGE_COUNT + FAMILY_COUNT)
+
+/**
+ * Appends the # HELP and # TYPE lines of a family
+ */
+static size_t appendFamilyHeader(char *buf, size_t size, size_t pos, const char *name,
+                                 const char *type, const char *help) {
+    pos = appendText(buf, size, pos, "# HELP " METRICS_PREFIX);
+    pos = appendText(buf, size, pos, name);
+    pos = appendText(buf, size, pos, " ");
+    pos = appendText(buf, size, pos, help);
+    pos = appendText(buf, size, pos, "\n# TYPE " METRICS_PREFIX);
+    pos = appendText(buf, size, pos, name);
+    pos = appendText(buf, size, pos, " ");
+    pos = appendText(buf, size, pos, type);
+    return appendText(buf, size, pos, "\n");
+}
+
+/**
+ * Appends the name and optional label of a sample, up to its value
+ * @param label Label name, NULL for none
+ * @param value Label value
+ */
+static size_t appendSampleName(char *buf, size_t size, size_t pos, const char *name,
+                               const char *label, const char *value) {
+    pos = appendText(buf, size, pos, METRICS_PREFIX);
+    pos = appendText(buf, size, pos, name);
+    if (label != NULL) {
+        pos = appendText(buf, size, pos, "{");
+        pos = appendText(buf, size, pos, label);
+        pos = appendText(buf, size, pos, "=\"");
+        pos = appendText(buf, size, pos, value);
+        pos = appendText(buf, size, pos, "\"}");
+    }
+    return appendText(buf, size, pos, " ");
+}
+
+/**
+ * Writes a family with one unlabelled sample
+ * @return Bytes written, 0 if the value is NAN
+ */
+static size_t writeFloatFamily(char *buf, size_t size, const char *name, const char *type,
+                               const char *help, float value, uint8_t decimals) {
+    if (isnan(value)) return 0;
+    size_t pos = appendFamilyHeader(buf, size, 0, name, type, help);
+    pos = appendSampleName(buf, size, pos, name, NULL, NULL);
+    pos = appendFixed(buf, size, pos, value, decimals);
+    return appendText(buf, size, pos, "\n");
+}
+
+/**
+ * Writes a family with one unlabelled integer sample
+ * @return Bytes written
+ */
+static size_t writeUIntFamily(char *buf, size_t size, const char *name, const char *type,
+                              const char *help, uint32_t value) {
+    size_t pos = appendFamilyHeader(buf, size, 0, name, type, help);
+    pos = appendSampleName(buf, size, pos, name, NULL, NULL);
+    pos = appendUInt(buf, size, pos, value);
+    return appendText(buf, size, pos, "\n");
+}
+
+/**
+ * Writes a family with one sample per adaptively sampled sensor
+ * @param interval True for the read interval, false for the read count
+ * @return Bytes written
+ */
+static size_t writeSensorFamily(char *buf, size_t size, bool interval) {
+    const char *name = interval ? "sensor_read_interval_seconds" : "sensor_reads_total";
+    size_t pos = interval
+        ? appendFamilyHeader(buf, size, 0, name, "gauge", "Current read interval per sensor")
+        : appendFamilyHeader(buf, size, 0, name, "counter", "Sensor readings since boot");
+    for (int i = 0; i < SAMPLING_SOURCE_COUNT; i++) {
+        SamplingStats s;
+        getSamplingStats((SamplingSource)i, s);
+        pos = appendSampleName(buf, size, pos, name, "sensor", s.name);
+        pos = interval ? appendFixed(buf, size, pos, s.intervalMs / 1000.0f, 1)
+                       : appendUInt(buf, size, pos, s.samples);
+        pos = appendText(buf, size, pos, "\n");
+    }
+    return pos;
+}
+
+/**
+ * Writes one step of the /metrics body into the client's buffer
+ * @param c Client
+ * @param step Step index (< METRICS_STEP_COUNT)
+ * @return Bytes written, 0 if the family has no value yet
+ */
+static size_t writeFamily(MetricsClient &c, uint8_t step) {
+    char *buf = c.out;
+    size_t size = sizeof(c.out);
+
+    if (step < SNAPSHOT_GAUGE_COUNT) {
+        const SnapshotGauge &g = snapshotGauges[step];
+        return writeFloatFamily(buf, size, g.name, "gauge", g.help, c.snap.*(g.field), g.decimals);
+    }
+
+    PressureTrend trend;
+    MqttStats mqtt;
+    PublishStats publish;
+    StoreForwardStats backlog;
+    LogStats log;
+    switch (step - SNAPSHOT_GAUGE_COUNT) {
+        case FAMILY_SAMPLE_AGE:
+            if (c.snap.sequence == 0) return 0;
+            return writeFloatFamily(buf, size, "sample_age_seconds", "gauge", "Time since the newest reading",
+                                    (uint32_t)(millis() - c.snap.timestampMs) / 1000.0f, 1);
+        case FAMILY_PRESSURE_RATE:
+            getPressureTrend(trend);
+            return writeFloatFamily(buf, size, "pressure_rate_hectopascals_per_hour", "gauge",
+                                    "Sea-level pressure slope over the last hour", trend.rate1h, 2);
+        case FAMILY_PRESSURE_CHANGE:
+            getPressureTrend(trend);
+            return writeFloatFamily(buf, size, "pressure_change_3h_hectopascals", "gauge",
+                                    "Sea-level pressure change over 3 hours", trend.change3h, 2);
+        case FAMILY_FORECAST:
+            if (!getPressureTrend(trend) || trend.zambretti == 0) return 0;
+            return writeUIntFamily(buf, size, "zambretti_forecast", "gauge",
+                                   "Zambretti forecast number (1 settled fine .. 32 stormy)", trend.zambretti);
+        case FAMILY_SENSOR_READS:
+            return writeSensorFamily(buf, size, false);
+        case FAMILY_SENSOR_INTERVAL:
+            return writeSensorFamily(buf, size, true);
+        case FAMILY_UPTIME:
+            return writeUIntFamily(buf, size, "uptime_seconds", "counter", "Time since boot", millis() / 1000);
+        case FAMILY_FREE_HEAP:
+            return writeUIntFamily(buf, size, "free_heap_bytes", "gauge", "Free heap", ESP.getFreeHeap());
+        case FAMILY_WIFI_RSSI:
+            if (!wifiConnected()) return 0;
+            return writeFloatFamily(buf, size, "wifi_rssi_dbm", "gauge", "Wi-Fi signal strength", WiFi.RSSI(), 0);
+        case FAMILY_PUBLISHED:
+            getPublishStats(publish);
+            return writeUIntFamily(buf, size, "mqtt_published_total", "counter",
+                                   "Readings queued for the broker", publish.published);
+        case FAMILY_PUBLISH_FAILED:
+            getPublishStats(publish);
+            return writeUIntFamily(buf, size, "mqtt_publish_failures_total", "counter",
+                                   "Readings that could not be queued for the broker", publish.failed);
+        case FAMILY_TREND_FAILED:
+            getPublishStats(publish);
+            return writeUIntFamily(buf, size, "mqtt_trend_publish_failures_total", "counter",
+                                   "Pressure trend documents that could not be queued", publish.trendFailed);
+        case FAMILY_MQTT_CONNECTS:
+            getMqttStats(mqtt);
+            return writeUIntFamily(buf, size, "mqtt_connects_total", "counter",
+                                   "Successful broker connects", mqtt.connects);
+        case FAMILY_MQTT_FAILURES:
+            getMqttStats(mqtt);
+            return writeUIntFamily(buf, size, "mqtt_connect_failures_total", "counter",
+                                   "Failed broker connect attempts", mqtt.failures);
+        case FAMILY_MQTT_QUEUED:
+            getMqttStats(mqtt);
+            return writeUIntFamily(buf, size, "mqtt_outbox_queued", "gauge",
+                                   "Publishes waiting in the outbox", mqtt.outboxQueued);
+        case FAMILY_MQTT_DROPPED:
+            getMqttStats(mqtt);
+            return writeUIntFamily(buf, size, "mqtt_outbox_dropped_total", "counter",
+                                   "Publishes rejected because the outbox was full", mqtt.outboxDropped);
+        case FAMILY_BACKLOG_PENDING:
+            getStoreForwardStats(backlog);
+            return writeUIntFamily(buf, size, "backlog_pending_readings", "gauge",
+                                   "Readings stored in flash waiting for replay", backlog.pending);
+        case FAMILY_BACKLOG_DROPPED:
+            getStoreForwardStats(backlog);
+            return writeUIntFamily(buf, size, "backlog_dropped_total", "counter",
+                                   "Stored readings lost to segment rotation", backlog.dropped);
+        case FAMILY_LOG_DROPPED:
+            getLogStats(log);
+            return writeUIntFamily(buf, size, "log_dropped_total", "counter",
+                                   "Log records lost because the ring was full", log.dropped);
+        case FAMILY_SCRAPES:
+            return writeUIntFamily(buf, size, "metrics_scrapes_total", "counter",
+                                   "Completed scrapes of this endpoint", stats.scrapes);
+        case FAMILY_REFUSED:
+            return writeUIntFamily(buf, size, "metrics_refused_total", "counter",
+                                   "Scrapes refused because all client slots were busy", stats.refused);
+    }
+    return 0;
+}
+
+/**
+ * Ends a connection after the response: shuts down the sending side (FIN)
+ * and leaves the socket in the linger list, or closes it at once if the
+ * list is full
+ * @param fd Socket
+ */
+static void lingerClose(int fd) {
+    shutdown(fd, SHUT_WR);
+    for (int i = 0; i < METRICS_LINGER_SLOTS; i++) {
+        if (lingering[i].fd < 0) {
+            lingering[i].fd = fd;
+            lingering[i].sinceMs = millis();
+            return;
+        }
+    }
+    close(fd);
+}
+
+/**
+ * Discards what a lingering socket received; closes it once the client
+ * has closed, on error or after METRICS_LINGER_MS
+ * @param readable True if select() reported the socket readable
+ */
+static void serviceLingering(LingeringSocket &l, bool readable, uint32_t now) {
+    bool closed = false;
+    if (readable) {
+        char discard[64];
+        int n = recv(l.fd, discard, sizeof(discard), MSG_DONTWAIT);
+        closed = n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+    }
+    if (!closed && now - l.sinceMs <= METRICS_LINGER_MS) return;
+    close(l.fd);
+    l.fd = -1;
+}
+
+/**
+ * Closes a client and frees its slot
+ * @param ok True if the response was sent completely
+ */
+static void closeClient(MetricsClient &c, bool ok) {
+    lingerClose(c.fd);
+    c.fd = -1;
+    c.phase = METRICS_FREE;
+    taskENTER_CRITICAL(&statsMux);
+    stats.bytesSent += c.bytes;
+    if (!ok) {
+        stats.errors++;
+    } else if (c.scrape) {
+        stats.scrapes++;
+    }
+    taskEXIT_CRITICAL(&statsMux);
+    if (ok && c.scrape) {
+        perfRecord(PERF_METRICS_SCRAPE, micros() - c.startMicros);
+        perfAddBytes(PERF_METRICS_SCRAPE, c.bytes);
+    }
+}
+
+/**
+ * Chooses the response once the request headers are complete
+ */
+static void startResponse(MetricsClient &c) {
+    const char *response = methodResponse;
+    if (strncmp(c.request, "GET ", 4) == 0) {
+        const char *path = c.request + 4;
+        size_t length = strlen(METRICS_PATH);
+        bool match = strncmp(path, METRICS_PATH, length) == 0 &&
+                     (path[length] == ' ' || path[length] == '?' || path[length] == '\0');
+        response = match ? okHeader : notFoundResponse;
+    }
+
+    c.scrape = response == okHeader;
+    if (c.scrape) readSensorSnapshot(c.snap);
+    c.outLen = appendText(c.out, sizeof(c.out), 0, response);
+    c.outSent = 0;
+    c.step = c.scrape ? 0 : METRICS_STEP_COUNT;
+    c.phase = METRICS_WRITE;
+}
+
+/**
+ * Reads request bytes; keeps the request line and skips headers up to the
+ * empty line
+ */
+static void readClient(MetricsClient &c) {
+    char chunk[64];
+    int n = recv(c.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        closeClient(c, false);  // Client went away before finishing the request
+        return;
+    }
+    if (n < 0) return;
+
+    c.lastActivityMs = millis();
+    for (int i = 0; i < n; i++) {
+        char b = chunk[i];
+        if (b == '\n') {
+            if (c.lineStart && c.requestLineDone) {
+                startResponse(c);
+                return;
+            }
+            c.requestLineDone = true;
+            c.lineStart = true;
+        } else if (b != '\r') {
+            c.lineStart = false;
+            if (!c.requestLineDone && c.requestLen + 1 < METRICS_REQUEST_BYTES) {
+                c.request[c.requestLen++] = b;
+                c.request[c.requestLen] = '\0';
+            }
+        }
+    }
+}
+
+/**
+ * Sends as much of the response as the socket takes, refilling the buffer
+ * one family at a time
+ */
+static void writeClient(MetricsClient &c) {
+    while (true) {
+        if (c.outSent == c.outLen) {
+            c.outLen = c.outSent = 0;
+            while (c.outLen == 0 && c.step < METRICS_STEP_COUNT) {
+                c.outLen = writeFamily(c, c.step++);
+            }
+            if (c.outLen == 0) {
+                closeClient(c, true);  // Closing marks the end of the body
+                return;
+            }
+        }
+
+        int n = send(c.fd, c.out + c.outSent, c.outLen - c.outSent, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) closeClient(c, false);
+            return;  // Socket buffer full, wait for select()
+        }
+        c.outSent += n;
+        c.bytes += n;
+        c.lastActivityMs = millis();
+    }
+}
+
+/**
+ * Accepts pending connections into free slots, refusing the rest
+ */
+static void acceptClients() {
+    while (true) {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) return;
+
+        MetricsClient *c = NULL;
+        for (int i = 0; i < METRICS_MAX_CLIENTS && c == NULL; i++) {
+            if (clients[i].phase == METRICS_FREE) c = &clients[i];
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        if (c == NULL) {
+            taskENTER_CRITICAL(&statsMux);
+            stats.refused++;
+            taskEXIT_CRITICAL(&statsMux);
+            send(fd, busyResponse, sizeof(busyResponse) - 1, MSG_DONTWAIT);  // Best effort
+            lingerClose(fd);  // The unread request is discarded there
+            continue;
+        }
+
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        c->fd = fd;
+        c->phase = METRICS_READ;
+        c->scrape = false;
+        c->lineStart = false;
+        c->requestLineDone = false;
+        c->requestLen = 0;
+        c->request[0] = '\0';
+        c->bytes = 0;
+        c->startMicros = micros();
+        c->lastActivityMs = millis();
+    }
+}
+
+/**
+ * Server task: waits in select() and services every ready socket
+ */
+static void metricsTask(void *parameter) {
+    while (true) {
+        fd_set readSet;
+        fd_set writeSet;
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_SET(listenFd, &readSet);
+        int maxFd = listenFd;
+        bool busy = false;
+        for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+            MetricsClient &c = clients[i];
+            if (c.phase == METRICS_FREE) continue;
+            FD_SET(c.fd, c.phase == METRICS_READ ? &readSet : &writeSet);
+            if (c.fd > maxFd) maxFd = c.fd;
+            busy = true;
+        }
+        for (int i = 0; i < METRICS_LINGER_SLOTS; i++) {
+            if (lingering[i].fd < 0) continue;
+            FD_SET(lingering[i].fd, &readSet);
+            if (lingering[i].fd > maxFd) maxFd = lingering[i].fd;
+            busy = true;
+        }
+
+        // Sleep until something happens; wake once a second only to time out idle sockets
+        struct timeval timeout = {1, 0};
+        int ready = select(maxFd + 1, &readSet, &writeSet, NULL, busy ? &timeout : NULL);
+        if (ready < 0) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        if (FD_ISSET(listenFd, &readSet)) acceptClients();
+
+        uint32_t now = millis();
+        for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+            MetricsClient &c = clients[i];
+            if (c.phase == METRICS_FREE) continue;
+            if (c.phase == METRICS_READ && FD_ISSET(c.fd, &readSet)) {
+                readClient(c);
+            } else if (c.phase == METRICS_WRITE && FD_ISSET(c.fd, &writeSet)) {
+                writeClient(c);
+            } else if (now - c.lastActivityMs > METRICS_CLIENT_TIMEOUT_MS) {
+                closeClient(c, false);
+            }
+        }
+        now = millis();  // Sockets may have joined the list above
+        for (int i = 0; i < METRICS_LINGER_SLOTS; i++) {
+            LingeringSocket &l = lingering[i];
+            if (l.fd >= 0) serviceLingering(l, FD_ISSET(l.fd, &readSet), now);
+        }
+    }
+}
+
+/**
+ * Opens the listening socket and starts the server task
+ * Call after setupWiFi(); the socket accepts connections once Wi-Fi is up.
+ * @return bool Returns false if the socket could not be opened
+ */
+bool setupMetricsServer() {
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].phase = METRICS_FREE;
+    }
+    for (int i = 0; i < METRICS_LINGER_SLOTS; i++) {
+        lingering[i].fd = -1;
+    }
+
+    listenFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenFd < 0) {
+        LOG_ERROR("❌ Metrics server: socket() failed");
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(METRICS_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listenFd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(listenFd, METRICS_MAX_CLIENTS) < 0) {
+        LOG_ERROR("❌ Metrics server: port %d unavailable", METRICS_PORT);
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+
+    xTaskCreate(metricsTask, "metrics", METRICS_TASK_STACK, NULL, METRICS_TASK_PRIORITY, NULL);
+    LOG_INFO("📈 Metrics server on port %d, path " METRICS_PATH, METRICS_PORT);
+    return true;
+}
+
+/**
+ * Copies the counters; safe from any task
+ * @param out Destination for the counters
+ */
+void getMetricsStats(MetricsStats &out) {
+    taskENTER_CRITICAL(&statsMux);
+    out = stats;
+    taskEXIT_CRITICAL(&statsMux);
+}
+
+/**
+ * Prints the scrape report
+ */
+void printMetricsStats() {
+    MetricsStats s;
+    getMetricsStats(s);
+    reportPrintf("📈 Metrics: %lu scrapes, %lu refused, %lu errors, %lu bytes\n",
+                 (unsigned long)s.scrapes, (unsigned long)s.refused,
+                 (unsigned long)s.errors, (unsigned long)s.bytesSent);
+}
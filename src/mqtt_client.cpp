@@ -1,32 +1,346 @@
-#include <WiFi.h>
-#include "include/mqtt_client.h"
-#include "include/mqtt_publisher.h"
-#include <Arduino.h>
-#include "include/secrets.h"
-#include <PubSubClient.h>
-
-// Global WiFi and MQTT client instances
-WiFiClient espClient;
-PubSubClient client(espClient);
-
-/**
- * Sets up and establishes MQTT connection
- * This function configures the MQTT server, attempts to connect,
- * and handles discovery message publication on first connection
- */
-void setupMQTT() {
-    static bool firstBoot = true;
-
-    client.setBufferSize(512);  // Increase buffer size for larger messages
-    client.setServer(MQTT_SERVER, 1883);
-    
-    if (client.connect("ESP32WeatherStation", MQTT_USER, MQTT_PASS)) {
-        if (firstBoot) {
-            Serial.println("Connected to MQTT broker!");
-            Serial.printf("MQTT Buffer Size: %d\n", client.getBufferSize());
-            firstBoot = false;
-        }
-    } else {
-        Serial.printf("⚠️ MQTT Connection Failed! Error: %d\n", client.state());
-    }
-}
+#include <WiFi.h>
+#include "include/mqtt_client.h"
+#include "include/mqtt_publisher.h"
+#include "include/wifi_manager.h"
+#include <Arduino.h>
+#include "include/secrets.h"
+#include <PubSubClient.h>
+#include "include/boot_trace.h"
+#include "include/perf_stats.h"
+#include "include/deferred_log.h"
+
+// Global WiFi and MQTT client instances
+WiFiClient espClient;
+PubSubClient client(espClient);
+
+/*
+ * Connection manager.
+ * PubSubClient has no asynchronous connect, so each attempt is bounded
+ * instead: the TCP connect is made with MQTT_CONNECT_TIMEOUT_MS (PubSubClient
+ * reuses an open socket) and the CONNACK wait with MQTT_SOCKET_TIMEOUT_S.
+ * The broker name is resolved once and the address reused, because a DNS
+ * lookup has no timeout of its own; it is looked up again only after
+ * MQTT_DNS_REFRESH_FAILURES failures in a row, in case the broker moved.
+ * Failed attempts back off exponentially with equal jitter, so a fleet of
+ * stations does not hammer a restarting broker in lockstep.
+ */
+static IPAddress brokerAddress;                // Resolved MQTT_SERVER
+static bool brokerResolved = false;            // brokerAddress is valid
+static bool wasConnected = false;              // Connection state at the last service call
+static unsigned long disconnectedSince = 0;    // millis() when the connection was lost
+static unsigned long nextAttemptTime = 0;      // millis() of the next connect attempt
+static uint8_t failedAttempts = 0;             // Consecutive failures, drives the backoff
+
+/*
+ * Outbound queue. Entries point at the topic (always a string constant) and
+ * either at a static payload or at a copy held in the slot. serviceMQTT()
+ * writes all queued entries back-to-back; QoS 0 publishes need no reply, so
+ * nothing waits between them.
+ */
+struct OutboxEntry {
+    const char *topic;
+    const char *payload;                       // Static payload, or data below
+    uint32_t queuedMicros;
+    bool retain;
+    char data[MQTT_OUTBOX_PAYLOAD_BYTES];
+};
+
+static OutboxEntry outbox[MQTT_OUTBOX_SLOTS];
+static uint8_t outboxHead = 0;                 // Oldest entry
+static uint8_t outboxCount = 0;
+static portMUX_TYPE outboxMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Recent latency samples for the percentile report
+#define RECONNECT_SAMPLES 16
+#define PUBLISH_SAMPLES 64
+static uint32_t reconnectSamples[RECONNECT_SAMPLES];
+static uint32_t publishSamples[PUBLISH_SAMPLES];
+static uint32_t reconnectSampleCount = 0;
+static uint32_t publishSampleCount = 0;
+
+static uint32_t connectCount = 0;
+static uint32_t failureCount = 0;
+static uint32_t outboxDropped = 0;
+
+/**
+ * Stores a latency sample in a ring of recent samples
+ */
+static void recordSample(uint32_t *samples, uint32_t size, uint32_t &count, uint32_t value) {
+    samples[count % size] = value;
+    count++;
+}
+
+/**
+ * Publishes one message and records the call duration and size
+ */
+static bool timedPublish(const char *topic, const char *payload, bool retain) {
+    uint32_t start = micros();
+    bool ok = client.publish(topic, payload, retain);
+    perfRecord(PERF_MQTT_PUBLISH, micros() - start);
+    if (ok) perfAddBytes(PERF_MQTT_PUBLISH, strlen(topic) + strlen(payload));
+    return ok;
+}
+
+/**
+ * Sets up the MQTT client
+ * Connecting is done by serviceMQTT() or connectMQTT()
+ */
+void setupMQTT() {
+    client.setBufferSize(512);  // Increase buffer size for larger messages
+    client.setServer(MQTT_SERVER, MQTT_PORT);
+    client.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+    client.setKeepAlive(MQTT_KEEPALIVE_S);
+}
+
+/**
+ * Makes one connection attempt with bounded waits
+ * @return bool Returns true if connected
+ */
+bool connectMQTT() {
+    if (client.connected()) return true;
+
+    if (!brokerResolved) {
+        if (!WiFi.hostByName(MQTT_SERVER, brokerAddress)) {
+            LOG_WARN("⚠️ MQTT Connection Failed! Broker name not resolved.");
+            failureCount++;
+            return false;
+        }
+        brokerResolved = true;
+        client.setServer(brokerAddress, MQTT_PORT);
+    }
+
+    // Open the socket with our own timeout; PubSubClient reuses it
+    if (!espClient.connect(brokerAddress, MQTT_PORT, MQTT_CONNECT_TIMEOUT_MS)) {
+        LOG_WARN("⚠️ MQTT Connection Failed! Broker unreachable.");
+        failureCount++;
+        return false;
+    }
+
+    if (!client.connect("ESP32WeatherStation", MQTT_USER, MQTT_PASS)) {
+        LOG_WARN("⚠️ MQTT Connection Failed! Error: %d", client.state());
+        espClient.stop();
+        failureCount++;
+        return false;
+    }
+
+    connectCount++;
+    bootTraceMark(BOOT_MQTT_CONNECTED);
+    if (connectCount == 1) {
+        LOG_INFO("Connected to MQTT broker!");
+        LOG_DEBUG("MQTT Buffer Size: %d", client.getBufferSize());
+    }
+    return true;
+}
+
+/**
+ * Computes the delay before the next attempt: exponential, capped, with
+ * equal jitter (uniform between half and all of the exponential delay)
+ */
+static unsigned long backoffDelay() {
+    unsigned long delayMs = MQTT_BACKOFF_MIN_MS;
+    for (uint8_t i = 1; i < failedAttempts && delayMs < MQTT_BACKOFF_MAX_MS; i++) {
+        delayMs *= 2;
+    }
+    if (delayMs > MQTT_BACKOFF_MAX_MS) delayMs = MQTT_BACKOFF_MAX_MS;
+    return delayMs / 2 + esp_random() % (delayMs / 2 + 1);
+}
+
+/**
+ * Services the connection: reconnects with backoff when down, runs
+ * client.loop() and sends queued publishes when up
+ * @return unsigned long Milliseconds until this should be called again
+ */
+unsigned long serviceMQTT() {
+    unsigned long now = millis();
+
+    if (wasConnected && !client.connected()) {
+        LOG_WARN("⚠️ MQTT connection lost!");
+        wasConnected = false;
+        disconnectedSince = now;
+        nextAttemptTime = now;  // First retry immediately
+        failedAttempts = 0;
+    }
+
+    if (!client.connected()) {
+        if (!wifiConnected()) return 500;  // Wait for the Wi-Fi job
+        if ((long)(now - nextAttemptTime) < 0) return nextAttemptTime - now;
+
+        if (!connectMQTT()) {
+            if (failedAttempts < 255) failedAttempts++;
+            if (failedAttempts % MQTT_DNS_REFRESH_FAILURES == 0) brokerResolved = false;
+            unsigned long delayMs = backoffDelay();
+            nextAttemptTime = millis() + delayMs;
+            LOG_INFO("MQTT retry in %lu ms", delayMs);
+            return delayMs;
+        }
+
+        if (connectCount > 1) {
+            recordSample(reconnectSamples, RECONNECT_SAMPLES, reconnectSampleCount, millis() - disconnectedSince);
+        }
+        wasConnected = true;
+        failedAttempts = 0;
+    }
+
+    client.loop();
+    mqttFlush();
+    return MQTT_LOOP_INTERVAL_MS;
+}
+
+/**
+ * Checks whether the broker connection is up
+ * @return bool Returns true if connected
+ */
+bool mqttConnected() {
+    return client.connected();
+}
+
+/**
+ * Queues a publish for the next serviceMQTT() or mqttFlush()
+ * @param topic Topic, must stay valid until sent (string constant)
+ * @param payload Payload text
+ * @param retain Retain flag
+ * @param copy True to copy the payload, false if it is a static string
+ * @return bool Returns false if the outbox is full or the payload too large to copy
+ */
+bool mqttEnqueue(const char *topic, const char *payload, bool retain, bool copy) {
+    size_t length = copy ? strlen(payload) : 0;
+    if (length >= MQTT_OUTBOX_PAYLOAD_BYTES) return false;
+
+    taskENTER_CRITICAL(&outboxMux);
+    if (outboxCount == MQTT_OUTBOX_SLOTS) {
+        outboxDropped++;
+        taskEXIT_CRITICAL(&outboxMux);
+        return false;
+    }
+    OutboxEntry &e = outbox[(outboxHead + outboxCount) % MQTT_OUTBOX_SLOTS];
+    e.topic = topic;
+    e.retain = retain;
+    e.queuedMicros = micros();
+    if (copy) {
+        memcpy(e.data, payload, length + 1);
+        e.payload = e.data;
+    } else {
+        e.payload = payload;
+    }
+    outboxCount++;
+    taskEXIT_CRITICAL(&outboxMux);
+    return true;
+}
+
+/**
+ * Publishes immediately and records the latency
+ * For callers that must know the outcome, such as the backlog replay
+ * @return bool Returns true if the message was written to the socket
+ */
+bool mqttPublishNow(const char *topic, const char *payload, bool retain) {
+    uint32_t start = micros();
+    if (!timedPublish(topic, payload, retain)) return false;
+    recordSample(publishSamples, PUBLISH_SAMPLES, publishSampleCount, micros() - start);
+    return true;
+}
+
+/**
+ * Publishes a binary payload immediately
+ * @param topic Topic
+ * @param payload Payload bytes (may contain zeros)
+ * @param length Payload length
+ * @param retain Retain flag
+ * @return bool Returns true if the message was written to the socket
+ */
+bool mqttPublishBinary(const char *topic, const uint8_t *payload, size_t length, bool retain) {
+    uint32_t start = micros();
+    bool ok = client.publish(topic, payload, length, retain);
+    uint32_t elapsed = micros() - start;
+    perfRecord(PERF_MQTT_PUBLISH, elapsed);
+    if (!ok) return false;
+    perfAddBytes(PERF_MQTT_PUBLISH, strlen(topic) + length);
+    recordSample(publishSamples, PUBLISH_SAMPLES, publishSampleCount, elapsed);
+    return true;
+}
+
+/**
+ * Sends all queued publishes back-to-back
+ * Stops at the first failure and keeps the rest for after the reconnect
+ */
+void mqttFlush() {
+    while (client.connected()) {
+        taskENTER_CRITICAL(&outboxMux);
+        if (outboxCount == 0) {
+            taskEXIT_CRITICAL(&outboxMux);
+            return;
+        }
+        OutboxEntry &e = outbox[outboxHead];
+        taskEXIT_CRITICAL(&outboxMux);
+
+        // Only this task removes entries, so e stays valid while publishing
+        if (!timedPublish(e.topic, e.payload, e.retain)) return;
+        recordSample(publishSamples, PUBLISH_SAMPLES, publishSampleCount, micros() - e.queuedMicros);
+
+        taskENTER_CRITICAL(&outboxMux);
+        outboxHead = (outboxHead + 1) % MQTT_OUTBOX_SLOTS;
+        outboxCount--;
+        taskEXIT_CRITICAL(&outboxMux);
+    }
+}
+
+/**
+ * Computes percentiles over a ring of recent samples
+ */
+static void computePercentiles(const uint32_t *samples, uint32_t size, uint32_t count, LatencyPercentiles &out) {
+    uint32_t n = count < size ? count : size;
+    uint32_t sorted[PUBLISH_SAMPLES];
+    memcpy(sorted, samples, n * sizeof(uint32_t));
+
+    // Insertion sort; at most 64 samples
+    for (uint32_t i = 1; i < n; i++) {
+        uint32_t v = sorted[i];
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    out.count = n;
+    if (n == 0) {
+        out.p50 = out.p90 = out.p99 = out.max = 0;
+        return;
+    }
+    out.p50 = sorted[(n - 1) * 50 / 100];
+    out.p90 = sorted[(n - 1) * 90 / 100];
+    out.p99 = sorted[(n - 1) * 99 / 100];
+    out.max = sorted[n - 1];
+}
+
+/**
+ * Copies the connection counters and latency percentiles
+ * @param out Destination for the statistics
+ */
+void getMqttStats(MqttStats &out) {
+    out.connects = connectCount;
+    out.failures = failureCount;
+    out.outboxDropped = outboxDropped;
+    out.outboxQueued = outboxCount;
+    computePercentiles(reconnectSamples, RECONNECT_SAMPLES, reconnectSampleCount, out.reconnectMs);
+    computePercentiles(publishSamples, PUBLISH_SAMPLES, publishSampleCount, out.publishUs);
+}
+
+/**
+ * Prints the connection and latency report
+ */
+void printMqttStats() {
+    MqttStats stats;
+    getMqttStats(stats);
+    reportPrintf("📶 MQTT: %lu connects, %lu failures, %lu dropped, %u queued\n",
+                 (unsigned long)stats.connects, (unsigned long)stats.failures,
+                 (unsigned long)stats.outboxDropped, stats.outboxQueued);
+    reportPrintf("   reconnect ms  n=%-3lu p50 %6lu p90 %6lu p99 %6lu max %6lu\n",
+                 (unsigned long)stats.reconnectMs.count, (unsigned long)stats.reconnectMs.p50,
+                 (unsigned long)stats.reconnectMs.p90, (unsigned long)stats.reconnectMs.p99,
+                 (unsigned long)stats.reconnectMs.max);
+    reportPrintf("   publish us    n=%-3lu p50 %6lu p90 %6lu p99 %6lu max %6lu\n",
+                 (unsigned long)stats.publishUs.count, (unsigned long)stats.publishUs.p50,
+                 (unsigned long)stats.publishUs.p90, (unsigned long)stats.publishUs.p99,
+                 (unsigned long)stats.publishUs.max);
+}
@@ -2,134 +2,302 @@
 #include "include/mqtt_publisher.h"
 #include "include/dht_sensor.h"
 #include "include/bmp390_sensor.h"
+#include "include/perf_stats.h"
+#include "include/store_forward.h"
+#include "include/number_format.h"
+#include "include/sensor_registry.h"
+#include "include/binary_telemetry.h"
+#include "include/pressure_trend.h"
+#include "include/time_manager.h"
+#include "include/deferred_log.h"
 #include <Arduino.h>
 
 // External declarations for MQTT client and timing
 extern PubSubClient client;           // MQTT client instance
 extern unsigned long mqttSentDisplayTime;  // Timestamp for last successful MQTT data send
 
-// MQTT topic definitions for sensor state
-const char* topic_state_temp = "homeassistant/sensor/bmp390_temperature/state";
-const char* topic_state_humidity = "homeassistant/sensor/bmp390_humidity/state";
-const char* topic_state_altitude = "homeassistant/sensor/bmp390_altitude/state";
-const char* topic_state_pressure = "homeassistant/sensor/bmp390_pressure/state";
+// MQTT topic for readings replayed from the store-and-forward queue
+const char* topic_backlog = "homeassistant/sensor/bmp390_weather/backlog";
 
-// MQTT topic definitions for sensor discovery
-const char* topic_discovery_temp = "homeassistant/sensor/bmp390_temperature/config";
-const char* topic_discovery_humidity = "homeassistant/sensor/bmp390_humidity/config";
-const char* topic_discovery_altitude = "homeassistant/sensor/bmp390_altitude/config";
-const char* topic_discovery_pressure = "homeassistant/sensor/bmp390_pressure/config";
+// Last successfully published readings, used by the deadband policy
+static SensorSnapshot lastPublished;
+static unsigned long lastPublishTime = 0;
+static bool hasPublished = false;
+
+// Publish counters for the metrics endpoint
+static PublishStats publishStats = {0, 0, 0};
+
+// Discovery messages are retained by the broker, so they are sent once per power-on
+RTC_DATA_ATTR bool discoveryPublished = false;
 
 /**
  * Publishes discovery messages for all sensors to Home Assistant
- * This function creates and sends MQTT discovery payloads for temperature,
- * humidity, pressure, and altitude sensors
+ * This function queues the precomputed MQTT discovery payload of every
+ * registered sensor and of the pressure trend sensors; they go out
+ * back-to-back on the next outbox flush
  * 
- * @return bool Returns true if all discovery messages were sent successfully
+ * @return bool Returns true if all discovery messages were queued
  */
 bool publishDiscoveryMessages() {
     if (!client.connected()) {
-        Serial.println("⚠️ Cannot send discovery messages - MQTT not connected!");
+        LOG_WARN("⚠️ Cannot send discovery messages - MQTT not connected!");
         return false;
     }
 
-    char discoveryPayload[512];
     bool success = true;
 
-    // Temperature sensor discovery
-    snprintf(discoveryPayload, sizeof(discoveryPayload),
-        "{\"name\":\"BMP390 Temperature\","
-        "\"state_topic\":\"homeassistant/sensor/bmp390_temperature/state\","
-        "\"unique_id\":\"bmp390_temperature\","
-        "\"unit_of_measurement\":\"°F\","
-        "\"device_class\":\"temperature\","
-        "\"value_template\":\"{{ value_json.temperature }}\"}");
-    
-    success &= client.publish("homeassistant/sensor/bmp390_temperature/config", discoveryPayload, true);
-    delay(200);
-
-    // Humidity sensor discovery
-    snprintf(discoveryPayload, sizeof(discoveryPayload),
-        "{\"name\":\"BMP390 Humidity\","
-        "\"state_topic\":\"homeassistant/sensor/bmp390_humidity/state\","
-        "\"unique_id\":\"bmp390_humidity\","
-        "\"unit_of_measurement\":\"%\","
-        "\"device_class\":\"humidity\","
-        "\"value_template\":\"{{ value_json.humidity }}\"}");
-    
-    success &= client.publish("homeassistant/sensor/bmp390_humidity/config", discoveryPayload, true);
-    delay(200);
-
-    // Pressure sensor discovery
-    snprintf(discoveryPayload, sizeof(discoveryPayload),
-        "{\"name\":\"BMP390 Pressure\","
-        "\"state_topic\":\"homeassistant/sensor/bmp390_pressure/state\","
-        "\"unique_id\":\"bmp390_pressure\","
-        "\"unit_of_measurement\":\"hPa\","
-        "\"device_class\":\"pressure\","
-        "\"value_template\":\"{{ value_json.pressure }}\"}");
-    
-    success &= client.publish("homeassistant/sensor/bmp390_pressure/config", discoveryPayload, true);
-    delay(200);
-
-    // Altitude sensor discovery
-    snprintf(discoveryPayload, sizeof(discoveryPayload),
-        "{\"name\":\"BMP390 Altitude\","
-        "\"state_topic\":\"homeassistant/sensor/bmp390_altitude/state\","
-        "\"unique_id\":\"bmp390_altitude\","
-        "\"unit_of_measurement\":\"ft\","
-        "\"icon\":\"mdi:altimeter\","
-        "\"value_template\":\"{{ value_json.altitude }}\"}");
-    
-    success &= client.publish("homeassistant/sensor/bmp390_altitude/config", discoveryPayload, true);
+    // Documents are string literals from the sensor registry, so they are not copied
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const SensorDescriptor &d = sensorRegistry[i];
+        success &= mqttEnqueue(d.discoveryTopic, d.discoveryPayload, true, false);
+    }
+    success &= publishPressureTrendDiscovery();
 
     if (success) {
-        Serial.println("✅ MQTT Discovery messages sent successfully!");
+        discoveryPublished = true;
+        LOG_INFO("✅ MQTT Discovery messages sent successfully!");
     } else {
-        Serial.println("⚠️ Failed to send discovery messages!");
+        LOG_WARN("⚠️ Failed to send discovery messages!");
     }
     
     return success;
 }
 
+/**
+ * Decides whether the current readings should be published
+ * Readings are due when any metric left its deadband and the minimum
+ * interval has passed, or when the maximum interval has passed
+ *
+ * @param now Current time (millis)
+ * @return bool Returns true if publishSensorData() should run now
+ */
+bool sensorDataPublishDue(unsigned long now) {
+    SensorSnapshot snap;
+    readSensorSnapshot(snap);
+
+    if (isnan(snap.pressure) || isnan(snap.humidity)) return false;  // Wait for both sensors
+    if (!hasPublished) return true;         // First publish after boot
+
+    unsigned long elapsed = now - lastPublishTime;
+    if (elapsed >= PUBLISH_MAX_INTERVAL_MS) return true;
+    if (elapsed < PUBLISH_MIN_INTERVAL_MS) return false;
+
+    return sensorsOutsideDeadband(snap, lastPublished);
+}
+
+/**
+ * Returns the time left before the maximum interval forces a publish
+ * @param now Current time (millis)
+ * @return Milliseconds until the next forced publish (0 if already due)
+ */
+unsigned long msUntilForcedPublish(unsigned long now) {
+    if (!hasPublished) return 0;
+    unsigned long elapsed = now - lastPublishTime;
+    return elapsed >= PUBLISH_MAX_INTERVAL_MS ? 0 : PUBLISH_MAX_INTERVAL_MS - elapsed;
+}
+
+/**
+ * Records readings as handled by the publish policy
+ * @param snap Readings that were published or queued
+ * @param now Current time (millis)
+ */
+static void markReadingsHandled(const SensorSnapshot &snap, unsigned long now) {
+    lastPublishTime = now;
+    lastPublished = snap;
+    hasPublished = true;
+}
+
+/**
+ * Counts the current readings as published without sending them
+ * Lets trace replay run the publish policy offline
+ * @param now Current time (millis, or trace time)
+ */
+void markSensorDataPublished(unsigned long now) {
+    SensorSnapshot snap;
+    readSensorSnapshot(snap);
+    markReadingsHandled(snap, now);
+}
+
+/**
+ * Forgets the last publish, so the next complete reading is due at once
+ * Lets trace replay start from the state after boot
+ */
+void resetPublishPolicy() {
+    hasPublished = false;
+    lastPublishTime = 0;
+}
+
+/**
+ * Returns the time a set of readings was sampled
+ * Before NTP has set the clock, this is the uptime flagged with
+ * QUEUED_TIME_UPTIME; store-and-forward dates it at replay
+ *
+ * @param snap Readings
+ * @return Unix time (s), or uptime (s) | QUEUED_TIME_UPTIME
+ */
+static uint32_t sampleTimestamp(const SensorSnapshot &snap) {
+    if (!timeSynced()) {
+        return (snap.timestampMs / 1000) | QUEUED_TIME_UPTIME;
+    }
+    uint32_t ageSec = (millis() - snap.timestampMs) / 1000;
+    return (uint32_t)time(NULL) - ageSec;
+}
+
+/**
+ * Queues the current readings for later replay while the broker is unreachable
+ * The readings count as published for the deadband policy, so the queue
+ * fills at the same rate the broker would have been fed
+ */
+void queueSensorData() {
+    SensorSnapshot snap;
+    readSensorSnapshot(snap);
+
+    // Timestamp the readings with the wall-clock time they were sampled
+    storeForwardAppend(snap, sampleTimestamp(snap));
+    markReadingsHandled(snap, millis());
+}
+
+/**
+ * Replays queued readings to the backlog topic in batches
+ * Each message carries a JSON array of up to BACKLOG_RECORDS_PER_MESSAGE
+ * readings with their Unix timestamps
+ *
+ * @return bool Returns false if a publish failed and replay should stop
+ */
+static bool publishBacklogJson() {
+    QueuedReading batch[BACKLOG_RECORDS_PER_MESSAGE];
+    char payload[448];
+
+    for (int message = 0; message < BACKLOG_MESSAGES_PER_CALL; message++) {
+        size_t count = storeForwardPeek(batch, BACKLOG_RECORDS_PER_MESSAGE);
+        if (count == 0) break;
+
+        size_t len = appendText(payload, sizeof(payload), 0, "[");
+        for (size_t i = 0; i < count; i++) {
+            const QueuedReading &r = batch[i];
+            SensorSnapshot snap;
+            queuedReadingToSnapshot(r, snap);
+
+            len = appendText(payload, sizeof(payload), len, i ? ",{\"ts\":" : "{\"ts\":");
+            len = appendUInt(payload, sizeof(payload), len, r.timestamp);
+            len = appendSensorJson(payload, sizeof(payload), len, snap);
+            len = appendText(payload, sizeof(payload), len, "}");
+        }
+        appendText(payload, sizeof(payload), len, "]");
+
+        if (!mqttPublishNow(topic_backlog, payload, false)) {
+            return false;
+        }
+        perfAddBytes(PERF_PUBLISH_SENSOR_DATA, strlen(topic_backlog) + strlen(payload));
+        storeForwardConsume(count);
+    }
+    return true;
+}
+
+/**
+ * Replays a batch of queued readings
+ * JSON arrays on the backlog topic, or binary frames on the telemetry
+ * topic when MQTT_BINARY_TELEMETRY is set
+ *
+ * @return bool Returns false if a publish failed and replay should stop
+ */
+bool publishBacklog() {
+#if MQTT_BINARY_TELEMETRY
+    if (!telemetryPublishBacklog()) return false;
+#else
+    if (!publishBacklogJson()) return false;
+#endif
+
+    if (storeForwardPending() == 0) {
+        StoreForwardStats sf;
+        getStoreForwardStats(sf);
+        LOG_INFO("📤 Replayed %u queued readings in %u ms (%u flash bytes written since boot)",
+               (unsigned)sf.lastReplayRecords, (unsigned)sf.lastReplayMs, (unsigned)sf.flashBytesWritten);
+    }
+    return true;
+}
+
+#if !MQTT_COMBINED_STATE
+/**
+ * Formats a single-field JSON document such as { "humidity": 35.0 }
+ */
+static void formatJsonDocument(char *buf, size_t size, const char *name, float value, uint8_t decimals) {
+    size_t len = appendText(buf, size, 0, "{ \"");
+    len = appendText(buf, size, len, name);
+    len = appendText(buf, size, len, "\": ");
+    len = appendJsonNumber(buf, size, len, value, decimals);
+    appendText(buf, size, len, " }");
+}
+#endif
+
 /**
  * Publishes current sensor data to MQTT topics
  * This function reads sensor values, converts units where necessary,
- * and publishes the data to Home Assistant
+ * and queues the documents for Home Assistant on the MQTT outbox
+ *
+ * @return bool Returns true if all readings were queued
  */
-void publishSensorData() {
+bool publishSensorData() {
     // Check MQTT connection status
     if (!client.connected()) {
-        Serial.println("⚠️ MQTT Publish Failed! Retrying in 5 seconds...");
-        vTaskDelay(pdMS_TO_TICKS(5000));  // Wait 5 seconds before retry
-        return;
+        LOG_WARN("⚠️ MQTT Publish Failed! Not connected.");
+        publishStats.failed++;
+        return false;
     }
 
-    // Convert temperature to Fahrenheit and altitude to feet
-    float temperatureF = (temperature * 1.8) + 32;
-    float altitudeFt = altitude * 3.28084;
+    // Take one consistent set of readings for all topics
+    SensorSnapshot snap;
+    readSensorSnapshot(snap);
 
-    char payload[50];  // Buffer for sensor data payload
     bool success = true;  // Flag to track publish success
+    uint32_t bytesOut = 0;  // Topic and payload bytes handed to the broker
 
-    // Publish temperature data
-    snprintf(payload, sizeof(payload), "{ \"temperature\": %.2f }", temperatureF);
-    if (!client.publish(topic_state_temp, payload, true)) success = false;
+#if MQTT_COMBINED_STATE
+    char payload[MQTT_OUTBOX_PAYLOAD_BYTES];  // Buffer for the combined state document
 
-    // Publish humidity data
-    snprintf(payload, sizeof(payload), "{ \"humidity\": %.1f }", humidity);
-    if (!client.publish(topic_state_humidity, payload, true)) success = false;
+    // Publish all readings as one JSON document
+    size_t len = appendText(payload, sizeof(payload), 0, "{");
+    len = appendSensorJson(payload, sizeof(payload), len, snap);
+    appendText(payload, sizeof(payload), len, "}");
+    if (!mqttEnqueue(STATE_TOPIC_COMBINED, payload, true, true)) success = false;
+    bytesOut += strlen(STATE_TOPIC_COMBINED) + strlen(payload);
+#else
+    char payload[50];  // Buffer for sensor data payload
 
-    // Publish altitude data
-    snprintf(payload, sizeof(payload), "{ \"altitude\": %.0f }", altitudeFt);
-    if (!client.publish(topic_state_altitude, payload, true)) success = false;
+    // Publish each reading on its own topic
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const SensorDescriptor &d = sensorRegistry[i];
+        formatJsonDocument(payload, sizeof(payload), d.key, snap.*d.field, d.decimals);
+        if (!mqttEnqueue(d.stateTopic, payload, true, true)) success = false;
+        bytesOut += strlen(d.stateTopic) + strlen(payload);
+    }
+#endif
+
+    // Trend and forecast go on their own topic. The next publish sends
+    // them fresh, so a lost document must not send the readings to
+    // store-and-forward
+    if (!publishPressureTrend()) publishStats.trendFailed++;
 
-    // Publish pressure data
-    snprintf(payload, sizeof(payload), "{ \"pressure\": %.0f }", pressure);
-    if (!client.publish(topic_state_pressure, payload, true)) success = false;
+    perfAddBytes(PERF_PUBLISH_SENSOR_DATA, bytesOut);
 
     // Log success status
     if (success) {
         mqttSentDisplayTime = millis();  // Update last successful send time
+        markReadingsHandled(snap, mqttSentDisplayTime);
+        publishStats.published++;
+#if MQTT_BINARY_TELEMETRY
+        if (timeSynced()) telemetryAddReading(snap, sampleTimestamp(snap));  // Frames need Unix time
+#endif
+    } else {
+        publishStats.failed++;
     }
+    return success;
+}
+
+/**
+ * Copies the publish counters
+ * @param out Destination for the counters
+ */
+void getPublishStats(PublishStats &out) {
+    out = publishStats;
 }
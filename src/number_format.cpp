@@ -0,0 +1,173 @@
+#include "include/number_format.h"
+
+static const double powersOf10[FORMAT_MAX_DECIMALS + 1] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6 };
+
+/**
+ * Appends one character, keeping room for the terminator
+ */
+static size_t appendChar(char *buf, size_t size, size_t pos, char c) {
+    if (pos + 1 < size) {
+        buf[pos++] = c;
+        buf[pos] = '\0';
+    }
+    return pos;
+}
+
+/**
+ * Appends a string
+ * @param buf Destination buffer
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param text String to append
+ * @return New position
+ */
+size_t appendText(char *buf, size_t size, size_t pos, const char *text) {
+    while (*text && pos + 1 < size) {
+        buf[pos++] = *text++;
+    }
+    if (pos < size) buf[pos] = '\0';
+    return pos;
+}
+
+/**
+ * Appends a number with a fixed number of decimal places
+ * A float times 10^decimals (decimals <= 6) is exact in a double, so
+ * rounding it with rint() (ties to even) gives the same digits as printf
+ * without going through the float formatting code.
+ * @param buf Destination buffer
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param value Number to format
+ * @param decimals Digits after the decimal point (0-6)
+ * @return New position
+ */
+size_t appendFixed(char *buf, size_t size, size_t pos, float value, uint8_t decimals) {
+    if (isnan(value)) return appendText(buf, size, pos, signbit(value) ? "-nan" : "nan");
+    if (decimals > FORMAT_MAX_DECIMALS) decimals = FORMAT_MAX_DECIMALS;
+
+    double scaled = rint(fabs((double)value) * powersOf10[decimals]);
+    if (signbit(value)) pos = appendChar(buf, size, pos, '-');
+    if (!(scaled < 1.8e19)) return appendText(buf, size, pos, "inf");  // Beyond uint64_t
+
+    // Write digits right to left into a scratch buffer
+    uint64_t n = (uint64_t)scaled;
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = '0' + (n % 10);
+        n /= 10;
+        if (count == decimals) digits[count++] = '.';
+    } while (n > 0 || count <= decimals);
+    if (digits[count - 1] == '.') digits[count++] = '0';  // Leading zero before the point
+
+    while (count > 0) {
+        pos = appendChar(buf, size, pos, digits[--count]);
+    }
+    return pos;
+}
+
+/**
+ * Appends an unsigned integer
+ * @param buf Destination buffer
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param value Number to format
+ * @return New position
+ */
+size_t appendUInt(char *buf, size_t size, size_t pos, uint32_t value) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0) {
+        pos = appendChar(buf, size, pos, digits[--count]);
+    }
+    return pos;
+}
+
+/**
+ * Appends a number as a JSON value
+ * NAN and infinity have no JSON representation and are written as null
+ * @param buf Destination buffer
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param value Number to format
+ * @param decimals Digits after the decimal point (0-6)
+ * @return New position
+ */
+size_t appendJsonNumber(char *buf, size_t size, size_t pos, float value, uint8_t decimals) {
+    if (!isfinite(value)) return appendText(buf, size, pos, "null");
+    return appendFixed(buf, size, pos, value, decimals);
+}
+
+/**
+ * Appends "name": with a leading comma unless it is the first member
+ */
+static size_t appendJsonName(char *buf, size_t size, size_t pos, const char *name) {
+    if (pos > 0 && buf[pos - 1] != '{' && buf[pos - 1] != '[') {
+        pos = appendChar(buf, size, pos, ',');
+    }
+    pos = appendChar(buf, size, pos, '"');
+    pos = appendText(buf, size, pos, name);
+    return appendText(buf, size, pos, "\":");
+}
+
+/**
+ * Appends a JSON number field, adding a comma unless it is the first member
+ * A NAN or infinite value is written as null
+ * @param buf Destination buffer holding an open JSON object
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param name Field name
+ * @param value Field value
+ * @param decimals Digits after the decimal point
+ * @return New position
+ */
+size_t appendJsonField(char *buf, size_t size, size_t pos, const char *name,
+                       float value, uint8_t decimals) {
+    pos = appendJsonName(buf, size, pos, name);
+    return appendJsonNumber(buf, size, pos, value, decimals);
+}
+
+/**
+ * Appends a JSON integer field exactly (counters beyond float precision)
+ * @param buf Destination buffer holding an open JSON object
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param name Field name
+ * @param value Field value
+ * @return New position
+ */
+size_t appendJsonUInt(char *buf, size_t size, size_t pos, const char *name, uint32_t value) {
+    pos = appendJsonName(buf, size, pos, name);
+    return appendUInt(buf, size, pos, value);
+}
+
+/**
+ * Appends a JSON string field; the text is copied as is, so it must not
+ * contain quotes or backslashes
+ * @param buf Destination buffer holding an open JSON object
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param name Field name
+ * @param text Field value
+ * @return New position
+ */
+size_t appendJsonString(char *buf, size_t size, size_t pos, const char *name, const char *text) {
+    pos = appendJsonName(buf, size, pos, name);
+    pos = appendChar(buf, size, pos, '"');
+    pos = appendText(buf, size, pos, text);
+    return appendChar(buf, size, pos, '"');
+}
+
+/**
+ * Formats a number into an empty buffer
+ * @return Length of the text
+ */
+size_t formatFixed(char *buf, size_t size, float value, uint8_t decimals) {
+    if (size > 0) buf[0] = '\0';
+    return appendFixed(buf, size, 0, value, decimals);
+}
@@ -2,21 +2,53 @@
 #include "include/time_manager.h"
 #include "include/dht_sensor.h"
 #include "include/bmp390_sensor.h"
+#include "include/perf_stats.h"
+#include "include/oled_renderer.h"
+#include "include/i2c_bus.h"
+#include "include/sensor_registry.h"
+#include "include/pressure_trend.h"
+#include "include/number_format.h"
+#include "include/deferred_log.h"
+#include "include/job_scheduler.h"
+
+#if SCHEDULER_LIGHT_SLEEP && CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#define BUTTON_LEVEL_WAKEUP 1  // Button doubles as a light-sleep wake source
+#else
+#define BUTTON_LEVEL_WAKEUP 0
+#endif
 
 #define BOOT_BUTTON_PIN 0  // ESP32 Boot Button (GPIO 0)
 
 // Global OLED display instance and control variables
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+// The library switches the bus clock around its own transfers; keep it at the bus manager's rate
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, I2C_BUS_CLOCK_HZ, I2C_BUS_CLOCK_HZ);
 bool oledOn = true;                 // OLED power state
 unsigned long oledTimer = 0;        // Timer for OLED auto-shutoff
 unsigned long mqttSentDisplayTime = 0;  // Timestamp for MQTT send notification
 volatile bool oledToggleRequested = false;  // Interrupt flag for OLED toggle
+static bool buttonReady = false;            // Button interrupt attached
+#if BUTTON_LEVEL_WAKEUP
+static volatile bool buttonLevelMode = false;   // Level triggers instead of the FALLING edge
+static volatile bool buttonAwaitingPress = true;  // Armed for low (press) rather than high (release)
+#endif
 
 /**
  * Interrupt Service Routine (ISR) for button press
- * Sets flag to toggle OLED state
+ * Sets flag to toggle OLED state. In level mode the trigger alternates
+ * between low and high so a held button fires once per press.
  */
 void IRAM_ATTR handleButtonPress() {
+#if BUTTON_LEVEL_WAKEUP
+    if (buttonLevelMode) {
+        bool pressed = buttonAwaitingPress;
+        gpio_ll_set_intr_type(&GPIO, BOOT_BUTTON_PIN, pressed ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+        buttonAwaitingPress = !pressed;
+        if (!pressed) return;  // Release
+    }
+#endif
     oledToggleRequested = true;
 }
 
@@ -25,22 +57,49 @@ void IRAM_ATTR handleButtonPress() {
  */
 void setupOLED() {
     // Initialize OLED display
-    if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
-        Serial.println("SSD1306 OLED initialization failed!");
+    i2cBegin(I2C_DEVICE_SSD1306);
+    bool found = display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS, true, false);  // Wire is started by setupI2CBus()
+    if (found) {
+        // Configure display settings
+        display.setRotation(2);  // Rotate display 180 degrees
+        display.clearDisplay();
+        display.setTextSize(1);
+        display.setTextColor(SSD1306_WHITE);
+        display.display();
+    }
+    i2cEnd(I2C_DEVICE_SSD1306);
+
+    if (!found) {
+        LOG_WARN("SSD1306 OLED initialization failed!");
         return;
     }
-    
-    // Configure display settings
-    display.setRotation(2);  // Rotate display 180 degrees
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    display.display();
-    Serial.println("OLED Display Initialized.");
+    syncOLEDRenderer(display);  // Panel now holds the blank frame
+    LOG_INFO("OLED Display Initialized.");
 
     // Configure button interrupt
     pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP);
     attachInterrupt(BOOT_BUTTON_PIN, handleButtonPress, FALLING);
+    buttonReady = true;
+}
+
+/**
+ * Lets the button wake the chip from automatic light sleep
+ * GPIO wakeup only works with a level trigger, which replaces the pin's
+ * FALLING edge; the ISR then switches between low and high levels itself.
+ * Call after setupOLED().
+ * @return true if the button is now a wake source
+ */
+bool enableButtonWakeup() {
+#if BUTTON_LEVEL_WAKEUP
+    if (!buttonReady) return false;
+    buttonAwaitingPress = true;
+    buttonLevelMode = true;
+    gpio_wakeup_enable((gpio_num_t)BOOT_BUTTON_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    return true;
+#else
+    return false;
+#endif
 }
 
 /**
@@ -49,17 +108,25 @@ void setupOLED() {
 void turnOnOLED() {
     oledOn = true;
     oledTimer = millis();
-    Serial.println("OLED turned ON.");
+    i2cBegin(I2C_DEVICE_SSD1306);
+    display.ssd1306_command(SSD1306_DISPLAYON);
+    i2cEnd(I2C_DEVICE_SSD1306);
+    LOG_INFO("OLED turned ON.");
 }
 
 /**
  * Turns off the OLED display
+ * The panel RAM is blanked once and the panel put to sleep; no frames are
+ * sent until it is turned on again
  */
 void turnOffOLED() {
     oledOn = false;
     display.clearDisplay();
-    display.display();
-    Serial.println("OLED turned OFF.");
+    perfAddBytes(PERF_UPDATE_OLED, flushOLEDChanges(display));
+    i2cBegin(I2C_DEVICE_SSD1306);
+    display.ssd1306_command(SSD1306_DISPLAYOFF);
+    i2cEnd(I2C_DEVICE_SSD1306);
+    LOG_INFO("OLED turned OFF.");
 }
 
 /**
@@ -82,30 +149,37 @@ void updateOLED() {
         display.setTextSize(1);
         display.setTextColor(SSD1306_WHITE);
 
-        // Convert units for display
-        float temperatureF = (temperature * 9 / 5) + 32;
-        float altitudeFt = altitude * 3.28084;
-
-        // Display temperature
-        display.setCursor(0, 0);
-        display.printf("Temp: %.1f C / %.1f F\n", temperature, temperatureF);
+        // Take one consistent set of readings for the whole frame
+        SensorSnapshot snap;
+        readSensorSnapshot(snap);
 
-        // Display humidity
-        display.setCursor(0, 10);
-        display.printf("Humidity: %.1f%%\n", humidity);
+        char line[32];  // One text row (21 characters fit the panel)
+        int16_t y = 0;
 
-        // Display altitude
-        display.setCursor(0, 20);
-        display.printf("Alt: %.0f m / %.0f ft\n", altitude, altitudeFt);
-
-        // Display pressure
-        display.setCursor(0, 30);
-        display.printf("Pressure: %.0f hPa\n", pressure);
+        // One row per registered sensor with an OLED row
+        for (int i = 0; i < SENSOR_COUNT; i++) {
+            if (!sensorRegistry[i].oled) continue;
+            appendSensorDisplay(line, sizeof(line), 0, i, snap, sensorRegistry[i].localDecimals);
+            display.setCursor(0, y);
+            display.println(line);
+            y += OLED_ROW_HEIGHT;
+        }
 
-        // Display MQTT send notification (for 5 seconds)
+        // Display MQTT send notification (for 5 seconds), otherwise the
+        // tendency arrow and forecast
+        display.setCursor(0, y);
         if (millis() - mqttSentDisplayTime <= 5000) {
-            display.setCursor(0, 40);
             display.println("MQTT Sent!");
+        } else {
+            PressureTrend trend;
+            getPressureTrend(trend);
+            const char *arrow = trend.tendency == TENDENCY_UNKNOWN ? "  "
+                              : trend.tendency < TENDENCY_STEADY ? "\x19 "   // Down arrow (code page 437)
+                              : trend.tendency > TENDENCY_STEADY ? "\x18 "   // Up arrow
+                              : "= ";
+            size_t len = appendText(line, sizeof(line), 0, arrow);
+            appendText(line, sizeof(line), len, zambrettiForecastShort(trend.zambretti));
+            display.println(line);
         }
 
         // Display current timestamp
@@ -116,11 +190,10 @@ void updateOLED() {
         // Auto-shutoff after 5 minutes
         if (millis() - oledTimer >= 5 * 60 * 1000) {
             turnOffOLED();
+            return;
         }
 
-        display.display();
-    } else {
-        display.clearDisplay();
-        display.display();
+        // Send only the pages that changed since the last frame
+        perfAddBytes(PERF_UPDATE_OLED, flushOLEDChanges(display));
     }
 }
@@ -0,0 +1,125 @@
+#include "include/oled_renderer.h"
+#include "include/oled_display.h"
+#include "include/perf_stats.h"
+#include "include/i2c_bus.h"
+
+/*
+ * Dirty-page renderer for the SSD1306.
+ * The panel RAM is organized in 8-row pages of SCREEN_WIDTH column bytes.
+ * A copy of the last frame sent is kept here; each flush compares the
+ * Adafruit framebuffer against it page by page and only transmits the
+ * column ranges that changed, using the controller's page/column address
+ * window. A frame identical to the last one causes no bus traffic.
+ */
+
+#define OLED_PAGES (SCREEN_HEIGHT / 8)
+
+// Bytes per data transaction including the control byte; short enough
+// that a waiting sensor read is delayed by at most ~0.8 ms at 400 kHz
+#define OLED_I2C_CHUNK 32
+
+static uint8_t sentFrame[SCREEN_WIDTH * OLED_PAGES];  // Panel contents as last transmitted
+static OLEDRenderStats renderStats;
+
+/**
+ * Sends a list of commands in one I2C transaction
+ * @return Bytes transmitted including address and control byte
+ */
+static uint32_t sendCommands(const uint8_t *commands, size_t count) {
+    i2cBegin(I2C_DEVICE_SSD1306);
+    Wire.beginTransmission(SCREEN_ADDRESS);
+    Wire.write((uint8_t)0x00);  // Co = 0, D/C = 0: command stream
+    Wire.write(commands, count);
+    Wire.endTransmission();
+    i2cEnd(I2C_DEVICE_SSD1306);
+    return count + 2;
+}
+
+/**
+ * Sends one column range of a page
+ * @param page Page index (8-row band)
+ * @param first First column
+ * @param last Last column (inclusive)
+ * @param data Framebuffer bytes for the range
+ * @return Bytes transmitted
+ */
+static uint32_t sendRange(uint8_t page, uint8_t first, uint8_t last, const uint8_t *data) {
+    const uint8_t window[] = {
+        SSD1306_PAGEADDR, page, page,
+        SSD1306_COLUMNADDR, first, last
+    };
+    uint32_t bytes = sendCommands(window, sizeof(window));
+
+    size_t remaining = last - first + 1;
+    while (remaining > 0) {
+        size_t chunk = min(remaining, (size_t)(OLED_I2C_CHUNK - 1));
+        i2cBegin(I2C_DEVICE_SSD1306);  // Per chunk, so sensor reads can slip in between
+        Wire.beginTransmission(SCREEN_ADDRESS);
+        Wire.write((uint8_t)0x40);  // Co = 0, D/C = 1: data stream
+        Wire.write(data, chunk);
+        Wire.endTransmission();
+        i2cEnd(I2C_DEVICE_SSD1306);
+        bytes += chunk + 2;
+        data += chunk;
+        remaining -= chunk;
+    }
+    return bytes;
+}
+
+/**
+ * Records the current framebuffer as the panel contents
+ * Call after a full display.display() so the next flush only sends changes
+ */
+void syncOLEDRenderer(Adafruit_SSD1306 &display) {
+    memcpy(sentFrame, display.getBuffer(), sizeof(sentFrame));
+}
+
+/**
+ * Transmits the parts of the framebuffer that changed since the last flush
+ * Each page is scanned for changed columns; runs separated by fewer than
+ * OLED_RENDER_MERGE_GAP unchanged columns are sent as one window
+ * @return Bytes transmitted on the I2C bus for this frame
+ */
+uint32_t flushOLEDChanges(Adafruit_SSD1306 &display) {
+    const uint8_t *frame = display.getBuffer();
+    uint32_t bytes = 0;
+    uint32_t start = micros();
+
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        const uint8_t *current = frame + page * SCREEN_WIDTH;
+        uint8_t *sent = sentFrame + page * SCREEN_WIDTH;
+        int runStart = -1;
+        int runEnd = -1;
+
+        for (int col = 0; col <= SCREEN_WIDTH; col++) {
+            bool changed = col < SCREEN_WIDTH && current[col] != sent[col];
+            if (changed) {
+                if (runStart < 0) runStart = col;
+                runEnd = col;
+            } else if (runStart >= 0 && (col == SCREEN_WIDTH || col - runEnd > OLED_RENDER_MERGE_GAP)) {
+                bytes += sendRange(page, runStart, runEnd, current + runStart);
+                memcpy(sent + runStart, current + runStart, runEnd - runStart + 1);
+                runStart = -1;
+            }
+        }
+    }
+
+    if (bytes > 0) {
+        perfRecord(PERF_I2C_SSD1306, micros() - start);  // Bus time of frames that sent anything
+        perfAddBytes(PERF_I2C_SSD1306, bytes);
+    }
+
+    renderStats.frames++;
+    if (bytes == 0) renderStats.unchangedFrames++;
+    renderStats.lastFrameBytes = bytes;
+    renderStats.totalBytes += bytes;
+    return bytes;
+}
+
+/**
+ * Copies the renderer counters
+ * @param out Destination for the counters
+ */
+void getOLEDRenderStats(OLEDRenderStats &out) {
+    out = renderStats;
+}
@@ -0,0 +1,130 @@
+#include "include/perf_stats.h"
+#include "include/deferred_log.h"
+
+#if ENABLE_PERF_STATS
+
+// Per-function counters, updated from several tasks on both cores
+static PerfCounters perfCounters[PERF_SLOT_COUNT];
+static portMUX_TYPE perfMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Display names matching the PerfSlot order
+static const char *const perfSlotNames[PERF_SLOT_COUNT] = {
+    "readBMP390Sensor",
+    "readDHTSensor",
+    "updateOLED",
+    "publishSensorData",
+    "serialOutputTask",
+    "i2cBMP390",
+    "i2cSSD1306",
+    "mqttPublish",
+    "metricsScrape",
+};
+
+/**
+ * Samples the timer and free heap at the start of a profiled call
+ * @return Token to pass to perfEnd()
+ */
+PerfToken perfBegin() {
+    PerfToken token;
+    token.startFreeHeap = ESP.getFreeHeap();
+    token.startMicros = micros();
+    return token;
+}
+
+/**
+ * Records the duration and heap usage of a profiled call
+ * @param slot Function being measured
+ * @param token Sample taken by perfBegin()
+ */
+void perfEnd(PerfSlot slot, const PerfToken &token) {
+    uint32_t elapsed = micros() - token.startMicros;
+    int32_t heapDelta = (int32_t)token.startFreeHeap - (int32_t)ESP.getFreeHeap();
+
+    portENTER_CRITICAL(&perfMux);
+    PerfCounters &c = perfCounters[slot];
+    if (c.calls == 0 || elapsed < c.minMicros) c.minMicros = elapsed;
+    if (elapsed > c.maxMicros) c.maxMicros = elapsed;
+    if (heapDelta > c.maxHeapDelta) c.maxHeapDelta = heapDelta;
+    c.totalMicros += elapsed;
+    c.histogram.counts[histogramBucket(elapsed)]++;
+    c.calls++;
+    portEXIT_CRITICAL(&perfMux);
+}
+
+/**
+ * Records a duration measured by the caller
+ * Cheaper than perfBegin()/perfEnd() for bus transactions: no heap sample
+ * @param slot Operation being measured
+ * @param micros Duration (µs)
+ */
+void perfRecord(PerfSlot slot, uint32_t micros) {
+    portENTER_CRITICAL(&perfMux);
+    PerfCounters &c = perfCounters[slot];
+    if (c.calls == 0 || micros < c.minMicros) c.minMicros = micros;
+    if (micros > c.maxMicros) c.maxMicros = micros;
+    c.totalMicros += micros;
+    c.histogram.counts[histogramBucket(micros)]++;
+    c.calls++;
+    portEXIT_CRITICAL(&perfMux);
+}
+
+/**
+ * Adds bytes written to the I2C bus or MQTT broker by a profiled call
+ * @param slot Function that wrote the bytes
+ * @param bytes Number of bytes written
+ */
+void perfAddBytes(PerfSlot slot, uint32_t bytes) {
+    portENTER_CRITICAL(&perfMux);
+    perfCounters[slot].bytesOut += bytes;
+    portEXIT_CRITICAL(&perfMux);
+}
+
+/**
+ * Copies the counters of one slot
+ * @param slot Function to read
+ * @param out Destination for the counters
+ */
+void getPerfCounters(PerfSlot slot, PerfCounters &out) {
+    portENTER_CRITICAL(&perfMux);
+    out = perfCounters[slot];
+    portEXIT_CRITICAL(&perfMux);
+}
+
+/**
+ * Prints per-call time, heap delta and bytes written for each profiled function
+ */
+void printPerfStats() {
+    reportPrintln("⏱️ Perf: function           calls   avg us   min us   max us  heap B  bytes/call");
+    for (int i = 0; i < PERF_SLOT_COUNT; i++) {
+        PerfCounters c;
+        getPerfCounters((PerfSlot)i, c);
+        if (c.calls == 0) {
+            reportPrintf("   %-22s %6u        -        -        -       -           -\n", perfSlotNames[i], 0u);
+            continue;
+        }
+        reportPrintf("   %-22s %6u %8u %8u %8u %7d %11u\n",
+                     perfSlotNames[i], (unsigned)c.calls, (unsigned)(c.totalMicros / c.calls),
+                     (unsigned)c.minMicros, (unsigned)c.maxMicros, (int)c.maxHeapDelta,
+                     (unsigned)(c.bytesOut / c.calls));
+    }
+}
+
+/**
+ * Returns the display name of a slot
+ * @param slot Slot to name
+ * @return Name used in reports and diagnostics topics
+ */
+const char *perfSlotName(PerfSlot slot) {
+    return perfSlotNames[slot];
+}
+
+/**
+ * Clears all profiling counters
+ */
+void resetPerfStats() {
+    portENTER_CRITICAL(&perfMux);
+    memset(perfCounters, 0, sizeof(perfCounters));
+    portEXIT_CRITICAL(&perfMux);
+}
+
+#endif // ENABLE_PERF_STATS
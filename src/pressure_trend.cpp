@@ -0,0 +1,360 @@
+#include "include/pressure_trend.h"
+#include "include/sensor_trace.h"
+#include "include/duty_cycle.h"
+#include "include/mqtt_client.h"
+#include "include/number_format.h"
+#include "include/perf_stats.h"
+#include <time.h>
+
+/*
+ * Running least-squares fit over a sliding window of one-minute points.
+ * With the points at x = 0 .. n-1, sum(x) and sum(x²) follow from n, so
+ * a window only keeps sum(y) and sum(x·y). Sliding the window by one point
+ * removes the oldest y and lowers every remaining x by one, which lowers
+ * sum(x·y) by the remaining sum(y); the new point then adds (n-1)·y.
+ * Points are integers (0.01 hPa), so the sums are exact and never drift.
+ * Both windows share one ring of TREND_LONG_POINTS points; the state is
+ * kept in RTC memory so the trend survives duty-cycle deep sleep.
+ *
+ * The 3 h change is only reported once its window is nearly full: a slope
+ * fitted to the first minutes and scaled to 3 hours would turn a short
+ * wobble into a tendency class and a forecast.
+ */
+struct TrendWindow {
+    uint16_t capacity;    // Points in a full window
+    uint16_t count;       // Points in the window
+    int32_t sumY;         // Sum of points (0.01 hPa)
+    int64_t sumXY;        // Sum of x·point
+};
+
+RTC_DATA_ATTR static int16_t trendPoints[TREND_LONG_POINTS];  // Ring of points, 0.01 hPa around TREND_BASE_HPA
+RTC_DATA_ATTR static uint16_t newestPoint = TREND_LONG_POINTS - 1;
+RTC_DATA_ATTR static TrendWindow shortWindow = {TREND_SHORT_POINTS, 0, 0, 0};
+RTC_DATA_ATTR static TrendWindow longWindow = {TREND_LONG_POINTS, 0, 0, 0};
+
+// Minute being averaged into the next point
+RTC_DATA_ATTR static bool bucketOpen = false;
+RTC_DATA_ATTR static uint32_t bucketStartS = 0;
+RTC_DATA_ATTR static float bucketSum = 0;
+RTC_DATA_ATTR static uint16_t bucketCount = 0;
+
+// Results, written by the sensor task and read by the network and OLED jobs
+static PressureTrend trendResults = {NAN, NAN, NAN, TENDENCY_UNKNOWN, 0, 0};
+static portMUX_TYPE trendMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Zambretti forecasts: full text for MQTT, short text for the OLED
+struct ZambrettiText {
+    const char *text;
+    const char *shortText;  // At most 19 characters
+};
+
+static const ZambrettiText zambrettiTexts[32] = {
+    // Falling (1-9)
+    {"Settled fine", "Settled fine"},
+    {"Fine weather", "Fine weather"},
+    {"Fine, becoming less settled", "Fine, less settled"},
+    {"Fairly fine, showery later", "Fair, showers later"},
+    {"Showery, becoming more unsettled", "Showery, unsettled"},
+    {"Unsettled, rain later", "Rain later"},
+    {"Rain at times, worse later", "Rain, worse later"},
+    {"Rain at times, becoming very unsettled", "Rain, unsettled"},
+    {"Very unsettled, rain", "Very unsettled"},
+    // Steady (10-19)
+    {"Settled fine", "Settled fine"},
+    {"Fine weather", "Fine weather"},
+    {"Fine, possibly showers", "Fine, maybe showers"},
+    {"Fairly fine, showers likely", "Showers likely"},
+    {"Showery, bright intervals", "Showery, bright"},
+    {"Changeable, some rain", "Changeable, rain"},
+    {"Unsettled, rain at times", "Unsettled, rain"},
+    {"Rain at frequent intervals", "Frequent rain"},
+    {"Very unsettled, rain", "Very unsettled"},
+    {"Stormy, much rain", "Stormy, much rain"},
+    // Rising (20-32)
+    {"Settled fine", "Settled fine"},
+    {"Fine weather", "Fine weather"},
+    {"Becoming fine", "Becoming fine"},
+    {"Fairly fine, improving", "Fair, improving"},
+    {"Fairly fine, possibly showers early", "Fair, early showers"},
+    {"Showery early, improving", "Showery, improving"},
+    {"Changeable, mending", "Changeable, mending"},
+    {"Rather unsettled, clearing later", "Unsettled, clearing"},
+    {"Unsettled, probably improving", "Improving later"},
+    {"Unsettled, short fine intervals", "Short fine spells"},
+    {"Very unsettled, finer at times", "Very unsettled"},
+    {"Stormy, possibly improving", "Stormy, improving"},
+    {"Stormy, much rain", "Stormy, much rain"}
+};
+
+static const char *const tendencyNames[] = {
+    "Unknown",
+    "Falling very rapidly", "Falling quickly", "Falling", "Falling slowly",
+    "Steady",
+    "Rising slowly", "Rising", "Rising quickly", "Rising very rapidly"
+};
+
+/**
+ * Returns the trend clock in seconds
+ * The system time keeps running through deep sleep; otherwise millis()
+ * (or the trace time during replay)
+ */
+static uint32_t trendClockS() {
+#if DUTY_CYCLE_MODE
+    return (uint32_t)time(NULL);
+#else
+    return traceClockMs() / 1000;
+#endif
+}
+
+/**
+ * Slides a window by one point
+ * @param w Window
+ * @param y New point
+ * @param evicted Point that leaves the window once it is full
+ */
+static void windowAdd(TrendWindow &w, int16_t y, int16_t evicted) {
+    if (w.count == w.capacity) {
+        w.sumY -= evicted;
+        w.sumXY -= w.sumY;  // Remaining points move one step towards x = 0
+        w.count--;
+    }
+    w.sumXY += (int64_t)w.count * y;
+    w.sumY += y;
+    w.count++;
+}
+
+/**
+ * Returns the least-squares slope of a window
+ * @param w Window
+ * @param minPoints Points the window needs before it reports a slope
+ * @return Slope in 0.01 hPa per point, or NAN with too few points
+ */
+static float windowSlope(const TrendWindow &w, uint16_t minPoints) {
+    if (w.count < minPoints) return NAN;
+    int64_t n = w.count;
+    int64_t numerator = n * w.sumXY - (n * (n - 1) / 2) * w.sumY;
+    int64_t denominator = n * n * (n * n - 1) / 12;
+    return (float)numerator / (float)denominator;
+}
+
+/**
+ * Stores one point in the ring and slides both windows
+ * @param value Point value (hPa)
+ */
+static void addTrendPoint(float value) {
+    int y = constrain((int)lroundf((value - TREND_BASE_HPA) * 100.0f), INT16_MIN, INT16_MAX);
+
+    uint16_t slot = (newestPoint + 1) % TREND_LONG_POINTS;
+    windowAdd(shortWindow, y, trendPoints[(slot + TREND_LONG_POINTS - TREND_SHORT_POINTS) % TREND_LONG_POINTS]);
+    windowAdd(longWindow, y, trendPoints[slot]);
+    trendPoints[slot] = y;
+    newestPoint = slot;
+}
+
+/**
+ * Classifies a 3 h pressure change into a WMO tendency
+ * @param change3h Change over 3 hours (hPa)
+ * @return PressureTendency
+ */
+static uint8_t classifyTendency(float change3h) {
+    if (isnan(change3h)) return TENDENCY_UNKNOWN;
+    float size = fabsf(change3h);
+    if (size < 0.1f) return TENDENCY_STEADY;
+    uint8_t steps = size < 1.6f ? 1 : size < 3.6f ? 2 : size <= 6.0f ? 3 : 4;
+    return change3h < 0 ? TENDENCY_STEADY - steps : TENDENCY_STEADY + steps;
+}
+
+/**
+ * Computes the Zambretti forecast number
+ * Uses the sea-level pressure and the 3 h trend only (no wind direction
+ * or season adjustment)
+ *
+ * @param pressure Sea-level pressure (hPa)
+ * @param change3h Change over 3 hours (hPa)
+ * @return Forecast number 1-32, or 0 if unknown
+ */
+static uint8_t zambrettiNumber(float pressure, float change3h) {
+    if (isnan(pressure) || isnan(change3h)) return 0;
+    if (change3h <= -ZAMBRETTI_TREND_HPA) {
+        return constrain((int)lroundf(127.0f - 0.12f * pressure), 1, 9);
+    }
+    if (change3h >= ZAMBRETTI_TREND_HPA) {
+        return constrain((int)lroundf(185.0f - 0.16f * pressure), 20, 32);
+    }
+    return constrain((int)lroundf(144.0f - 0.13f * pressure), 10, 19);
+}
+
+/**
+ * Recomputes the results from the window sums
+ */
+static void updateTrendResults() {
+    PressureTrend t;
+    t.seaLevelPressure = trendPoints[newestPoint] / 100.0f + TREND_BASE_HPA;
+    t.rate1h = windowSlope(shortWindow, TREND_SHORT_MIN_POINTS) * (3600.0f / TREND_POINT_INTERVAL_S) / 100.0f;
+    t.change3h = windowSlope(longWindow, TREND_LONG_MIN_POINTS) * (TREND_LONG_POINTS * 60.0f / TREND_POINT_INTERVAL_S) / 100.0f;
+    t.tendency = classifyTendency(t.change3h);
+    t.zambretti = zambrettiNumber(t.seaLevelPressure, t.change3h);
+    t.points = longWindow.count;
+
+    taskENTER_CRITICAL(&trendMux);
+    trendResults = t;
+    taskEXIT_CRITICAL(&trendMux);
+}
+
+/**
+ * Forgets all points, as after a power-on
+ */
+void resetPressureTrend() {
+    shortWindow.count = 0;
+    shortWindow.sumY = 0;
+    shortWindow.sumXY = 0;
+    longWindow.count = 0;
+    longWindow.sumY = 0;
+    longWindow.sumXY = 0;
+    bucketOpen = false;
+
+    taskENTER_CRITICAL(&trendMux);
+    trendResults = {NAN, NAN, NAN, TENDENCY_UNKNOWN, 0, 0};
+    taskEXIT_CRITICAL(&trendMux);
+}
+
+/**
+ * Feeds a smoothed pressure reading
+ * Readings are averaged into one point per TREND_POINT_INTERVAL_S; each
+ * point updates both windows in constant time. Minutes without readings
+ * (sensor errors, deep sleep) are filled by interpolation, and a gap
+ * longer than the 3 h window or a clock step backwards starts over.
+ *
+ * @param seaLevelPressure Smoothed pressure reduced to sea level (hPa)
+ */
+void pressureTrendAddSample(float seaLevelPressure) {
+    if (isnan(seaLevelPressure)) return;
+    uint32_t now = trendClockS();
+
+    if (bucketOpen) {
+        int32_t elapsed = (int32_t)(now - bucketStartS);
+        if (elapsed < 0) {
+            resetPressureTrend();
+        } else if (elapsed < TREND_POINT_INTERVAL_S) {
+            bucketSum += seaLevelPressure;
+            bucketCount++;
+            return;
+        } else {
+            uint32_t intervals = elapsed / TREND_POINT_INTERVAL_S;
+            float mean = bucketSum / bucketCount;
+            if (intervals > TREND_LONG_POINTS) {
+                resetPressureTrend();
+            } else {
+                addTrendPoint(mean);
+                for (uint32_t i = 1; i < intervals; i++) {
+                    addTrendPoint(mean + (seaLevelPressure - mean) * i / intervals);
+                }
+                updateTrendResults();
+                bucketStartS += intervals * TREND_POINT_INTERVAL_S;
+            }
+        }
+    }
+
+    if (!bucketOpen) {
+        bucketOpen = true;
+        bucketStartS = now;
+    }
+    bucketSum = seaLevelPressure;
+    bucketCount = 1;
+}
+
+/**
+ * Copies the latest trend results
+ * @param out Destination for the results
+ * @return false until the 1 h window has TREND_SHORT_MIN_POINTS points;
+ *         change3h, tendency and zambretti stay unknown until the 3 h
+ *         window has TREND_LONG_MIN_POINTS
+ */
+bool getPressureTrend(PressureTrend &out) {
+    taskENTER_CRITICAL(&trendMux);
+    out = trendResults;
+    taskEXIT_CRITICAL(&trendMux);
+    return !isnan(out.rate1h);
+}
+
+/**
+ * Returns the name of a tendency class
+ * @param tendency PressureTendency
+ */
+const char *pressureTendencyName(uint8_t tendency) {
+    return tendency <= TENDENCY_RISING_VERY_RAPIDLY ? tendencyNames[tendency] : tendencyNames[0];
+}
+
+/**
+ * Returns the forecast text for MQTT
+ * @param zambretti Forecast number 1-32
+ */
+const char *zambrettiForecast(uint8_t zambretti) {
+    return zambretti >= 1 && zambretti <= 32 ? zambrettiTexts[zambretti - 1].text : "Unknown";
+}
+
+/**
+ * Returns the forecast text for an OLED row
+ * @param zambretti Forecast number 1-32
+ */
+const char *zambrettiForecastShort(uint8_t zambretti) {
+    return zambretti >= 1 && zambretti <= 32 ? zambrettiTexts[zambretti - 1].shortText : "No forecast yet";
+}
+
+// Discovery document for one trend sensor; all share the forecast state topic
+#define TREND_DISCOVERY_JSON(key, name, unitJson, icon)                 \
+    "{\"name\":\"" name "\","                                           \
+    "\"state_topic\":\"" FORECAST_STATE_TOPIC "\","                     \
+    "\"unique_id\":\"bmp390_" key "\","                                 \
+    unitJson                                                            \
+    "\"icon\":\"" icon "\","                                            \
+    "\"value_template\":\"{{ value_json." key " }}\"}"
+
+static const char *const trendDiscovery[][2] = {
+    {SENSOR_DISCOVERY_TOPIC("pressure_rate_1h"),
+     TREND_DISCOVERY_JSON("pressure_rate_1h", "BMP390 Pressure Rate 1h",
+                          "\"unit_of_measurement\":\"hPa/h\",", "mdi:chart-line")},
+    {SENSOR_DISCOVERY_TOPIC("pressure_change_3h"),
+     TREND_DISCOVERY_JSON("pressure_change_3h", "BMP390 Pressure Change 3h",
+                          "\"unit_of_measurement\":\"hPa\",", "mdi:chart-line")},
+    {SENSOR_DISCOVERY_TOPIC("pressure_tendency"),
+     TREND_DISCOVERY_JSON("pressure_tendency", "BMP390 Pressure Tendency", "", "mdi:trending-up")},
+    {SENSOR_DISCOVERY_TOPIC("forecast"),
+     TREND_DISCOVERY_JSON("forecast", "BMP390 Forecast", "", "mdi:weather-partly-cloudy")}
+};
+
+/**
+ * Queues the discovery documents of the trend and forecast sensors
+ * @return bool Returns true if all documents were queued
+ */
+bool publishPressureTrendDiscovery() {
+    bool success = true;
+    for (size_t i = 0; i < sizeof(trendDiscovery) / sizeof(trendDiscovery[0]); i++) {
+        success &= mqttEnqueue(trendDiscovery[i][0], trendDiscovery[i][1], true, false);
+    }
+    return success;
+}
+
+/**
+ * Queues the trend and forecast state document
+ * Nothing is sent until the 1 h rate is known; the 3 h change is null and
+ * the tendency and forecast "Unknown" until the 3 h window is nearly full
+ *
+ * @return bool Returns false if the document could not be queued
+ */
+bool publishPressureTrend() {
+    PressureTrend t;
+    if (!getPressureTrend(t)) return true;
+
+    char payload[192];
+    size_t len = appendText(payload, sizeof(payload), 0, "{");
+    len = appendJsonField(payload, sizeof(payload), len, "pressure_rate_1h", t.rate1h, 2);
+    len = appendJsonField(payload, sizeof(payload), len, "pressure_change_3h", t.change3h, 1);
+    len = appendJsonString(payload, sizeof(payload), len, "pressure_tendency", pressureTendencyName(t.tendency));
+    len = appendJsonString(payload, sizeof(payload), len, "forecast", zambrettiForecast(t.zambretti));
+    len = appendJsonUInt(payload, sizeof(payload), len, "zambretti", t.zambretti);
+    appendText(payload, sizeof(payload), len, "}");
+
+    perfAddBytes(PERF_PUBLISH_SENSOR_DATA, strlen(FORECAST_STATE_TOPIC) + strlen(payload));
+    return mqttEnqueue(FORECAST_STATE_TOPIC, payload, true, true);
+}
@@ -0,0 +1,146 @@
+#include "include/sensor_math.h"
+#include "include/deferred_log.h"
+
+/*
+ * Barometric altitude h = 44330 * (1 - (p / p0)^0.1903) is tabulated once
+ * at boot every 4 hPa and linearly interpolated per sample. The curve is
+ * smooth, so the interpolation error is at most 0.12 m at 300 hPa and
+ * below 0.02 m above 800 hPa, well under the BMP390 noise floor.
+ */
+static float altitudeTable[ALTITUDE_TABLE_SIZE];
+static float seaLevelFactor = 1.0f;
+
+/**
+ * Builds the altitude table and the sea-level reduction factor
+ * Must run before the first sensor reading
+ */
+void setupSensorMath() {
+    for (int i = 0; i < ALTITUDE_TABLE_SIZE; i++) {
+        float p = ALTITUDE_TABLE_MIN_HPA + i * ALTITUDE_TABLE_STEP_HPA;
+        altitudeTable[i] = 44330.0f * (1.0f - powf(p / SEA_LEVEL_PRESSURE_HPA, 0.1903f));
+    }
+    seaLevelFactor = powf(1.0f - STATION_ELEVATION_M / 44330.0f, -5.255f);
+}
+
+/**
+ * Converts pressure to barometric altitude by table interpolation
+ * Pressures outside the table extrapolate from its first or last interval
+ * @param pressureHPa Pressure (hPa)
+ * @return Altitude (meters), NAN without pressure
+ */
+float pressureToAltitude(float pressureHPa) {
+    if (isnan(pressureHPa)) return NAN;
+    float x = (pressureHPa - ALTITUDE_TABLE_MIN_HPA) * (1.0f / ALTITUDE_TABLE_STEP_HPA);
+    int i;
+    if (x < 0) {
+        i = 0;
+    } else if (x >= ALTITUDE_TABLE_SIZE - 2) {
+        i = ALTITUDE_TABLE_SIZE - 2;  // Clamped before the conversion, which overflows for huge values
+    } else {
+        i = (int)x;
+    }
+    float t = x - i;
+    return altitudeTable[i] + t * (altitudeTable[i + 1] - altitudeTable[i]);
+}
+
+/**
+ * Converts a batch of pressures to altitudes (FIFO drains, replayed data)
+ * @param pressureHPa Input pressures (hPa)
+ * @param altitude Output altitudes (meters), may alias the input
+ * @param count Number of samples
+ */
+void pressureToAltitudeBatch(const float *pressureHPa, float *altitude, size_t count) {
+    for (size_t n = 0; n < count; n++) {
+        altitude[n] = pressureToAltitude(pressureHPa[n]);
+    }
+}
+
+/**
+ * Reduces station pressure to sea level for STATION_ELEVATION_M
+ * @param pressureHPa Station pressure (hPa)
+ * @return Sea-level pressure (hPa)
+ */
+float seaLevelPressure(float pressureHPa) {
+    return pressureHPa * seaLevelFactor;
+}
+
+/**
+ * Dew point using the Magnus formula
+ * @param temperature Air temperature (°C)
+ * @param humidity Relative humidity (%)
+ * @return Dew point (°C), NAN without humidity
+ */
+float dewPoint(float temperature, float humidity) {
+    if (humidity <= 0) return NAN;
+    float gamma = logf(humidity / 100.0f) + (17.62f * temperature) / (243.12f + temperature);
+    return 243.12f * gamma / (17.62f - gamma);
+}
+
+/**
+ * Heat index using the NOAA Rothfusz regression with its adjustments
+ * @param temperature Air temperature (°C)
+ * @param humidity Relative humidity (%)
+ * @return Apparent temperature (°C)
+ */
+float heatIndex(float temperature, float humidity) {
+    float t = celsiusToFahrenheit(temperature);
+    float rh = humidity;
+    float hi = 0.5f * (t + 61.0f + (t - 68.0f) * 1.2f + rh * 0.094f);
+
+    if ((hi + t) / 2.0f >= 80.0f) {
+        hi = -42.379f + 2.04901523f * t + 10.14333127f * rh
+             - 0.22475541f * t * rh - 0.00683783f * t * t
+             - 0.05481717f * rh * rh + 0.00122874f * t * t * rh
+             + 0.00085282f * t * rh * rh - 0.00000199f * t * t * rh * rh;
+        if (rh < 13.0f && t >= 80.0f && t <= 112.0f) {
+            hi -= ((13.0f - rh) / 4.0f) * sqrtf((17.0f - fabsf(t - 95.0f)) / 17.0f);
+        } else if (rh > 85.0f && t >= 80.0f && t <= 87.0f) {
+            hi += ((rh - 85.0f) / 10.0f) * ((87.0f - t) / 5.0f);
+        }
+    }
+    return (hi - 32.0f) / 1.8f;
+}
+
+/**
+ * Absolute humidity from temperature and relative humidity
+ * @param temperature Air temperature (°C)
+ * @param humidity Relative humidity (%)
+ * @return Water vapour density (g/m³)
+ */
+float absoluteHumidity(float temperature, float humidity) {
+    float saturation = 6.112f * expf((17.67f * temperature) / (temperature + 243.5f));  // hPa
+    return saturation * humidity * 2.1674f / (273.15f + temperature);
+}
+
+#if ENABLE_PERF_STATS
+/**
+ * Times the altitude kernel against the direct pow() formula over a batch
+ * spanning the table and prints per-sample cost and the worst error
+ */
+void benchmarkSensorMath() {
+    const size_t count = 256;
+    static float pressures[count];
+    static float altitudes[count];
+    for (size_t n = 0; n < count; n++) {
+        pressures[n] = 300.0f + n * (800.0f / count);
+    }
+
+    unsigned long start = micros();
+    pressureToAltitudeBatch(pressures, altitudes, count);
+    unsigned long tableMicros = micros() - start;
+
+    float maxError = 0;
+    start = micros();
+    for (size_t n = 0; n < count; n++) {
+        float exact = 44330.0f * (1.0f - powf(pressures[n] / SEA_LEVEL_PRESSURE_HPA, 0.1903f));
+        float error = fabsf(exact - altitudes[n]);
+        if (error > maxError) maxError = error;
+    }
+    unsigned long powMicros = micros() - start;
+
+    reportPrintf("🧮 Altitude kernel: %.3f us/sample (pow: %.3f us/sample), max error %.3f m over %u samples\n",
+                 tableMicros / (float)count, powMicros / (float)count, maxError, (unsigned)count);
+}
+#else
+void benchmarkSensorMath() {}
+#endif // ENABLE_PERF_STATS
@@ -0,0 +1,98 @@
+#include "include/sensor_registry.h"
+#include "include/number_format.h"
+
+// Discovery document for one registry line, assembled by the preprocessor
+#define SENSOR_DISCOVERY_JSON(key, name, unit, classJson)               \
+    "{\"name\":\"" name "\","                                           \
+    "\"state_topic\":\"" SENSOR_STATE_TOPIC(#key) "\","                 \
+    "\"unique_id\":\"bmp390_" #key "\","                                \
+    "\"unit_of_measurement\":\"" unit "\","                             \
+    classJson ","                                                       \
+    "\"value_template\":\"{{ value_json." #key " }}\"}"
+
+#define SENSOR_DESCRIPTOR(key, name, unit, classJson, field, decimals, deadband,  \
+                          label, local, localUnit, localDecimals, serialDecimals, \
+                          oled)                                                   \
+    { #key, SENSOR_STATE_TOPIC(#key), SENSOR_DISCOVERY_TOPIC(#key),              \
+      SENSOR_DISCOVERY_JSON(key, name, unit, classJson),                          \
+      &SensorSnapshot::field, decimals, deadband, label,                          \
+      &SensorSnapshot::local, localUnit, localDecimals, serialDecimals, unit,    \
+      oled },
+
+const SensorDescriptor sensorRegistry[SENSOR_COUNT] = {
+    SENSOR_REGISTRY(SENSOR_DESCRIPTOR)
+};
+
+/**
+ * Appends every registered sensor as a JSON number field
+ * @param buf Destination buffer holding an open JSON object
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param snap Readings to serialize
+ * @return New position
+ */
+size_t appendSensorJson(char *buf, size_t size, size_t pos, const SensorSnapshot &snap) {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const SensorDescriptor &d = sensorRegistry[i];
+        pos = appendJsonField(buf, size, pos, d.key, snap.*d.field, d.decimals);
+    }
+    return pos;
+}
+
+/**
+ * Appends a value and its unit; "%" follows the number directly
+ */
+static size_t appendValueUnit(char *buf, size_t size, size_t pos, float value,
+                              uint8_t decimals, const char *unit) {
+    pos = appendFixed(buf, size, pos, value, decimals);
+    if (unit[0] != '%') {
+        pos = appendText(buf, size, pos, " ");
+    }
+    return appendText(buf, size, pos, unit);
+}
+
+/**
+ * Appends one sensor as display text, e.g. "Temp: 23.4 C / 74.1 F"
+ * The published value follows the local one when they differ; the OLED
+ * font has no degree sign, so it is left out of the unit
+ *
+ * @param buf Destination buffer
+ * @param size Size of the buffer
+ * @param pos Position to write at
+ * @param sensor Registry index
+ * @param snap Readings to show
+ * @param decimals Precision of both values (localDecimals or serialDecimals)
+ * @return New position
+ */
+size_t appendSensorDisplay(char *buf, size_t size, size_t pos, int sensor, const SensorSnapshot &snap,
+                           uint8_t decimals) {
+    const SensorDescriptor &d = sensorRegistry[sensor];
+    pos = appendText(buf, size, pos, d.label);
+    pos = appendText(buf, size, pos, ": ");
+    pos = appendValueUnit(buf, size, pos, snap.*d.local, decimals, d.localUnit);
+    if (d.field != d.local) {
+        const char *unit = d.unit;
+        if (strncmp(unit, "°", strlen("°")) == 0) {
+            unit += strlen("°");
+        }
+        pos = appendText(buf, size, pos, " / ");
+        pos = appendValueUnit(buf, size, pos, snap.*d.field, decimals, unit);
+    }
+    return pos;
+}
+
+/**
+ * Checks whether any registered metric moved outside its deadband
+ * @param current Latest readings
+ * @param published Last published readings
+ * @return true if at least one change reaches its deadband
+ */
+bool sensorsOutsideDeadband(const SensorSnapshot &current, const SensorSnapshot &published) {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const SensorDescriptor &d = sensorRegistry[i];
+        if (fabsf(current.*d.field - published.*d.field) >= d.deadband) {
+            return true;
+        }
+    }
+    return false;
+}
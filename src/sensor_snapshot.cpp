@@ -0,0 +1,152 @@
+#include "include/sensor_snapshot.h"
+#include "include/sensor_math.h"
+#include "include/boot_trace.h"
+#include "include/sensor_trace.h"
+#include <atomic>
+
+/*
+ * Seqlock-protected sensor record.
+ * The sequence counter is odd while an update is in progress. Readers copy
+ * the record and retry if the counter was odd or changed during the copy, so
+ * they never block and never see a new pressure paired with an old altitude.
+ * bmpTask and dhtTask both write. A writer copies the record, applies its
+ * readings and computes the derived quantities outside any lock, then
+ * publishes the copy in a short critical section that only holds a
+ * memcpy; if the other writer published in between, it starts over from
+ * the new record. Every reader gets the derived quantities for free and
+ * they always match the raw values in the same record.
+ */
+static SensorSnapshot snapshotData __attribute__((aligned(32))) = {  // 48-byte record, 32-byte aligned
+    NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, 0, 0             // NAN until each sensor has reported
+};
+static std::atomic<uint32_t> snapshotSeq(0);                       // Seqlock counter (odd = write in progress)
+static portMUX_TYPE snapshotWriterMux = portMUX_INITIALIZER_UNLOCKED;
+static SnapshotListener snapshotListener = NULL;                   // Called after each update
+
+/**
+ * Copies the record without taking a lock
+ * @param out Destination for the readings
+ * @return Sequence counter the copy belongs to (even)
+ */
+static uint32_t copySnapshot(SensorSnapshot &out) {
+    uint32_t before, after;
+    do {
+        before = snapshotSeq.load(std::memory_order_acquire);
+        memcpy(&out, &snapshotData, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = snapshotSeq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return before;
+}
+
+/**
+ * Recomputes the derived quantities from the raw values in a record
+ * Also used for readings rebuilt from the store-and-forward queue
+ * @param s Record whose temperature, pressure, altitude and humidity are set
+ */
+void deriveSensorReadings(SensorSnapshot &s) {
+    s.temperatureF = celsiusToFahrenheit(s.temperature);
+    s.altitudeFt = metersToFeet(s.altitude);
+    s.seaLevelPressure = seaLevelPressure(s.pressure);
+    s.dewPoint = dewPoint(s.temperature, s.humidity);
+    s.heatIndex = heatIndex(s.temperature, s.humidity);
+    s.absoluteHumidity = absoluteHumidity(s.temperature, s.humidity);
+}
+
+/**
+ * Publishes an updated copy of the record
+ * Derived values and the timestamp are computed before the critical
+ * section, which only copies the finished record
+ *
+ * @param next Copy taken by copySnapshot() with the new readings applied
+ * @param seen Sequence counter returned by copySnapshot()
+ * @return false if another writer published first; start over
+ */
+static bool commitSnapshot(SensorSnapshot &next, uint32_t seen) {
+    deriveSensorReadings(next);
+    next.timestampMs = traceClockMs();
+    next.sequence = (seen + 2) / 2;
+
+    taskENTER_CRITICAL(&snapshotWriterMux);
+    if (snapshotSeq.load(std::memory_order_relaxed) != seen) {
+        taskEXIT_CRITICAL(&snapshotWriterMux);
+        return false;
+    }
+    snapshotSeq.store(seen + 1, std::memory_order_relaxed);  // Odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&snapshotData, &next, sizeof(snapshotData));
+    snapshotSeq.store(seen + 2, std::memory_order_release);
+    SnapshotListener listener = snapshotListener;
+    taskEXIT_CRITICAL(&snapshotWriterMux);
+
+    bootTraceMark(BOOT_FIRST_READING);
+    if (listener != NULL) {
+        listener();
+    }
+    return true;
+}
+
+/**
+ * Publishes a new BMP390 reading
+ * @param temperature Temperature (°C)
+ * @param pressure Smoothed pressure (hPa)
+ * @param altitude Smoothed altitude (meters)
+ */
+void updateBMPSnapshot(float temperature, float pressure, float altitude) {
+    SensorSnapshot next;
+    uint32_t seen;
+    do {
+        seen = copySnapshot(next);
+        next.temperature = temperature;
+        next.pressure = pressure;
+        next.altitude = altitude;
+    } while (!commitSnapshot(next, seen));
+}
+
+/**
+ * Publishes a new DHT humidity reading
+ * @param humidity Relative humidity (%)
+ */
+void updateHumiditySnapshot(float humidity) {
+    SensorSnapshot next;
+    uint32_t seen;
+    do {
+        seen = copySnapshot(next);
+        next.humidity = humidity;
+    } while (!commitSnapshot(next, seen));
+}
+
+/**
+ * Sets every reading back to NAN, as before the first sensor reported
+ * Used by trace replay when the traced station rebooted
+ */
+void clearSensorSnapshot() {
+    SensorSnapshot next;
+    uint32_t seen;
+    do {
+        seen = copySnapshot(next);
+        next.temperature = NAN;
+        next.pressure = NAN;
+        next.altitude = NAN;
+        next.humidity = NAN;
+    } while (!commitSnapshot(next, seen));
+}
+
+/**
+ * Copies a consistent set of readings without taking a lock
+ * @param out Destination for the readings
+ */
+void readSensorSnapshot(SensorSnapshot &out) {
+    copySnapshot(out);
+}
+
+/**
+ * Registers the function to call after every snapshot update
+ * Runs on the writing task outside the lock, so it must be short
+ * @param listener Callback, or NULL to stop notifications
+ */
+void setSnapshotListener(SnapshotListener listener) {
+    taskENTER_CRITICAL(&snapshotWriterMux);
+    snapshotListener = listener;
+    taskEXIT_CRITICAL(&snapshotWriterMux);
+}
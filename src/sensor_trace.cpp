@@ -0,0 +1,308 @@
+#include "include/sensor_trace.h"
+#include "include/deferred_log.h"
+#include "include/bmp390_sensor.h"
+#include "include/dht_sensor.h"
+#include "include/mqtt_publisher.h"
+#include "include/sensor_registry.h"
+#include "include/sensor_math.h"
+#include "include/history_store.h"
+#include "include/pressure_trend.h"
+#include "include/number_format.h"
+#include <LittleFS.h>
+
+/*
+ * A trace is the raw output of the sensors, before offsets and smoothing,
+ * one line per read attempt. Replay feeds the lines through the same
+ * processing as live readings (offsets, smoothing, snapshot, history and
+ * the publish policy) with the clock taken from the trace, so a day of
+ * readings runs in about a second and every run gives the same result.
+ * Lines that do not start with "~T," are ignored, so a whole Serial
+ * Monitor log can be replayed as captured.
+ */
+
+// Virtual clock, used instead of millis() while replaying
+static bool replayActive = false;
+static uint32_t replayClockMs = 0;
+static uint64_t replayClockBase = 0;        // Trace time before the last restart of the station's clock
+static uint32_t replayLastMs = 0;           // Station millis() of the previous line
+
+#if TRACE_RECORD_FLASH
+static File traceFile;
+static char traceBuffer[TRACE_BUFFER_BYTES];
+static size_t traceBuffered = 0;
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+/**
+ * Returns the time used to stamp readings
+ * @return millis(), or the trace time while a replay runs
+ */
+uint32_t traceClockMs() {
+    return replayActive ? replayClockMs : millis();
+}
+
+/**
+ * Opens the trace file for appending when recording to flash
+ * LittleFS must already be mounted (setupStoreForward())
+ */
+void setupTraceRecorder() {
+#if TRACE_RECORD_FLASH
+    traceFile = LittleFS.open(TRACE_FILE, FILE_APPEND);
+    if (!traceFile) {
+        LOG_WARN("⚠️ Trace file could not be opened; trace recording to flash is off.");
+        return;
+    }
+    LOG_INFO("🎞️ Recording sensor trace to %s (%u bytes so far)", TRACE_FILE, (unsigned)traceFile.size());
+#endif
+}
+
+/**
+ * Records one raw reading as a trace line
+ * @param source TRACE_SOURCE_BMP390 or TRACE_SOURCE_DHT11
+ * @param status 0 for a good reading, otherwise the failure code
+ * @param value1 First value (NaN on failure)
+ * @param value2 Second value (0 if unused)
+ */
+void traceRecord(char source, uint8_t status, float value1, float value2) {
+#if TRACE_RECORD_SERIAL || TRACE_RECORD_FLASH
+    char line[64];
+    size_t len = appendText(line, sizeof(line), 0, "~T,");
+    len = appendUInt(line, sizeof(line), len, millis());
+    char fields[] = {',', source, ',', '\0'};
+    len = appendText(line, sizeof(line), len, fields);
+    len = appendUInt(line, sizeof(line), len, status);
+    len = appendText(line, sizeof(line), len, ",");
+    len = appendFixed(line, sizeof(line), len, value1, 4);
+    len = appendText(line, sizeof(line), len, ",");
+    len = appendFixed(line, sizeof(line), len, value2, 4);
+#if TRACE_RECORD_SERIAL
+    reportPrintln(line);  // Written by the log task, not the sampling job
+#endif
+#if TRACE_RECORD_FLASH
+    len = appendText(line, sizeof(line), len, "\n");
+    bool full;
+    taskENTER_CRITICAL(&traceMux);
+    if (traceBuffered + len <= sizeof(traceBuffer)) {
+        memcpy(traceBuffer + traceBuffered, line, len);
+        traceBuffered += len;
+    }
+    full = traceBuffered + sizeof(line) > sizeof(traceBuffer);
+    taskEXIT_CRITICAL(&traceMux);
+    if (full) {
+        traceFlush();
+    }
+#endif
+#endif
+}
+
+/**
+ * Writes buffered trace lines to flash
+ * Recording stops once the file reaches TRACE_FLASH_MAX_BYTES
+ */
+void traceFlush() {
+#if TRACE_RECORD_FLASH
+    char pending[TRACE_BUFFER_BYTES];
+    taskENTER_CRITICAL(&traceMux);
+    size_t count = traceBuffered;
+    memcpy(pending, traceBuffer, count);
+    traceBuffered = 0;
+    taskEXIT_CRITICAL(&traceMux);
+
+    if (count == 0 || !traceFile) return;
+    if (traceFile.size() + count > TRACE_FLASH_MAX_BYTES) {
+        LOG_WARN("⚠️ Trace file full; trace recording to flash stopped.");
+        traceFile.close();
+        return;
+    }
+    traceFile.write((const uint8_t *)pending, count);
+    traceFile.flush();
+#endif
+}
+
+/**
+ * Parses a trace line
+ * Trailing characters (such as "\r") after the last value are ignored
+ * @param line Text line
+ * @param out Receives the fields
+ * @return false if the line is not a trace line
+ */
+bool parseTraceLine(const char *line, TraceLine &out) {
+    if (strncmp(line, "~T,", 3) != 0) return false;
+    char *p = (char *)line + 3;
+    out.ms = strtoul(p, &p, 10);
+    if (*p++ != ',') return false;
+    out.source = *p++;
+    if (*p++ != ',') return false;
+    out.status = (uint8_t)strtoul(p, &p, 10);
+    if (*p++ != ',') return false;
+    out.value1 = strtof(p, &p);
+    if (*p++ != ',') return false;
+    out.value2 = strtof(p, &p);
+    return true;
+}
+
+/**
+ * Puts the pipeline in its state after boot: no readings, the filter and
+ * the pressure trend start over, and the next reading is published at once
+ */
+static void replayBoot() {
+    resetBMP390Smoothing();
+    resetPressureTrend();
+    clearSensorSnapshot();
+    resetPublishPolicy();
+}
+
+/**
+ * Starts a replay: readings are stamped with the trace time from now on
+ * The pipeline starts from its state after boot, so a replay does not
+ * depend on what ran before it
+ *
+ * @param stats Counters to clear
+ */
+void traceReplayBegin(TraceReplayStats &stats) {
+    setupSensorMath();
+    setupHistory();
+    replayClockMs = 0;
+    replayActive = true;
+    replayBoot();
+    memset(&stats, 0, sizeof(stats));
+    replayClockBase = 0;
+    replayLastMs = 0;
+}
+
+/**
+ * Ends a replay; readings are stamped with millis() again
+ */
+void traceReplayEnd() {
+    replayActive = false;
+}
+
+/**
+ * Feeds one trace line through the pipeline and the publish policy
+ * @param line Text line; lines other than trace lines are skipped
+ * @param stats Replay counters
+ * @return false if the line is not a trace line
+ */
+bool traceReplayLine(const char *line, TraceReplayStats &stats) {
+    TraceLine t;
+    if (!parseTraceLine(line, t)) return false;
+
+    // millis() restarts on every boot: continue the virtual clock and
+    // start over from the state after boot, as the station did
+    if (stats.lines > 0 && t.ms < replayLastMs) {
+        replayClockBase += replayLastMs;
+        stats.reboots++;
+        replayBoot();
+    }
+    replayLastMs = t.ms;
+    uint64_t now = replayClockBase + t.ms;
+    replayClockMs = (uint32_t)now;
+    if (stats.lines++ == 0) stats.firstMs = now;
+    stats.lastMs = now;
+
+    if (t.source == TRACE_SOURCE_BMP390) {
+        if (t.status != 0) {
+            stats.bmpFailures++;
+            return true;
+        }
+        stats.bmpReadings++;
+        processBMP390Reading(t.value1, t.value2);
+        SensorSnapshot snap;
+        readSensorSnapshot(snap);
+        float lag = fabsf(snap.pressure - t.value2);
+        if (lag > stats.maxPressureLag) stats.maxPressureLag = lag;
+    } else if (t.source == TRACE_SOURCE_DHT11) {
+        if (t.status != DHT_DECODE_OK) {
+            stats.dhtFailures++;
+            return true;
+        }
+        stats.dhtReadings++;
+        processDHTReading(t.value1);
+    } else {
+        return true;
+    }
+
+    if (sensorDataPublishDue(replayClockMs)) {
+        markSensorDataPublished(replayClockMs);
+        stats.publishes++;
+#if TRACE_REPLAY_PRINT_PUBLISHES
+        SensorSnapshot snap;
+        readSensorSnapshot(snap);
+        char out[192];
+        size_t len = appendText(out, sizeof(out), 0, "~P,");
+        len = appendUInt(out, sizeof(out), len, replayClockMs);
+        len = appendText(out, sizeof(out), len, ",{");
+        len = appendSensorJson(out, sizeof(out), len, snap);
+        appendText(out, sizeof(out), len, "}");
+        while (!reportPrintln(out)) {
+            delay(1);  // Every decision must reach the output; wait for the log task
+        }
+#endif
+    }
+    return true;
+}
+
+/**
+ * Prints the summary of a replay
+ * @param stats Replay counters
+ * @param wallMs Real time the replay took (ms)
+ */
+void printTraceReplaySummary(const TraceReplayStats &stats, unsigned long wallMs) {
+    double spanHours = (stats.lastMs - stats.firstMs) / 3600000.0;
+    Serial.printf("🎞️ Replayed %lu lines covering %.1f h in %lu ms (%.0fx real time), %lu reboots\n",
+                  (unsigned long)stats.lines, spanHours, wallMs,
+                  wallMs ? (stats.lastMs - stats.firstMs) / (double)wallMs : 0.0, (unsigned long)stats.reboots);
+    Serial.printf("   BMP390 %lu readings, %lu failures | DHT11 %lu readings, %lu failures\n",
+                  (unsigned long)stats.bmpReadings, (unsigned long)stats.bmpFailures,
+                  (unsigned long)stats.dhtReadings, (unsigned long)stats.dhtFailures);
+    Serial.printf("   %lu publishes (%.1f per hour), max smoothing lag %.2f hPa\n",
+                  (unsigned long)stats.publishes, spanHours > 0 ? stats.publishes / spanHours : 0.0,
+                  stats.maxPressureLag);
+}
+
+/**
+ * Replays a trace through the sensor pipeline and the publish policy
+ * Reads TRACE_FILE if it exists, otherwise trace lines sent over Serial
+ * at TRACE_REPLAY_BAUD, then prints a summary. No sensor, display or
+ * network is started. Does not return.
+ */
+void runTraceReplay() {
+    TraceReplayStats stats;
+    traceReplayBegin(stats);
+
+    bool fromFile = LittleFS.begin(false) && LittleFS.exists(TRACE_FILE);
+    File file;
+    Stream *input;
+    if (fromFile) {
+        file = LittleFS.open(TRACE_FILE, FILE_READ);
+        input = &file;
+        Serial.printf("🎞️ Replaying %s (%u bytes)\n", TRACE_FILE, (unsigned)file.size());
+    } else {
+        Serial.printf("🎞️ Send the trace at %lu baud; replay ends %u s after the last line\n",
+                      (unsigned long)TRACE_REPLAY_BAUD, (unsigned)(TRACE_REPLAY_IDLE_MS / 1000));
+        Serial.flush();
+        Serial.end();
+        Serial.setRxBufferSize(4096);
+        Serial.begin(TRACE_REPLAY_BAUD);
+        input = &Serial;
+    }
+    input->setTimeout(fromFile ? 0 : TRACE_REPLAY_IDLE_MS);
+
+    unsigned long start = millis();
+    char line[128];
+    while (true) {
+        size_t len = input->readBytesUntil('\n', line, sizeof(line) - 1);
+        if (len == 0) {
+            if (fromFile ? !file.available() : true) break;  // End of file, or Serial went quiet
+            continue;
+        }
+        line[len] = '\0';
+        traceReplayLine(line, stats);
+    }
+    traceReplayEnd();
+    printTraceReplaySummary(stats, millis() - start);
+
+    while (true) {
+        delay(1000);
+    }
+}
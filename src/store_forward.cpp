@@ -0,0 +1,311 @@
+#include "include/store_forward.h"
+#include "include/deferred_log.h"
+#include "include/time_manager.h"
+#include <LittleFS.h>
+
+/*
+ * Append-only flash log of readings that could not be published.
+ * Records go to numbered segment files of one flash block each. Readings
+ * are buffered in RAM and written STORE_FORWARD_FLUSH_RECORDS at a time so
+ * each flash write covers many records. Replay reads from the oldest
+ * segment and deletes it once it is fully sent; the read position inside
+ * that segment is kept in a small cursor file written once per batch.
+ * Segment files are written sequentially and recycled whole, which spreads
+ * wear across the LittleFS blocks.
+ *
+ * Readings queued before NTP has set the clock carry their uptime instead
+ * of a Unix time (flagged with QUEUED_TIME_UPTIME). Replay waits for the
+ * clock and dates them from the current time when they are read back.
+ * Uptime from an earlier boot cannot be dated; such readings, found before
+ * the position where this boot started writing, are dropped.
+ */
+
+#define STORE_FORWARD_CURSOR STORE_FORWARD_DIR "/cursor"
+#define RECORD_BYTES sizeof(QueuedReading)
+
+static QueuedReading writeBuffer[STORE_FORWARD_FLUSH_RECORDS];  // Readings not yet on flash
+static size_t writeCount = 0;
+
+static uint32_t headSegment = 0;   // Oldest segment with unsent readings
+static uint32_t headOffset = 0;    // Bytes of the head segment already replayed
+static uint32_t tailSegment = 0;   // Segment receiving new readings
+static uint32_t tailBytes = 0;     // Bytes stored in the tail segment
+static uint32_t bootSegment = 0;   // Where this boot started writing
+static uint32_t bootBytes = 0;
+static bool storeReady = false;
+
+static StoreForwardStats stats;
+static unsigned long replayStartTime = 0;
+static uint32_t replayRecords = 0;
+
+/**
+ * Builds the file name of a segment
+ */
+static void segmentPath(uint32_t segment, char *path, size_t len) {
+    snprintf(path, len, STORE_FORWARD_DIR "/%08lu.log", (unsigned long)segment);
+}
+
+/**
+ * Returns the size of a segment file in bytes (0 if missing)
+ */
+static uint32_t segmentSize(uint32_t segment) {
+    char path[32];
+    segmentPath(segment, path, sizeof(path));
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f) return 0;
+    uint32_t size = f.size() - (f.size() % RECORD_BYTES);  // Ignore a torn trailing record
+    f.close();
+    return size;
+}
+
+/**
+ * Persists the replay position
+ */
+static void saveCursor() {
+    uint32_t cursor[2] = { headSegment, headOffset };
+    File f = LittleFS.open(STORE_FORWARD_CURSOR, FILE_WRITE);
+    if (!f) return;
+    stats.flashBytesWritten += f.write((const uint8_t *)cursor, sizeof(cursor));
+    f.close();
+}
+
+/**
+ * Deletes the head segment and moves replay to the next one
+ */
+static void dropHeadSegment() {
+    char path[32];
+    segmentPath(headSegment, path, sizeof(path));
+    LittleFS.remove(path);
+    if (headSegment == tailSegment) {
+        tailSegment++;
+        tailBytes = 0;
+    }
+    headSegment++;
+    headOffset = 0;
+}
+
+/**
+ * Mounts LittleFS and recovers queued readings left from before a reboot
+ * @return true if the store is usable
+ */
+bool setupStoreForward() {
+    if (!LittleFS.begin(true)) {  // Format on first use
+        LOG_ERROR("❌ LittleFS mount failed! Store-and-forward disabled.");
+        return false;
+    }
+    LittleFS.mkdir(STORE_FORWARD_DIR);
+
+    // Find the oldest and newest segment files
+    bool found = false;
+    File dir = LittleFS.open(STORE_FORWARD_DIR);
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+        const char *name = strrchr(f.name(), '/');
+        name = name ? name + 1 : f.name();
+        if (strstr(name, ".log") == NULL) continue;
+        uint32_t segment = strtoul(name, NULL, 10);
+        if (!found || segment < headSegment) headSegment = segment;
+        if (!found || segment > tailSegment) tailSegment = segment;
+        found = true;
+    }
+
+    if (found) {
+        uint32_t cursor[2] = { 0, 0 };
+        File f = LittleFS.open(STORE_FORWARD_CURSOR, FILE_READ);
+        if (f && f.read((uint8_t *)cursor, sizeof(cursor)) == sizeof(cursor) && cursor[0] == headSegment) {
+            headOffset = cursor[1] - (cursor[1] % RECORD_BYTES);
+        }
+        if (f) f.close();
+
+        tailBytes = segmentSize(tailSegment);
+        for (uint32_t s = headSegment; s <= tailSegment; s++) {
+            stats.pending += segmentSize(s) / RECORD_BYTES;
+        }
+        stats.pending -= min(stats.pending, headOffset / (uint32_t)RECORD_BYTES);
+    }
+    bootSegment = tailSegment;
+    bootBytes = tailBytes;
+
+    storeReady = true;
+    LOG_INFO("✅ Store-and-forward ready. %u queued readings.", (unsigned)stats.pending);
+    return true;
+}
+
+/**
+ * Queues a reading that could not be published
+ * @param snap Readings to store
+ * @param timestamp Unix time of the readings (s)
+ */
+void storeForwardAppend(const SensorSnapshot &snap, uint32_t timestamp) {
+    if (!storeReady) return;
+
+    QueuedReading &r = writeBuffer[writeCount++];
+    r.timestamp = timestamp;
+    r.pressure = (uint32_t)lroundf(snap.pressure * 100.0f);
+    r.altitude = (int32_t)lroundf(snap.altitude * 100.0f);
+    r.temperature = (int16_t)lroundf(snap.temperature * 100.0f);
+    r.humidity = (uint16_t)lroundf(snap.humidity * 10.0f);
+    stats.appended++;
+    stats.pending++;
+
+    if (writeCount == STORE_FORWARD_FLUSH_RECORDS) {
+        storeForwardFlush();
+    }
+}
+
+/**
+ * Rebuilds a queued reading, including the derived quantities, so it is
+ * serialized like a live one
+ * @param r Queued reading
+ * @param snap Destination record
+ */
+void queuedReadingToSnapshot(const QueuedReading &r, SensorSnapshot &snap) {
+    snap.temperature = r.temperature / 100.0f;
+    snap.pressure = r.pressure / 100.0f;
+    snap.altitude = r.altitude / 100.0f;
+    snap.humidity = r.humidity / 10.0f;
+    deriveSensorReadings(snap);
+    snap.timestampMs = 0;
+    snap.sequence = 0;
+}
+
+/**
+ * Writes buffered readings to the tail segment, rotating segments when full
+ * and dropping the oldest segment beyond STORE_FORWARD_MAX_SEGMENTS
+ */
+void storeForwardFlush() {
+    size_t written = 0;
+    while (written < writeCount) {
+        if (tailBytes >= STORE_FORWARD_SEGMENT_BYTES) {
+            tailSegment++;
+            tailBytes = 0;
+        }
+
+        size_t room = (STORE_FORWARD_SEGMENT_BYTES - tailBytes) / RECORD_BYTES;
+        size_t count = min(room, writeCount - written);
+        char path[32];
+        segmentPath(tailSegment, path, sizeof(path));
+        File f = LittleFS.open(path, FILE_APPEND);
+        if (!f) {
+            LOG_WARN("⚠️ Store-and-forward write failed!");
+            uint32_t lost = writeCount - written;
+            stats.dropped += lost;
+            stats.pending -= min(stats.pending, lost);
+            break;
+        }
+        size_t bytes = f.write((const uint8_t *)&writeBuffer[written], count * RECORD_BYTES);
+        f.close();
+        stats.flashBytesWritten += bytes;
+        tailBytes += bytes;
+        written += count;
+    }
+    writeCount = 0;
+
+    while (tailSegment - headSegment >= STORE_FORWARD_MAX_SEGMENTS) {
+        uint32_t lost = (segmentSize(headSegment) - headOffset) / RECORD_BYTES;
+        stats.dropped += lost;
+        stats.pending -= min(stats.pending, lost);
+        dropHeadSegment();
+        saveCursor();
+    }
+}
+
+/**
+ * Returns the number of readings waiting to be replayed
+ */
+uint32_t storeForwardPending() {
+    return stats.pending;
+}
+
+/**
+ * Replaces uptime timestamps with Unix time
+ * @param out Readings read from the head segment
+ * @param count Number of readings
+ * @return Readings at the start of out that have a Unix time; stops at the
+ *         first one queued with uptime by an earlier boot
+ */
+static size_t resolveTimestamps(QueuedReading *out, size_t count) {
+    uint32_t now = (uint32_t)time(NULL);
+    uint32_t uptime = millis() / 1000;
+    for (size_t i = 0; i < count; i++) {
+        QueuedReading &r = out[i];
+        if ((r.timestamp & QUEUED_TIME_UPTIME) == 0) continue;
+        uint32_t offset = headOffset + i * RECORD_BYTES;
+        bool thisBoot = headSegment > bootSegment || (headSegment == bootSegment && offset >= bootBytes);
+        if (!thisBoot) return i;
+        r.timestamp = now - (uptime - (r.timestamp & ~QUEUED_TIME_UPTIME));
+    }
+    return count;
+}
+
+/**
+ * Reads the oldest queued readings without removing them
+ * Returns nothing until NTP has set the clock, so every reading handed out
+ * carries a Unix time; readings that cannot be dated are dropped here
+ *
+ * @param out Destination array
+ * @param maxRecords Capacity of the destination
+ * @return Number of readings read
+ */
+size_t storeForwardPeek(QueuedReading *out, size_t maxRecords) {
+    if (!storeReady || stats.pending == 0 || !timeSynced()) return 0;
+    if (writeCount > 0) storeForwardFlush();
+
+    if (replayRecords == 0) {
+        replayStartTime = millis();
+    }
+
+    while (true) {
+        uint32_t size = segmentSize(headSegment);
+        if (headOffset < size) {
+            char path[32];
+            segmentPath(headSegment, path, sizeof(path));
+            File f = LittleFS.open(path, FILE_READ);
+            if (!f) return 0;
+            f.seek(headOffset);
+            size_t count = min(maxRecords, (size_t)(size - headOffset) / RECORD_BYTES);
+            size_t bytes = f.read((uint8_t *)out, count * RECORD_BYTES);
+            f.close();
+            count = bytes / RECORD_BYTES;
+            size_t dated = resolveTimestamps(out, count);
+            if (dated > 0 || count == 0) return dated;
+
+            // The oldest reading has uptime from an earlier boot
+            headOffset += RECORD_BYTES;
+            stats.pending -= min(stats.pending, (uint32_t)1);
+            stats.dropped++;
+            continue;
+        }
+        if (headSegment == tailSegment) return 0;
+        dropHeadSegment();  // Fully replayed, move on
+    }
+}
+
+/**
+ * Removes replayed readings from the queue
+ * @param records Number of readings returned by storeForwardPeek() that were sent
+ */
+void storeForwardConsume(size_t records) {
+    headOffset += records * RECORD_BYTES;
+    stats.pending -= min(stats.pending, (uint32_t)records);
+    stats.replayed += records;
+    replayRecords += records;
+
+    if (headOffset >= segmentSize(headSegment)) {
+        dropHeadSegment();
+    }
+    saveCursor();
+
+    if (stats.pending == 0) {
+        stats.lastReplayRecords = replayRecords;
+        stats.lastReplayMs = millis() - replayStartTime;
+        replayRecords = 0;
+    }
+}
+
+/**
+ * Copies the store-and-forward counters
+ * @param out Destination for the counters
+ */
+void getStoreForwardStats(StoreForwardStats &out) {
+    out = stats;
+}
@@ -0,0 +1,177 @@
+#include "include/telemetry_codec.h"
+#include <math.h>
+
+#define TELEMETRY_MISSING INT32_MIN      // Scaled value of a NaN reading
+#define TELEMETRY_MAX_DECIMALS 6
+
+static const int32_t powersOfTen[TELEMETRY_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+/**
+ * Writes a zigzag LEB128 varint
+ * @return New length
+ */
+static size_t putVarint(uint8_t *buf, size_t length, int32_t value) {
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    while (zigzag >= 0x80) {
+        buf[length++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    buf[length++] = (uint8_t)zigzag;
+    return length;
+}
+
+/**
+ * Reads a zigzag LEB128 varint
+ * @return false if the frame ends inside the varint or it is too long
+ */
+static bool getVarint(const uint8_t *buf, size_t length, size_t &pos, int32_t &value) {
+    uint32_t zigzag = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= length) return false;
+        uint8_t byte = buf[pos++];
+        zigzag |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            value = (int32_t)((zigzag >> 1) ^ (0U - (zigzag & 1)));
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Difference of two scaled values with 32-bit wrap-around
+ */
+static int32_t wrapDelta(int32_t value, int32_t previous) {
+    return (int32_t)((uint32_t)value - (uint32_t)previous);
+}
+
+/**
+ * Converts a reading to its scaled integer, or TELEMETRY_MISSING
+ */
+static int32_t scaleValue(float value, int32_t scale) {
+    if (isnan(value)) return TELEMETRY_MISSING;
+    double scaled = round((double)value * scale);
+    if (scaled >= 2147483647.0) return INT32_MAX;
+    if (scaled <= -2147483647.0) return -INT32_MAX;  // INT32_MIN is reserved for NaN
+    return (int32_t)scaled;
+}
+
+/**
+ * Starts a frame in a caller-provided buffer
+ * @param enc Encoder state
+ * @param buf Frame buffer
+ * @param size Size of the buffer
+ * @param decimals Precision of each field
+ * @param fieldCount Number of fields per sample
+ * @return false if the buffer cannot hold the header and one sample
+ */
+bool telemetryBegin(TelemetryEncoder &enc, uint8_t *buf, size_t size, const uint8_t *decimals, uint8_t fieldCount) {
+    if (fieldCount > TELEMETRY_MAX_FIELDS ||
+        size < TELEMETRY_HEADER_BYTES(fieldCount) + TELEMETRY_MAX_SAMPLE_BYTES(fieldCount)) {
+        return false;
+    }
+    enc.buf = buf;
+    enc.size = size;
+    enc.fieldCount = fieldCount;
+    enc.samples = 0;
+    enc.lastTimestamp = 0;
+
+    buf[0] = TELEMETRY_FORMAT_VERSION;
+    buf[1] = fieldCount;
+    buf[2] = 0;
+    for (int i = 0; i < 4; i++) {
+        buf[3 + i] = 0;  // First timestamp, set by the first sample
+    }
+    for (uint8_t i = 0; i < fieldCount; i++) {
+        uint8_t d = decimals[i] > TELEMETRY_MAX_DECIMALS ? TELEMETRY_MAX_DECIMALS : decimals[i];
+        buf[7 + i] = d;
+        enc.scale[i] = powersOfTen[d];
+        enc.last[i] = 0;
+    }
+    enc.length = TELEMETRY_HEADER_BYTES(fieldCount);
+    return true;
+}
+
+/**
+ * Adds a sample to the frame
+ * @param enc Encoder state
+ * @param timestamp Unix time of the sample (s)
+ * @param values One value per field (NaN if missing)
+ * @return false if the frame is full; the frame is left unchanged
+ */
+bool telemetryAppend(TelemetryEncoder &enc, uint32_t timestamp, const float *values) {
+    if (enc.samples == TELEMETRY_MAX_SAMPLES ||
+        enc.length + TELEMETRY_MAX_SAMPLE_BYTES(enc.fieldCount) > enc.size) {
+        return false;
+    }
+    if (enc.samples == 0) {
+        for (int i = 0; i < 4; i++) {
+            enc.buf[3 + i] = (uint8_t)(timestamp >> (8 * i));
+        }
+        enc.lastTimestamp = timestamp;
+    }
+
+    size_t length = putVarint(enc.buf, enc.length, wrapDelta((int32_t)timestamp, (int32_t)enc.lastTimestamp));
+    enc.lastTimestamp = timestamp;
+    for (uint8_t i = 0; i < enc.fieldCount; i++) {
+        int32_t scaled = scaleValue(values[i], enc.scale[i]);
+        length = putVarint(enc.buf, length, wrapDelta(scaled, enc.last[i]));
+        enc.last[i] = scaled;
+    }
+    enc.length = length;
+    enc.buf[2] = ++enc.samples;
+    return true;
+}
+
+/**
+ * Returns the length of the frame
+ * @param enc Encoder state
+ * @return Bytes to publish, 0 if the frame has no samples
+ */
+size_t telemetryLength(const TelemetryEncoder &enc) {
+    return enc.samples ? enc.length : 0;
+}
+
+/**
+ * Decodes a frame
+ * @param frame Frame bytes
+ * @param length Frame length
+ * @param samples Receives the decoded samples
+ * @param maxSamples Capacity of samples
+ * @param fieldCount Receives the number of fields per sample
+ * @return Number of samples, or -1 if the frame is malformed or too large
+ */
+int telemetryDecode(const uint8_t *frame, size_t length, TelemetrySample *samples, size_t maxSamples,
+                    uint8_t &fieldCount) {
+    if (length < 7 || frame[0] != TELEMETRY_FORMAT_VERSION) return -1;
+    fieldCount = frame[1];
+    uint8_t sampleCount = frame[2];
+    if (fieldCount > TELEMETRY_MAX_FIELDS || length < TELEMETRY_HEADER_BYTES(fieldCount) ||
+        sampleCount > maxSamples) {
+        return -1;
+    }
+
+    int32_t scale[TELEMETRY_MAX_FIELDS];
+    int32_t last[TELEMETRY_MAX_FIELDS];
+    for (uint8_t i = 0; i < fieldCount; i++) {
+        if (frame[7 + i] > TELEMETRY_MAX_DECIMALS) return -1;
+        scale[i] = powersOfTen[frame[7 + i]];
+        last[i] = 0;
+    }
+    uint32_t timestamp = (uint32_t)frame[3] | ((uint32_t)frame[4] << 8) |
+                         ((uint32_t)frame[5] << 16) | ((uint32_t)frame[6] << 24);
+
+    size_t pos = TELEMETRY_HEADER_BYTES(fieldCount);
+    for (uint8_t s = 0; s < sampleCount; s++) {
+        int32_t delta;
+        if (!getVarint(frame, length, pos, delta)) return -1;
+        timestamp += (uint32_t)delta;
+        samples[s].timestamp = timestamp;
+        for (uint8_t i = 0; i < fieldCount; i++) {
+            if (!getVarint(frame, length, pos, delta)) return -1;
+            last[i] = (int32_t)((uint32_t)last[i] + (uint32_t)delta);
+            samples[s].values[i] = last[i] == TELEMETRY_MISSING ? NAN : (float)((double)last[i] / scale[i]);
+        }
+    }
+    return pos == length ? sampleCount : -1;
+}
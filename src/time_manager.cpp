@@ -1,43 +1,64 @@
 #include "include/time_manager.h"
 #include <WiFi.h>
 #include <Arduino.h>
+#include "include/boot_trace.h"
+#include "include/deferred_log.h"
 
 // NTP Configuration
 const char* ntpServer = "pool.ntp.org";  // NTP server for time synchronization
 const long gmtOffset_sec = -8 * 3600;    // Offset for Pacific Standard Time (PST)
 const int daylightOffset_sec = 3600;     // Offset for daylight saving time (1 hour)
 
+// Any earlier clock value means SNTP has not set the time yet
+#define TIME_VALID_AFTER 1600000000L  // September 2020
+
 // Time string storage
-static char timeStr[30] = "";  // Buffer for formatted time string (includes AM/PM and PST)
+static char timeStr[30] = "Waiting for NTP...";  // Buffer for formatted time string (includes AM/PM and PST)
 
 /**
  * Sets up NTP time synchronization
+ * SNTP runs in the background and keeps retrying until the network is up,
+ * so this returns immediately.
  */
 void setupTime() {
-    Serial.println("Waiting 5 seconds before attempting NTP sync...");
-    delay(5000);  // Delay to ensure stable network connection
-
-    // Configure time settings
     configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
+}
 
-    struct tm timeInfo;
-    // Retry until successful time synchronization
-    while (!getLocalTime(&timeInfo)) {
-        Serial.println("Failed to obtain time from NTP. Retrying in 5 seconds...");
-        delay(5000);
+/**
+ * Checks whether the clock has been set by NTP
+ * @return bool Returns true once a valid time is available
+ */
+bool timeSynced() {
+    if (time(NULL) < TIME_VALID_AFTER) return false;
+    if (bootTraceTime(BOOT_TIME_SYNCED) == 0) {
+        bootTraceMark(BOOT_TIME_SYNCED);
+        LOG_INFO("NTP Time Sync Complete.");
     }
+    return true;
+}
 
-    Serial.println("NTP Time Sync Setup Complete.");
+/**
+ * Waits for NTP time with a bound, for code that needs wall-clock time
+ * @param timeoutMs Maximum time to wait (ms)
+ * @return bool Returns true if the time is valid
+ */
+bool waitForTimeSync(unsigned long timeoutMs) {
+    unsigned long start = millis();
+    while (!timeSynced()) {
+        if (millis() - start >= timeoutMs) return false;
+        delay(50);
+    }
+    return true;
 }
 
 /**
  * Updates the formatted time string
+ * Keeps the placeholder until NTP time arrives, without waiting for it
  */
 void updateTimeString() {
     struct tm timeInfo;
     
-    if (!getLocalTime(&timeInfo)) {
-        Serial.println("Failed to obtain time from NTP");
+    if (!timeSynced() || !getLocalTime(&timeInfo, 0)) {
         return;
     }
 
@@ -1,38 +1,130 @@
 #include "include/wifi_manager.h"
+#include "include/boot_trace.h"
+#include "include/deferred_log.h"
+
+// Connection state machine driven by maintainWiFi()
+enum WiFiState {
+    WIFI_STATE_IDLE,            // setupWiFi() not called yet
+    WIFI_STATE_FAST_CONNECT,    // Joining the cached access point without a scan
+    WIFI_STATE_SCAN_CONNECT,    // Joining after a full channel scan
+    WIFI_STATE_CONNECTED
+};
+
+static WiFiState wifiState = WIFI_STATE_IDLE;
+static unsigned long wifiAttemptStart = 0;  // millis() when the current attempt began
+
+// Access point of the last successful connection (RTC memory, kept across
+// deep sleep and restarts); joining it directly skips the ~2 s channel scan
+RTC_DATA_ATTR static uint8_t cachedBSSID[6];
+RTC_DATA_ATTR static int32_t cachedChannel = 0;  // 0 = no cached access point
 
 /**
- * Sets up Wi-Fi connection
+ * Starts a connection attempt
+ * @param fast True to join the cached access point without scanning
  */
-void setupWiFi() {
-    Serial.println("Connecting to Wi-Fi...");
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-
-    int retryCount = 0;
-    while (WiFi.status() != WL_CONNECTED && retryCount < 30) {  // Increased timeout
-        delay(500);
-        Serial.print(".");
-        retryCount++;
-    }
-
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("\nWi-Fi Connected!");
-        Serial.print("IP Address: ");
-        Serial.println(WiFi.localIP());
-        delay(1000);  // Give the connection a moment to stabilize
+static void beginConnect(bool fast) {
+    if (fast) {
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD, cachedChannel, cachedBSSID);
+        wifiState = WIFI_STATE_FAST_CONNECT;
     } else {
-        Serial.println("\nWi-Fi Connection Failed!");
-        ESP.restart();  // Restart if we can't connect to WiFi
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+        wifiState = WIFI_STATE_SCAN_CONNECT;
     }
+    wifiAttemptStart = millis();
+}
+
+/**
+ * Starts connecting to Wi-Fi in the background
+ * Returns immediately; maintainWiFi() advances the connection.
+ */
+void setupWiFi() {
+    LOG_INFO("Connecting to Wi-Fi...");
+    WiFi.persistent(false);  // Credentials come from secrets.h, don't rewrite them to flash on every begin
+    WiFi.mode(WIFI_STA);
+#if WIFI_USE_STATIC_IP
+    // Skip DHCP; saves several hundred ms per connection
+    WiFi.config(IPAddress(WIFI_STATIC_IP), IPAddress(WIFI_GATEWAY), IPAddress(WIFI_SUBNET), IPAddress(WIFI_DNS));
+#endif
+    beginConnect(cachedChannel != 0);
 }
 
 /**
  * Maintains Wi-Fi connection
+ * Completes pending connection attempts, falls back from the cached access
+ * point to a full scan, and reconnects after a loss.
+ * @return unsigned long Milliseconds until this should be called again
  */
-void maintainWiFi() {
-    // Check if Wi-Fi connection is lost
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("Wi-Fi Lost! Reconnecting...");
-        WiFi.disconnect();
-        WiFi.reconnect();
+unsigned long maintainWiFi() {
+    bool up = (WiFi.status() == WL_CONNECTED);
+
+    switch (wifiState) {
+        case WIFI_STATE_IDLE:
+            setupWiFi();
+            return WIFI_POLL_INTERVAL_MS;
+
+        case WIFI_STATE_CONNECTED:
+            if (up) return WIFI_CHECK_INTERVAL_MS;
+            LOG_WARN("Wi-Fi Lost! Reconnecting...");
+            WiFi.disconnect();
+            beginConnect(cachedChannel != 0);
+            return WIFI_POLL_INTERVAL_MS;
+
+        case WIFI_STATE_FAST_CONNECT:
+        case WIFI_STATE_SCAN_CONNECT:
+            if (up) {
+                memcpy(cachedBSSID, WiFi.BSSID(), sizeof(cachedBSSID));
+                cachedChannel = WiFi.channel();
+                IPAddress ip = WiFi.localIP();
+                LOG_INFO("Wi-Fi Connected in %lu ms%s! IP Address: %u.%u.%u.%u",
+                         millis() - wifiAttemptStart,
+                         wifiState == WIFI_STATE_FAST_CONNECT ? " (cached AP)" : "",
+                         ip[0], ip[1], ip[2], ip[3]);
+                wifiState = WIFI_STATE_CONNECTED;
+                bootTraceMark(BOOT_WIFI_CONNECTED);
+                return WIFI_CHECK_INTERVAL_MS;
+            }
+
+            if (wifiState == WIFI_STATE_FAST_CONNECT && millis() - wifiAttemptStart >= WIFI_FAST_CONNECT_TIMEOUT_MS) {
+                // The access point moved or changed channel; forget it and scan
+                LOG_WARN("⚠️ Cached access point not reachable, scanning...");
+                cachedChannel = 0;
+                WiFi.disconnect();
+                beginConnect(false);
+            } else if (wifiState == WIFI_STATE_SCAN_CONNECT && millis() - wifiAttemptStart >= WIFI_CONNECT_TIMEOUT_MS) {
+                LOG_WARN("⚠️ Wi-Fi Connection Failed! Retrying...");
+                WiFi.disconnect();
+                beginConnect(false);
+            }
+            return WIFI_POLL_INTERVAL_MS;
+    }
+    return WIFI_POLL_INTERVAL_MS;
+}
+
+/**
+ * Checks whether Wi-Fi is connected
+ * @return bool Returns true once an IP address is assigned
+ */
+bool wifiConnected() {
+    return wifiState == WIFI_STATE_CONNECTED && WiFi.status() == WL_CONNECTED;
+}
+
+/**
+ * Connects to Wi-Fi, giving up after a timeout instead of restarting
+ * @param timeoutMs Maximum time to wait for the connection (ms)
+ * @return bool Returns true if connected
+ */
+bool connectWiFi(unsigned long timeoutMs) {
+    setupWiFi();
+
+    unsigned long start = millis();
+    while (!wifiConnected() && millis() - start < timeoutMs) {
+        maintainWiFi();
+        delay(50);
+    }
+
+    if (!wifiConnected()) {
+        LOG_WARN("⚠️ Wi-Fi Connection Failed!");
+        return false;
     }
+    return true;
 }
@@ -0,0 +1,379 @@
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include "host_hal.h"
+#include "sim_bmp390.h"
+#include "sim_dht11.h"
+#include "sim_ssd1306.h"
+#include "include/bmp390_sensor.h"
+#include "include/dht_sensor.h"
+#include "include/oled_display.h"
+#include "include/mqtt_client.h"
+#include "include/wifi_manager.h"
+#include "include/mqtt_publisher.h"
+#include "include/i2c_bus.h"
+#include "include/sensor_math.h"
+#include "include/history_store.h"
+#include "include/store_forward.h"
+#include "include/deferred_log.h"
+#include "include/adaptive_sampling.h"
+#include "include/number_format.h"
+#include "include/binary_telemetry.h"
+
+/*
+ * Benchmark runner for the task loop hot paths. Each function runs against
+ * the simulated sensors, panel and broker under the manual clock (advanced
+ * between calls as the scheduler would), and is measured in host time:
+ * time per call, heap allocations per call and bytes put on the I2C bus,
+ * handed to MQTT and written to Serial. Report lines are written by the
+ * log task after the job returns; their bytes are counted once it is idle,
+ * outside the timed call.
+ *
+ * A second table times the firmware's kernels against the library
+ * routines they replace, on the same inputs.
+ *
+ *   bench [--iterations N] [--check]
+ *
+ * --check fails if a hot path or a firmware kernel allocates, or a device
+ * saw no traffic.
+ */
+
+void serialReportJob();  // sketch.ino
+
+struct BenchResult {
+    const char *name;
+    uint32_t calls;
+    double totalMicros;
+    double maxMicros;
+    uint64_t allocations;
+    uint64_t i2cBytes;
+    uint64_t mqttBytes;
+    uint64_t serialBytes;
+};
+
+// Counters sampled around each call
+struct Counters {
+    uint64_t allocations;
+    uint64_t i2cBytes;
+    uint64_t mqttBytes;
+    uint64_t serialBytes;
+};
+
+static Counters sample() {
+    HostI2CStats i2c;
+    hostI2CStats(i2c);
+    HostMqttStats mqtt;
+    hostMqttStats(mqtt);
+    return {hostThreadAllocations(), i2c.bytesWritten + i2c.bytesRead, mqtt.bytes, hostSerialBytes()};
+}
+
+/**
+ * Runs one measured call and adds it to the result; settle() runs after
+ * the timer stops, before the traffic is counted
+ */
+template <class F, class S>
+static void measure(BenchResult &r, F call, S settle) {
+    Counters before = sample();
+    auto start = std::chrono::steady_clock::now();
+    call();
+    auto end = std::chrono::steady_clock::now();
+    settle();
+    Counters after = sample();
+
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+    r.calls++;
+    r.totalMicros += us;
+    if (us > r.maxMicros) r.maxMicros = us;
+    r.allocations += after.allocations - before.allocations;
+    r.i2cBytes += after.i2cBytes - before.i2cBytes;
+    r.mqttBytes += after.mqttBytes - before.mqttBytes;
+    r.serialBytes += after.serialBytes - before.serialBytes;
+}
+
+template <class F>
+static void measure(BenchResult &r, F call) {
+    measure(r, call, []() {});
+}
+
+// One row of the kernel table: a firmware routine or the library call it replaces
+struct KernelResult {
+    const char *name;
+    bool firmware;            // Must not allocate
+    uint32_t calls;
+    double totalMicros;
+    uint64_t allocations;
+    uint64_t outputBytes;     // Bytes the call produced (text, frame), 0 if none
+};
+
+static volatile uint32_t kernelSink;  // Keeps results alive
+
+/**
+ * Runs a kernel for the given number of calls; call(n) returns the bytes
+ * it produced
+ */
+template <class F>
+static void measureKernel(KernelResult &r, uint32_t calls, F call) {
+    uint64_t allocations = hostThreadAllocations();
+    uint64_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < calls; n++) {
+        bytes += call(n);
+    }
+    auto end = std::chrono::steady_clock::now();
+    r.calls += calls;
+    r.totalMicros += std::chrono::duration<double, std::micro>(end - start).count();
+    r.allocations += hostThreadAllocations() - allocations;
+    r.outputBytes += bytes;
+}
+
+#define KERNEL_ALTITUDE_BATCH 256
+
+#define KERNEL_FORMAT_VALUES 64
+
+static float kernelPressures[KERNEL_ALTITUDE_BATCH];
+static float kernelAltitudes[KERNEL_ALTITUDE_BATCH];
+static float kernelValues[KERNEL_FORMAT_VALUES];  // Readings as they reach the formatter
+static char kernelText[64];
+
+// Backlog frame of synthetic readings, encoded one sample per call
+static SensorSnapshot kernelReadings[TELEMETRY_BACKLOG_SAMPLES];
+static uint8_t kernelDecimals[SENSOR_COUNT];
+static uint8_t kernelFrame[TELEMETRY_FRAME_BYTES];
+static TelemetryEncoder kernelEncoder;
+static char kernelJson[160];
+
+/**
+ * Appends one reading to the benchmark frame, starting a new frame when
+ * the last one was full
+ * @return Bytes the frame grew by, including the header of a new frame
+ */
+static size_t encodeKernelReading(uint32_t n) {
+    const SensorSnapshot &snap = kernelReadings[n % TELEMETRY_BACKLOG_SAMPLES];
+    float values[SENSOR_COUNT];
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        values[i] = snap.*sensorRegistry[i].field;
+    }
+    uint32_t timestamp = 1700000000 + 30 * n;
+    size_t before = telemetryLength(kernelEncoder);
+    if (n % TELEMETRY_BACKLOG_SAMPLES == 0 || !telemetryAppend(kernelEncoder, timestamp, values)) {
+        telemetryBegin(kernelEncoder, kernelFrame, sizeof(kernelFrame), kernelDecimals, SENSOR_COUNT);
+        telemetryAppend(kernelEncoder, timestamp, values);
+        before = 0;
+    }
+    return telemetryLength(kernelEncoder) - before;
+}
+
+/**
+ * Times the kernels and prints their table
+ * @return false if a firmware kernel allocated
+ */
+static bool runKernels(uint32_t iterations) {
+    for (size_t n = 0; n < KERNEL_ALTITUDE_BATCH; n++) {
+        kernelPressures[n] = 300.0f + n * (800.0f / KERNEL_ALTITUDE_BATCH);
+    }
+
+    for (size_t n = 0; n < KERNEL_FORMAT_VALUES; n++) {
+        kernelValues[n] = (n % 4 == 0) ? 1013.25f - n * 0.37f : (n % 4 == 1) ? 21.5f + n * 0.013f
+                        : (n % 4 == 2) ? 45.0f - n * 0.5f : -12.75f + n * 0.9f;
+    }
+
+    for (size_t n = 0; n < TELEMETRY_BACKLOG_SAMPLES; n++) {
+        SensorSnapshot &s = kernelReadings[n];  // Same series as benchmarkTelemetry()
+        s.temperature = 21.0f + 0.07f * n;
+        s.humidity = 45.0f - 0.3f * (n % 5);
+        s.pressure = 1013.0f + 0.1f * (n % 7);
+        s.altitude = 85.0f - 0.8f * (n % 7);
+        deriveSensorReadings(s);
+    }
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        kernelDecimals[i] = sensorRegistry[i].decimals;
+    }
+
+    KernelResult results[] = {
+        {"altitude table", true, 0, 0, 0, 0},
+        {"altitude powf", false, 0, 0, 0, 0},
+        {"appendFixed 0", true, 0, 0, 0, 0},
+        {"snprintf %.0f", false, 0, 0, 0, 0},
+        {"appendFixed 1", true, 0, 0, 0, 0},
+        {"snprintf %.1f", false, 0, 0, 0, 0},
+        {"appendFixed 2", true, 0, 0, 0, 0},
+        {"snprintf %.2f", false, 0, 0, 0, 0},
+        {"appendJsonField 2", true, 0, 0, 0, 0},
+        {"snprintf json %.2f", false, 0, 0, 0, 0},
+        {"telemetry binary", true, 0, 0, 0, 0},
+        {"telemetry json", true, 0, 0, 0, 0},
+    };
+    uint32_t batches = max(1u, iterations / 10);
+    measureKernel(results[0], batches * KERNEL_ALTITUDE_BATCH, [](uint32_t n) -> size_t {
+        if (n % KERNEL_ALTITUDE_BATCH == 0) {
+            pressureToAltitudeBatch(kernelPressures, kernelAltitudes, KERNEL_ALTITUDE_BATCH);
+            kernelSink += (uint32_t)kernelAltitudes[n % 7];
+        }
+        return 0;
+    });
+    measureKernel(results[1], batches * KERNEL_ALTITUDE_BATCH, [](uint32_t n) -> size_t {
+        float p = kernelPressures[n % KERNEL_ALTITUDE_BATCH];
+        kernelSink += (uint32_t)(44330.0f * (1.0f - powf(p / SEA_LEVEL_PRESSURE_HPA, 0.1903f)));
+        return 0;
+    });
+
+    uint32_t formats = iterations * 10;
+    for (uint8_t decimals = 0; decimals <= 2; decimals++) {
+        measureKernel(results[2 + 2 * decimals], formats, [decimals](uint32_t n) -> size_t {
+            return appendFixed(kernelText, sizeof(kernelText), 0, kernelValues[n % KERNEL_FORMAT_VALUES], decimals);
+        });
+        measureKernel(results[3 + 2 * decimals], formats, [decimals](uint32_t n) -> size_t {
+            return snprintf(kernelText, sizeof(kernelText), "%.*f", decimals,
+                            (double)kernelValues[n % KERNEL_FORMAT_VALUES]);
+        });
+    }
+    measureKernel(results[8], formats, [](uint32_t n) -> size_t {
+        size_t len = appendText(kernelText, sizeof(kernelText), 0, "{");
+        return appendJsonField(kernelText, sizeof(kernelText), len, "temperature",
+                               kernelValues[n % KERNEL_FORMAT_VALUES], 2);
+    });
+    measureKernel(results[9], formats, [](uint32_t n) -> size_t {
+        return snprintf(kernelText, sizeof(kernelText), "{\"temperature\":%.2f",
+                        (double)kernelValues[n % KERNEL_FORMAT_VALUES]);
+    });
+
+    // Per backlog sample: a frame entry against a JSON array entry
+    uint32_t samples = iterations * 10;
+    measureKernel(results[10], samples, encodeKernelReading);
+    measureKernel(results[11], samples, [](uint32_t n) -> size_t {
+        size_t len = appendText(kernelJson, sizeof(kernelJson), 0, "{\"ts\":");
+        len = appendUInt(kernelJson, sizeof(kernelJson), len, 1700000000 + 30 * n);
+        len = appendSensorJson(kernelJson, sizeof(kernelJson), len, kernelReadings[n % TELEMETRY_BACKLOG_SAMPLES]);
+        return appendText(kernelJson, sizeof(kernelJson), len, "},");
+    });
+
+    printf("\n%-22s %9s %9s %12s %11s\n", "kernel", "calls", "avg us", "allocs/call", "out B/call");
+    bool ok = true;
+    for (const KernelResult &r : results) {
+        double calls = r.calls ? r.calls : 1;
+        printf("%-22s %9lu %9.4f %12.2f %11.1f\n", r.name, (unsigned long)r.calls, r.totalMicros / calls,
+               r.allocations / calls, r.outputBytes / calls);
+        if (r.firmware && r.allocations > 0) {
+            fprintf(stderr, "bench: %s allocated %llu times\n", r.name, (unsigned long long)r.allocations);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * Brings up the firmware as setup() does, minus the scheduler tasks
+ */
+static bool startFirmware() {
+    setupLog();
+    setupI2CBus();
+    setupSensorMath();
+    setupDHTSensor();
+    setupBMP390Sensor();
+    setupOLED();
+    setupTime();
+    setupMQTT();
+    setupHistory();
+    setupStoreForward();
+    if (!connectWiFi(WIFI_CONNECT_TIMEOUT_MS)) return false;
+    for (int i = 0; i < 10 && !mqttConnected(); i++) {
+        delay(serviceMQTT());
+    }
+    return mqttConnected();
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 1000;
+    bool check = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else {
+            fprintf(stderr, "usage: %s [--iterations N] [--check]\n", argv[0]);
+            return 2;
+        }
+    }
+    const uint32_t warmup = 5;
+
+    hostSerialOutput(nullptr);  // Count Serial bytes without printing them
+    hostClockManual(true);
+    hostSetEpoch(1760000000);
+    simBMP390.attach();
+    simBMP390.setEnvironment(21.5f, 101325.0f);
+    simSSD1306.attach();
+    simDHT11.attach(DHTPIN);
+    simDHT11.setReading(45.0f, 21.0f);
+
+    if (!startFirmware()) {
+        fprintf(stderr, "bench: firmware did not come up (Wi-Fi or MQTT)\n");
+        return 1;
+    }
+
+    BenchResult results[] = {
+        {"readBMP390Sensor", 0, 0, 0, 0, 0, 0, 0},
+        {"readDHTSensor", 0, 0, 0, 0, 0, 0, 0},
+        {"updateOLED", 0, 0, 0, 0, 0, 0, 0},
+        {"publishSensorData", 0, 0, 0, 0, 0, 0, 0},
+        {"serialReportJob", 0, 0, 0, 0, 0, 0, 0},
+    };
+    BenchResult discard = {"warmup", 0, 0, 0, 0, 0, 0, 0};
+
+    for (uint32_t i = 0; i < warmup + iterations; i++) {
+        bool counted = i >= warmup;
+        float pressure = 101325.0f + 40.0f * sinf(i * 0.05f);  // Slow swing, so readings and deadbands move
+        simBMP390.setEnvironment(21.5f + 0.5f * sinf(i * 0.03f), pressure);
+        simDHT11.setReading(45.0f + (i % 7), 21.0f);
+
+        hostClockAdvanceMs(samplingIntervalMs(SAMPLING_BMP390));  // FIFO fills as between two reads
+        measure(counted ? results[0] : discard, []() { readBMP390Sensor(); });
+
+        for (int step = 0; step < 3; step++) {
+            unsigned long waitMs = 0;
+            measure(counted ? results[1] : discard, [&waitMs]() { waitMs = readDHTSensor(); });
+            hostClockAdvanceMs(step < 2 ? waitMs : 0);
+        }
+
+        hostClockAdvanceMs(3000);
+        measure(counted ? results[2] : discard, []() { updateOLED(); });
+
+        measure(counted ? results[3] : discard, []() {
+            publishSensorData();
+            mqttFlush();
+        });
+
+        measure(counted ? results[4] : discard, []() { serialReportJob(); }, []() {
+            while (!logIdle()) std::this_thread::yield();
+        });
+    }
+
+    printf("Host benchmark: %lu iterations per function (simulated BMP390, DHT11, SSD1306 and broker)\n",
+           (unsigned long)iterations);
+    printf("%-18s %7s %9s %9s %12s %11s %12s %14s\n", "function", "calls", "avg us", "max us",
+           "allocs/call", "I2C B/call", "MQTT B/call", "Serial B/call");
+    bool ok = true;
+    for (const BenchResult &r : results) {
+        double calls = r.calls ? r.calls : 1;
+        printf("%-18s %7lu %9.2f %9.2f %12.2f %11.1f %12.1f %14.1f\n", r.name, (unsigned long)r.calls,
+               r.totalMicros / calls, r.maxMicros, r.allocations / calls, r.i2cBytes / calls,
+               r.mqttBytes / calls, r.serialBytes / calls);
+        if (r.allocations > 0) {
+            fprintf(stderr, "bench: %s allocated %llu times\n", r.name, (unsigned long long)r.allocations);
+            ok = false;
+        }
+    }
+
+    // Each device must have been exercised, or the simulation is not wired up
+    if (results[0].i2cBytes == 0 || results[2].i2cBytes == 0 || results[3].mqttBytes == 0 ||
+        results[4].serialBytes == 0) {
+        fprintf(stderr, "bench: a benchmarked function produced no traffic\n");
+        ok = false;
+    }
+    if (simDHT11.answers() == 0) {
+        fprintf(stderr, "bench: the DHT11 was never read\n");
+        ok = false;
+    }
+    ok &= runKernels(iterations);
+    return check && !ok ? 1 : 0;
+}
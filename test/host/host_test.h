@@ -0,0 +1,56 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+/*
+ * Minimal checks for the host tests: a failed check prints its location
+ * and the test goes on; main() returns hostTestResult().
+ */
+
+inline int hostTestFailures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            hostTestFailures++;                                                       \
+        }                                                                             \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                          \
+    do {                                                                                 \
+        double a_ = (actual), e_ = (expected);                                           \
+        if (!(fabs(a_ - e_) <= (tolerance))) {                                           \
+            fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %g, expected %g\n", __FILE__, \
+                    __LINE__, #actual, a_, e_);                                          \
+            hostTestFailures++;                                                          \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_STR(actual, expected)                                                          \
+    do {                                                                                     \
+        const char *a_ = (actual), *e_ = (expected);                                         \
+        if (strcmp(a_, e_) != 0) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK_STR failed: %s = \"%s\", expected \"%s\"\n",       \
+                    __FILE__, __LINE__, #actual, a_, e_);                                    \
+            hostTestFailures++;                                                              \
+        }                                                                                    \
+    } while (0)
+
+/**
+ * Prints the outcome of a test program
+ * @return Exit code for main()
+ */
+inline int hostTestResult(const char *name) {
+    if (hostTestFailures == 0) {
+        printf("%s: all checks passed\n", name);
+        return 0;
+    }
+    printf("%s: %d checks failed\n", name, hostTestFailures);
+    return 1;
+}
+
+#endif // HOST_TEST_H
@@ -0,0 +1,60 @@
+#ifndef HOST_ADAFRUIT_BMP3XX_H
+#define HOST_ADAFRUIT_BMP3XX_H
+
+#include <Adafruit_Sensor.h>
+#include <Wire.h>
+
+#define BMP3XX_DEFAULT_ADDRESS 0x77
+
+#define BMP3_NO_OVERSAMPLING 0
+#define BMP3_OVERSAMPLING_2X 1
+#define BMP3_OVERSAMPLING_4X 2
+#define BMP3_OVERSAMPLING_8X 3
+#define BMP3_OVERSAMPLING_16X 4
+#define BMP3_OVERSAMPLING_32X 5
+
+#define BMP3_IIR_FILTER_DISABLE 0
+#define BMP3_IIR_FILTER_COEFF_1 1
+#define BMP3_IIR_FILTER_COEFF_3 2
+#define BMP3_IIR_FILTER_COEFF_7 3
+#define BMP3_IIR_FILTER_COEFF_15 4
+#define BMP3_IIR_FILTER_COEFF_31 5
+#define BMP3_IIR_FILTER_COEFF_63 6
+#define BMP3_IIR_FILTER_COEFF_127 7
+
+#define BMP3_ODR_200_HZ 0x00
+#define BMP3_ODR_100_HZ 0x01
+#define BMP3_ODR_50_HZ 0x02
+#define BMP3_ODR_25_HZ 0x03
+
+/*
+ * Host stand-in for Adafruit_BMP3XX over I2C. begin_I2C() identifies and
+ * soft-resets the chip and reads its calibration; performReading() runs a
+ * forced measurement and compensates it, all as register transactions on
+ * Wire, so a sensor model attached to the bus sees the library's traffic.
+ */
+class Adafruit_BMP3XX {
+public:
+    bool begin_I2C(uint8_t address = BMP3XX_DEFAULT_ADDRESS, TwoWire *wire = &Wire);
+    bool setTemperatureOversampling(uint8_t os);
+    bool setPressureOversampling(uint8_t os);
+    bool setIIRFilterCoeff(uint8_t fs);
+    bool setOutputDataRate(uint8_t odr);
+    bool performReading();
+    float readTemperature();
+    float readPressure();
+
+    double temperature = 0;   // °C
+    double pressure = 0;      // Pa
+
+private:
+    bool writeRegister(uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t reg, uint8_t *data, size_t len);
+
+    TwoWire *wire = &Wire;
+    uint8_t address = BMP3XX_DEFAULT_ADDRESS;
+    uint8_t osrT = 0, osrP = 0, iir = 0, odr = 0;
+    double t1, t2, t3, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11;
+};
+
+#endif // HOST_ADAFRUIT_BMP3XX_H
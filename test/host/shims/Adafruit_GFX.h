@@ -0,0 +1,48 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+/*
+ * Host stand-in for Adafruit_GFX: cursor, rotation and text output into a
+ * subclass's drawPixel(). Characters are drawn in the classic 6x8 cell;
+ * the glyph bitmaps are a deterministic pattern per character rather
+ * than the library font, which keeps frame sizes and dirty regions
+ * realistic without carrying the font table.
+ */
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h);
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    void setRotation(uint8_t r);
+    uint8_t getRotation() const { return rotation; }
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void setTextSize(uint8_t s) { textSize = s > 0 ? s : 1; }
+    void setTextColor(uint16_t c) { textColor = c; textBackground = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { textColor = c; textBackground = bg; }
+    void setTextWrap(bool w) { wrap = w; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+    int16_t getCursorX() const { return cursorX; }
+    int16_t getCursorY() const { return cursorY; }
+
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+protected:
+    const int16_t WIDTH;
+    const int16_t HEIGHT;
+    int16_t _width;
+    int16_t _height;
+    int16_t cursorX = 0;
+    int16_t cursorY = 0;
+    uint16_t textColor = 0xFFFF;
+    uint16_t textBackground = 0xFFFF;
+    uint8_t textSize = 1;
+    uint8_t rotation = 0;
+    bool wrap = true;
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
@@ -0,0 +1,7 @@
+#ifndef HOST_ADAFRUIT_SENSOR_H
+#define HOST_ADAFRUIT_SENSOR_H
+
+// Unified sensor base of the Adafruit drivers; nothing of it is used here
+#include <Arduino.h>
+
+#endif // HOST_ADAFRUIT_SENSOR_H
@@ -0,0 +1,48 @@
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <WiFi.h>
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_MAX_PACKET_SIZE 256
+
+/*
+ * Host stand-in for PubSubClient. Publishes are checked against the packet
+ * buffer like the library does and counted instead of sent; a listener
+ * (host_hal.h) can inspect each message. Nothing here allocates except
+ * setBufferSize(), as in the library.
+ */
+class PubSubClient {
+public:
+    explicit PubSubClient(WiFiClient &client) : net(&client) {}
+    ~PubSubClient();
+
+    PubSubClient &setServer(const char *domain, uint16_t port);
+    PubSubClient &setServer(IPAddress ip, uint16_t port);
+    PubSubClient &setKeepAlive(uint16_t keepAlive) { (void)keepAlive; return *this; }
+    PubSubClient &setSocketTimeout(uint16_t timeout) { (void)timeout; return *this; }
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize() { return bufferSize; }
+
+    bool connect(const char *id, const char *user = nullptr, const char *pass = nullptr);
+    void disconnect();
+    bool connected();
+    int state() { return currentState; }
+    bool loop();
+
+    bool publish(const char *topic, const char *payload, bool retained = false);
+    bool publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained = false);
+
+private:
+    WiFiClient *net;
+    uint8_t *buffer = nullptr;
+    uint16_t bufferSize = 0;
+    int currentState = MQTT_DISCONNECTED;
+};
+
+#endif // HOST_PUBSUBCLIENT_H
@@ -0,0 +1,74 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+class IPAddress {
+public:
+    IPAddress() : bytes{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+    uint8_t operator[](int index) const { return bytes[index]; }
+    uint8_t &operator[](int index) { return bytes[index]; }
+
+private:
+    uint8_t bytes[4];
+};
+
+/*
+ * Host stand-in for the ESP32 WiFi station. The link is up once begin()
+ * was called and hostWiFiUp() allows it; see host_hal.h.
+ */
+class WiFiClass {
+public:
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet,
+                IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    wl_status_t status();
+    bool mode(wifi_mode_t mode) { (void)mode; return true; }
+    void persistent(bool persistent) { (void)persistent; }
+    bool setSleep(bool enabled) { (void)enabled; return true; }
+    uint8_t *BSSID();
+    int32_t channel() { return 6; }
+    int8_t RSSI() { return status() == WL_CONNECTED ? -60 : 0; }
+    IPAddress localIP();
+    int hostByName(const char *host, IPAddress &address);
+
+private:
+    bool started = false;
+    uint8_t bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+};
+
+extern WiFiClass WiFi;
+
+// TCP client; connects when the link is up and hostBrokerUp() allows it
+class WiFiClient {
+public:
+    int connect(const char *host, uint16_t port, int32_t timeoutMs = 3000);
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs = 3000);
+    void stop() { open = false; }
+    uint8_t connected();
+
+private:
+    bool open = false;
+};
+
+#endif // HOST_WIFI_H
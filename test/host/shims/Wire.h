@@ -0,0 +1,66 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+#define I2C_BUFFER_LENGTH 128  // Same transmit/receive buffer as the ESP32 core
+
+/*
+ * A device model on the simulated bus. write() receives the bytes of one
+ * write transaction (register address first), read() fills a read
+ * transaction. Return false to NACK.
+ */
+class HostI2CDevice {
+public:
+    virtual ~HostI2CDevice() {}
+    virtual bool write(const uint8_t *data, size_t len) = 0;
+    virtual bool read(uint8_t *data, size_t len) = 0;
+};
+
+// Bus counters, for benchmarks and tests
+struct HostI2CStats {
+    uint32_t transactions;    // Address phases (writes and reads)
+    uint32_t nacks;           // Transactions to an absent device
+    uint64_t bytesWritten;    // Data bytes written, address bytes excluded
+    uint64_t bytesRead;       // Data bytes read
+    uint64_t busMicros;       // Estimated bus time at the configured clock
+};
+
+void hostI2CAttach(uint8_t address, HostI2CDevice *device);  // NULL detaches
+void hostI2CStats(HostI2CStats &out);
+
+// Host stand-in for the ESP32 core's TwoWire: transactions are delivered
+// to the attached device models
+class TwoWire : public Stream {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end() { return true; }
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() { return clockHz; }
+
+    void beginTransmission(uint16_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t requestFrom(uint16_t address, size_t quantity, bool sendStop = true);
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *data, size_t quantity) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override {}
+
+private:
+    uint32_t clockHz = 100000;
+    uint16_t txAddress = 0;
+    uint8_t txBuffer[I2C_BUFFER_LENGTH];
+    size_t txLength = 0;
+    bool txActive = false;
+    uint8_t rxBuffer[I2C_BUFFER_LENGTH];
+    size_t rxLength = 0;
+    size_t rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,518 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+/*
+ * Clock, pins, Serial, random numbers and chip information of the host
+ * stand-in for the ESP32 Arduino core.
+ */
+
+// ---- Clock ----
+
+static std::atomic<bool> clockManual(false);
+static std::atomic<uint64_t> manualMicros(0);
+static const std::chrono::steady_clock::time_point clockStart = std::chrono::steady_clock::now();
+static thread_local int64_t isrMicros = -1;  // micros() inside a simulated interrupt
+
+static uint64_t realMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - clockStart).count();
+}
+
+uint64_t hostClockMicros() {
+    if (isrMicros >= 0) return (uint64_t)isrMicros;
+    return clockManual ? manualMicros.load() : realMicros();
+}
+
+void hostClockManual(bool manual) {
+    if (manual && !clockManual) manualMicros = realMicros();  // Continue from the current time
+    clockManual = manual;
+}
+
+bool hostClockIsManual() {
+    return clockManual;
+}
+
+void hostClockAdvanceMicros(uint64_t us) {
+    if (clockManual) {
+        manualMicros += us;
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void hostClockAdvanceMs(uint32_t ms) {
+    hostClockAdvanceMicros((uint64_t)ms * 1000);
+}
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(hostClockMicros() / 1000);  // 32-bit wrap, as on the device
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)hostClockMicros();
+}
+
+void delay(uint32_t ms) {
+    hostClockAdvanceMs(ms);
+}
+
+void delayMicroseconds(uint32_t us) {
+    hostClockAdvanceMicros(us);
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)hostClockMicros();
+}
+
+// ---- Wall clock ----
+
+static std::atomic<time_t> epochBase(0);
+static std::atomic<uint64_t> epochSetMicros(0);
+
+void hostSetEpoch(time_t epoch) {
+    epochSetMicros = hostClockMicros();
+    epochBase = epoch;
+}
+
+time_t time(time_t *out) noexcept {
+    time_t now;
+    if (epochBase == 0) {
+        now = (time_t)(hostClockMicros() / 1000000);  // Not synced: seconds since boot
+    } else {
+        now = epochBase + (time_t)((hostClockMicros() - epochSetMicros) / 1000000);
+    }
+    if (out) *out = now;
+    return now;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1,
+                const char *server2, const char *server3) {
+    (void)server1; (void)server2; (void)server3;
+    // Same TZ string as the ESP32 core builds
+    char cst[40];
+    char cdt[40] = "DST";
+    char tz[80];
+    if (gmtOffsetSec % 3600) {
+        snprintf(cst, sizeof(cst), "UTC%ld:%02u:%02u", gmtOffsetSec / 3600,
+                 (unsigned)abs((int)((gmtOffsetSec % 3600) / 60)), (unsigned)abs((int)(gmtOffsetSec % 60)));
+    } else {
+        snprintf(cst, sizeof(cst), "UTC%ld", gmtOffsetSec / 3600);
+    }
+    if (daylightOffsetSec != 3600) {
+        long tzDst = gmtOffsetSec + daylightOffsetSec;
+        if (tzDst % 3600) {
+            snprintf(cdt, sizeof(cdt), "DST%ld:%02u:%02u", tzDst / 3600,
+                     (unsigned)abs((int)((tzDst % 3600) / 60)), (unsigned)abs((int)(tzDst % 60)));
+        } else {
+            snprintf(cdt, sizeof(cdt), "DST%ld", tzDst / 3600);
+        }
+    }
+    snprintf(tz, sizeof(tz), "%s%s", cst, daylightOffsetSec ? cdt : "");
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+void configTzTime(const char *tz, const char *server1, const char *server2, const char *server3) {
+    (void)server1; (void)server2; (void)server3;
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+bool getLocalTime(struct tm *info, uint32_t ms) {
+    (void)ms;  // The host clock does not sync while waiting
+    time_t now = time(NULL);
+    localtime_r(&now, info);
+    return info->tm_year > (2016 - 1900);
+}
+
+// ---- Pins ----
+
+#define HOST_PIN_COUNT 40
+
+struct HostPin {
+    uint8_t mode;
+    uint8_t output;             // Level written with digitalWrite()
+    int8_t driven;              // Level driven from outside, -1 if none
+    uint8_t level;              // Current line level
+    void (*isr)();
+    int isrMode;
+    HostPinListener listener;
+};
+
+static HostPin pins[HOST_PIN_COUNT];
+static std::recursive_mutex &pinLock = *new std::recursive_mutex;
+
+/**
+ * Recomputes the line level and runs the interrupt on a matching edge
+ */
+static void updatePin(uint8_t pin, uint64_t atMicros) {
+    HostPin &p = pins[pin];
+    uint8_t level;
+    if (p.mode == OUTPUT) {
+        level = p.output;
+    } else if (p.driven >= 0) {
+        level = (uint8_t)p.driven;
+    } else {
+        level = (p.mode & PULLUP) ? HIGH : LOW;
+    }
+    if (level == p.level) return;
+    p.level = level;
+
+    bool fire = p.isr != nullptr &&
+                (p.isrMode == CHANGE || (p.isrMode == RISING && level == HIGH) ||
+                 (p.isrMode == FALLING && level == LOW) || (p.isrMode == ONLOW && level == LOW) ||
+                 (p.isrMode == ONHIGH && level == HIGH));
+    if (fire) {
+        int64_t saved = isrMicros;
+        isrMicros = (int64_t)atMicros;
+        p.isr();
+        isrMicros = saved;
+    }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= HOST_PIN_COUNT) return;
+    HostPinListener listener;
+    {
+        std::lock_guard<std::recursive_mutex> lock(pinLock);
+        pins[pin].mode = mode;
+        updatePin(pin, hostClockMicros());
+        listener = pins[pin].listener;
+    }
+    if (listener) listener(pin, mode, pins[pin].level);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin >= HOST_PIN_COUNT) return;
+    HostPinListener listener;
+    {
+        std::lock_guard<std::recursive_mutex> lock(pinLock);
+        pins[pin].output = level ? HIGH : LOW;
+        updatePin(pin, hostClockMicros());
+        listener = pins[pin].listener;
+    }
+    if (listener) listener(pin, pins[pin].mode, pins[pin].level);
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= HOST_PIN_COUNT) return LOW;
+    std::lock_guard<std::recursive_mutex> lock(pinLock);
+    return pins[pin].level;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    if (pin >= HOST_PIN_COUNT) return;
+    std::lock_guard<std::recursive_mutex> lock(pinLock);
+    pins[pin].isr = handler;
+    pins[pin].isrMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin >= HOST_PIN_COUNT) return;
+    std::lock_guard<std::recursive_mutex> lock(pinLock);
+    pins[pin].isr = nullptr;
+}
+
+void hostPinListener(uint8_t pin, HostPinListener listener) {
+    if (pin >= HOST_PIN_COUNT) return;
+    std::lock_guard<std::recursive_mutex> lock(pinLock);
+    pins[pin].listener = listener;
+}
+
+void hostGpioEdge(uint8_t pin, uint8_t level, uint64_t atMicros) {
+    if (pin >= HOST_PIN_COUNT) return;
+    std::lock_guard<std::recursive_mutex> lock(pinLock);
+    pins[pin].driven = level ? HIGH : LOW;
+    updatePin(pin, atMicros);
+}
+
+uint8_t hostPinMode(uint8_t pin) {
+    return pin < HOST_PIN_COUNT ? pins[pin].mode : 0;
+}
+
+/**
+ * Lines float until a pin mode is set; nothing drives them from outside
+ */
+static bool initPins() {
+    for (int i = 0; i < HOST_PIN_COUNT; i++) {
+        pins[i].driven = -1;
+    }
+    return true;
+}
+static bool pinsReady __attribute__((unused)) = initPins();
+
+// ---- Print and Stream ----
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) break;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * Formats into a 64-byte stack buffer and falls back to the heap for
+ * longer output, as the ESP32 core does
+ */
+size_t Print::printf(const char *format, ...) {
+    char loc[64];
+    char *temp = loc;
+    va_list arg;
+    va_start(arg, format);
+    va_list copy;
+    va_copy(copy, arg);
+    int len = vsnprintf(temp, sizeof(loc), format, copy);
+    va_end(copy);
+    if (len < 0) {
+        va_end(arg);
+        return 0;
+    }
+    if (len >= (int)sizeof(loc)) {
+        temp = (char *)malloc(len + 1);
+        if (temp == nullptr) {
+            va_end(arg);
+            return 0;
+        }
+        vsnprintf(temp, len + 1, format, arg);
+    }
+    va_end(arg);
+    len = write((const uint8_t *)temp, len);
+    if (temp != loc) free(temp);
+    return len;
+}
+
+size_t Print::print(long value, int base) {
+    char buf[72];
+    if (base == 16) {
+        snprintf(buf, sizeof(buf), "%lx", (unsigned long)value);
+    } else if (base == 2) {
+        unsigned long v = (unsigned long)value;
+        int i = 0;
+        char bits[65];
+        do {
+            bits[i++] = '0' + (v & 1);
+            v >>= 1;
+        } while (v);
+        for (int j = 0; j < i; j++) buf[j] = bits[i - 1 - j];
+        buf[i] = '\0';
+    } else {
+        snprintf(buf, sizeof(buf), "%ld", value);
+    }
+    return write(buf);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == 16 ? "%lx" : "%lu", value);
+    return write(buf);
+}
+
+size_t Print::print(double value, int digits) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, value);
+    return write(buf);
+}
+
+int Stream::timedRead() {
+    int c = read();
+    if (c >= 0 || timeout == 0) return c;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        c = read();
+        if (c >= 0) return c;
+    }
+    return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0 || c == terminator) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+// ---- Serial ----
+
+HardwareSerial Serial;
+
+static FILE *serialOut = nullptr;
+static bool serialOutSet = false;
+static FILE *serialIn = nullptr;
+static std::atomic<uint64_t> serialBytes(0);
+static std::mutex &serialLock = *new std::mutex;
+
+void hostSerialOutput(FILE *out) {
+    serialOut = out;
+    serialOutSet = true;
+}
+
+void hostSerialInput(FILE *in) {
+    serialIn = in;
+}
+
+uint64_t hostSerialBytes() {
+    return serialBytes;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    serialBytes += size;
+    FILE *out = serialOutSet ? serialOut : stdout;
+    if (out) {
+        std::lock_guard<std::mutex> lock(serialLock);
+        fwrite(buffer, 1, size, out);
+    }
+    return size;
+}
+
+int HardwareSerial::available() {
+    return peek() >= 0 ? 1 : 0;
+}
+
+int HardwareSerial::read() {
+    if (!serialIn) return -1;
+    int c = fgetc(serialIn);
+    return c == EOF ? -1 : c;
+}
+
+int HardwareSerial::peek() {
+    if (!serialIn) return -1;
+    int c = fgetc(serialIn);
+    if (c == EOF) return -1;
+    ungetc(c, serialIn);
+    return c;
+}
+
+void HardwareSerial::flush() {
+    FILE *out = serialOutSet ? serialOut : stdout;
+    if (out) fflush(out);
+}
+
+// ---- Random numbers ----
+
+static std::atomic<uint32_t> randomState(0x12345678);
+
+uint32_t esp_random() {
+    // xorshift32; fixed seed so host runs repeat
+    uint32_t x = randomState.load();
+    uint32_t next;
+    do {
+        next = x;
+        next ^= next << 13;
+        next ^= next >> 17;
+        next ^= next << 5;
+    } while (!randomState.compare_exchange_weak(x, next));
+    return next;
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) randomState = (uint32_t)seed;
+}
+
+long random(long howBig) {
+    if (howBig <= 0) return 0;
+    return (long)(esp_random() % (uint32_t)howBig);
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return howSmall + random(howBig - howSmall);
+}
+
+// ---- Chip ----
+
+EspClass ESP;
+
+#define HOST_HEAP_BYTES (320 * 1024)  // Internal RAM heap of a typical ESP32 build
+
+static int64_t heapBaseline = -1;
+static int64_t minFreeHeap = HOST_HEAP_BYTES;
+
+/**
+ * Free heap: the device heap size minus what the host process allocated
+ * since the first query
+ */
+uint32_t EspClass::getFreeHeap() {
+    HostHeapStats heap;
+    hostHeapStats(heap);
+    if (heapBaseline < 0) heapBaseline = heap.liveBytes;
+    int64_t used = heap.liveBytes - heapBaseline;
+    int64_t freeBytes = HOST_HEAP_BYTES - (used > 0 ? used : 0);
+    if (freeBytes < 0) freeBytes = 0;
+    if (freeBytes < minFreeHeap) minFreeHeap = freeBytes;
+    return (uint32_t)freeBytes;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    getFreeHeap();
+    return (uint32_t)minFreeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap() / 2;
+}
+
+uint32_t EspClass::getHeapSize() {
+    return HOST_HEAP_BYTES;
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(realMicros() * 240);  // 240 MHz, real time even with the manual clock
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return 240;
+}
+
+// ---- Sleep ----
+
+static uint64_t sleepTimerMicros = 0;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+    sleepTimerMicros = us;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+    hostClockAdvanceMicros(sleepTimerMicros);
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    throw HostDeepSleep{sleepTimerMicros};
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return ESP_SLEEP_WAKEUP_UNDEFINED;
+}
@@ -0,0 +1,136 @@
+#include <Adafruit_BMP3XX.h>
+
+/*
+ * Adafruit_BMP3XX over register transactions: identify, soft reset and
+ * read the trimming coefficients on begin, then one forced conversion per
+ * performReading(), compensated in double precision like the Bosch API
+ */
+
+#define BMP3_REG_CHIP_ID 0x00
+#define BMP3_REG_STATUS 0x03
+#define BMP3_REG_DATA 0x04
+#define BMP3_REG_PWR_CTRL 0x1B
+#define BMP3_REG_OSR 0x1C
+#define BMP3_REG_ODR 0x1D
+#define BMP3_REG_CONFIG 0x1F
+#define BMP3_REG_CALIB 0x31
+#define BMP3_REG_CMD 0x7E
+
+#define BMP3_CHIP_ID_388 0x50
+#define BMP3_CHIP_ID_390 0x60
+#define BMP3_CMD_SOFT_RESET 0xB6
+#define BMP3_FORCED_PRESS_TEMP 0x13
+#define BMP3_STATUS_DRDY (0x20 | 0x40)
+
+bool Adafruit_BMP3XX::writeRegister(uint8_t reg, uint8_t value) {
+    wire->beginTransmission(address);
+    wire->write(reg);
+    wire->write(value);
+    return wire->endTransmission() == 0;
+}
+
+bool Adafruit_BMP3XX::readRegisters(uint8_t reg, uint8_t *data, size_t len) {
+    wire->beginTransmission(address);
+    wire->write(reg);
+    if (wire->endTransmission(false) != 0) return false;
+    if (wire->requestFrom(address, len) != len) return false;
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)wire->read();
+    }
+    return true;
+}
+
+bool Adafruit_BMP3XX::begin_I2C(uint8_t addr, TwoWire *theWire) {
+    address = addr;
+    wire = theWire;
+
+    uint8_t id = 0;
+    if (!readRegisters(BMP3_REG_CHIP_ID, &id, 1)) return false;
+    if (id != BMP3_CHIP_ID_388 && id != BMP3_CHIP_ID_390) return false;
+    if (!writeRegister(BMP3_REG_CMD, BMP3_CMD_SOFT_RESET)) return false;
+    delay(2);
+
+    uint8_t nvm[21];
+    if (!readRegisters(BMP3_REG_CALIB, nvm, sizeof(nvm))) return false;
+    t1 = (uint16_t)(nvm[0] | (nvm[1] << 8)) / 0.00390625;
+    t2 = (uint16_t)(nvm[2] | (nvm[3] << 8)) / 1073741824.0;
+    t3 = (int8_t)nvm[4] / 281474976710656.0;
+    p1 = ((int16_t)(nvm[5] | (nvm[6] << 8)) - 16384) / 1048576.0;
+    p2 = ((int16_t)(nvm[7] | (nvm[8] << 8)) - 16384) / 536870912.0;
+    p3 = (int8_t)nvm[9] / 4294967296.0;
+    p4 = (int8_t)nvm[10] / 137438953472.0;
+    p5 = (uint16_t)(nvm[11] | (nvm[12] << 8)) / 0.125;
+    p6 = (uint16_t)(nvm[13] | (nvm[14] << 8)) / 64.0;
+    p7 = (int8_t)nvm[15] / 256.0;
+    p8 = (int8_t)nvm[16] / 32768.0;
+    p9 = (int16_t)(nvm[17] | (nvm[18] << 8)) / 281474976710656.0;
+    p10 = (int8_t)nvm[19] / 281474976710656.0;
+    p11 = (int8_t)nvm[20] / 36893488147419103232.0;
+    return true;
+}
+
+bool Adafruit_BMP3XX::setTemperatureOversampling(uint8_t os) {
+    if (os > BMP3_OVERSAMPLING_32X) return false;
+    osrT = os;
+    return true;
+}
+
+bool Adafruit_BMP3XX::setPressureOversampling(uint8_t os) {
+    if (os > BMP3_OVERSAMPLING_32X) return false;
+    osrP = os;
+    return true;
+}
+
+bool Adafruit_BMP3XX::setIIRFilterCoeff(uint8_t fs) {
+    if (fs > BMP3_IIR_FILTER_COEFF_127) return false;
+    iir = fs;
+    return true;
+}
+
+bool Adafruit_BMP3XX::setOutputDataRate(uint8_t rate) {
+    if (rate > 0x11) return false;
+    odr = rate;
+    return true;
+}
+
+/**
+ * Sends the stored settings, runs one forced conversion and compensates it
+ */
+bool Adafruit_BMP3XX::performReading() {
+    if (!writeRegister(BMP3_REG_OSR, (uint8_t)((osrT << 3) | osrP)) ||
+        !writeRegister(BMP3_REG_ODR, odr) ||
+        !writeRegister(BMP3_REG_CONFIG, (uint8_t)(iir << 1)) ||
+        !writeRegister(BMP3_REG_PWR_CTRL, BMP3_FORCED_PRESS_TEMP)) {
+        return false;
+    }
+
+    uint8_t status = 0;
+    for (int i = 0; i < 100; i++) {
+        if (!readRegisters(BMP3_REG_STATUS, &status, 1)) return false;
+        if ((status & BMP3_STATUS_DRDY) == BMP3_STATUS_DRDY) break;
+        delay(1);
+    }
+
+    uint8_t data[6];
+    if (!readRegisters(BMP3_REG_DATA, data, sizeof(data))) return false;
+    uint32_t rawP = data[0] | (data[1] << 8) | ((uint32_t)data[2] << 16);
+    uint32_t rawT = data[3] | (data[4] << 8) | ((uint32_t)data[5] << 16);
+
+    double d1 = rawT - t1;
+    double t = d1 * t2 + d1 * d1 * t3;
+    double up = rawP;
+    double out1 = p5 + p6 * t + p7 * t * t + p8 * t * t * t;
+    double out2 = up * (p1 + p2 * t + p3 * t * t + p4 * t * t * t);
+    double out3 = up * up * (p9 + p10 * t) + up * up * up * p11;
+    temperature = t;
+    pressure = out1 + out2 + out3;
+    return true;
+}
+
+float Adafruit_BMP3XX::readTemperature() {
+    return performReading() ? (float)temperature : NAN;
+}
+
+float Adafruit_BMP3XX::readPressure() {
+    return performReading() ? (float)pressure : NAN;
+}
@@ -0,0 +1,166 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+ * FreeRTOS on threads. Each task is a detached thread with a notification
+ * counter; the thread that calls setup() counts as the Arduino loop task.
+ * Task, mutex and lock objects are never freed, so detached tasks may
+ * still be blocked when the process exits.
+ */
+
+struct HostTask {
+    char name[16];
+    uint32_t stackDepth;
+    uint32_t notifications;
+    std::mutex lock;
+    std::condition_variable wake;
+};
+
+struct HostSemaphore {
+    std::mutex lock;
+    std::condition_variable released;
+    bool taken;
+};
+
+static thread_local HostTask *currentTask = nullptr;
+static std::recursive_mutex &criticalLock = *new std::recursive_mutex;
+
+void hostEnterCritical(portMUX_TYPE *mux) {
+    (void)mux;
+    criticalLock.lock();
+}
+
+void hostExitCritical(portMUX_TYPE *mux) {
+    (void)mux;
+    criticalLock.unlock();
+}
+
+static HostTask *newTask(const char *name, uint32_t stackDepth) {
+    HostTask *task = new HostTask();
+    strncpy(task->name, name, sizeof(task->name) - 1);
+    task->stackDepth = stackDepth;
+    task->notifications = 0;
+    return task;
+}
+
+/**
+ * Handle of the calling thread; threads not started by xTaskCreate() are
+ * the Arduino loop task
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (currentTask == nullptr) currentTask = newTask("loopTask", 8192);
+    return currentTask;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth,
+                                   void *parameter, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core) {
+    (void)priority;
+    (void)core;
+    HostTask *task = newTask(name, stackDepth);
+    if (handle) *handle = task;
+    std::thread([task, function, parameter]() {
+        currentTask = task;
+        function(parameter);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth,
+                       void *parameter, UBaseType_t priority, TaskHandle_t *handle) {
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+/**
+ * Deleting the calling task parks its thread for good; other tasks cannot
+ * be stopped from outside
+ */
+void vTaskDelete(TaskHandle_t task) {
+    if (task != nullptr && task != xTaskGetCurrentTaskHandle()) return;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    hostClockAdvanceMs(ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
+
+char *pcTaskGetName(TaskHandle_t task) {
+    if (task == nullptr) task = xTaskGetCurrentTaskHandle();
+    return task->name;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    if (task == nullptr) task = xTaskGetCurrentTaskHandle();
+    return task->stackDepth;  // Stack use is not measured on the host
+}
+
+/**
+ * Waits for a notification. With the manual clock a finite wait returns
+ * at once and advances the clock by the timeout instead of sleeping.
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    HostTask *task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->lock);
+    if (task->notifications == 0 && ticks != 0) {
+        if (ticks == portMAX_DELAY) {
+            task->wake.wait(lock, [task]() { return task->notifications > 0; });
+        } else if (hostClockIsManual()) {
+            lock.unlock();
+            hostClockAdvanceMs(ticks);  // The timeout passes in virtual time
+            lock.lock();
+        } else {
+            task->wake.wait_for(lock, std::chrono::milliseconds(ticks),
+                                [task]() { return task->notifications > 0; });
+        }
+    }
+    uint32_t count = task->notifications;
+    if (count > 0) task->notifications = clearOnExit ? 0 : count - 1;
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->lock);
+        task->notifications++;
+    }
+    task->wake.notify_one();
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    HostSemaphore *semaphore = new HostSemaphore();
+    semaphore->taken = false;
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(semaphore->lock);
+    auto free = [semaphore]() { return !semaphore->taken; };
+    if (ticks == portMAX_DELAY) {
+        semaphore->released.wait(lock, free);
+    } else if (!semaphore->released.wait_for(lock, std::chrono::milliseconds(ticks), free)) {
+        return pdFALSE;
+    }
+    semaphore->taken = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    {
+        std::lock_guard<std::mutex> lock(semaphore->lock);
+        if (!semaphore->taken) return pdFALSE;
+        semaphore->taken = false;
+    }
+    semaphore->released.notify_one();
+    return pdTRUE;
+}
@@ -0,0 +1,207 @@
+#include <LittleFS.h>
+#include "host_hal.h"
+#include <dirent.h>
+#include <errno.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * LittleFS on a host directory. Files are stdio streams; a directory
+ * handle lists its entries for openNextFile().
+ */
+
+fs::LittleFSFS LittleFS;
+
+static std::string fsRoot;
+
+void hostFsRoot(const char *dir) {
+    fsRoot = dir;
+    ::mkdir(dir, 0755);
+}
+
+const char *hostFsRootPath() {
+    if (fsRoot.empty()) {
+        char templ[] = "/tmp/weather-fs-XXXXXX";
+        fsRoot = mkdtemp(templ) ? templ : "/tmp";
+    }
+    return fsRoot.c_str();
+}
+
+static std::string hostPath(const char *path) {
+    std::string full = hostFsRootPath();
+    if (path[0] != '/') full += '/';
+    return full + path;
+}
+
+namespace fs {
+
+struct FileImpl {
+    FILE *file = nullptr;
+    DIR *dir = nullptr;
+    std::string path;       // Path as the firmware sees it
+    std::string hostPath;
+
+    ~FileImpl() {
+        if (file) fclose(file);
+        if (dir) closedir(dir);
+    }
+};
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    if (!impl || !impl->file) return 0;
+    return fwrite(buffer, 1, size, impl->file);
+}
+
+int File::available() {
+    if (!impl || !impl->file) return 0;
+    long pos = ftell(impl->file);
+    return pos < (long)size() ? (int)(size() - pos) : 0;
+}
+
+int File::read() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    if (c == EOF) return -1;
+    ungetc(c, impl->file);
+    return c;
+}
+
+void File::flush() {
+    if (impl && impl->file) fflush(impl->file);
+}
+
+size_t File::read(uint8_t *buffer, size_t count) {
+    if (!impl || !impl->file) return 0;
+    return fread(buffer, 1, count, impl->file);
+}
+
+bool File::seek(uint32_t pos) {
+    return impl && impl->file && fseek(impl->file, pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+    return impl && impl->file ? (size_t)ftell(impl->file) : 0;
+}
+
+size_t File::size() const {
+    if (!impl || !impl->file) return 0;
+    fflush(impl->file);
+    struct stat st;
+    return fstat(fileno(impl->file), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+    impl.reset();
+}
+
+File::operator bool() const {
+    return impl && (impl->file || impl->dir);
+}
+
+const char *File::path() const {
+    return impl ? impl->path.c_str() : nullptr;
+}
+
+/**
+ * Last path component, as the ESP32 core's LittleFS returns it
+ */
+const char *File::name() const {
+    if (!impl) return nullptr;
+    const char *slash = strrchr(impl->path.c_str(), '/');
+    return slash ? slash + 1 : impl->path.c_str();
+}
+
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+
+File File::openNextFile(const char *mode) {
+    if (!impl || !impl->dir) return File();
+    while (struct dirent *entry = readdir(impl->dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        std::string path = impl->path;
+        if (path.empty() || path.back() != '/') path += '/';
+        return LittleFS.open((path + entry->d_name).c_str(), mode);
+    }
+    return File();
+}
+
+File FS::open(const char *path, const char *mode, bool create) {
+    (void)create;
+    auto impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    impl->hostPath = hostPath(path);
+
+    struct stat st;
+    if (stat(impl->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(impl->hostPath.c_str());
+    } else {
+        // "a" on LittleFS can also read; "w" truncates
+        const char *hostMode = strcmp(mode, FILE_APPEND) == 0 ? "a+b" : strcmp(mode, FILE_WRITE) == 0 ? "w+b" : "rb";
+        impl->file = fopen(impl->hostPath.c_str(), hostMode);
+    }
+    return impl->file || impl->dir ? File(impl) : File();
+}
+
+bool FS::exists(const char *path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path) {
+    return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *pathFrom, const char *pathTo) {
+    return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char *path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char *basePath, uint8_t maxOpenFiles, const char *partitionLabel) {
+    (void)formatOnFail; (void)basePath; (void)maxOpenFiles; (void)partitionLabel;
+    struct stat st;
+    return stat(hostFsRootPath(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/**
+ * Removes every file below the root
+ */
+bool LittleFSFS::format() {
+    std::string command = "rm -rf '";
+    command += hostFsRootPath();
+    command += "'/*";
+    return system(command.c_str()) == 0;
+}
+
+size_t LittleFSFS::usedBytes() {
+    return 0;
+}
+
+} // namespace fs
+
+File hostFileOpen(const char *path, const char *mode) {
+    auto impl = std::make_shared<fs::FileImpl>();
+    impl->path = path;
+    impl->hostPath = path;
+    const char *hostMode = strcmp(mode, FILE_APPEND) == 0 ? "a+b" : strcmp(mode, FILE_WRITE) == 0 ? "w+b" : "rb";
+    impl->file = fopen(path, hostMode);
+    return impl->file ? File(impl) : File();
+}
@@ -0,0 +1,88 @@
+#include "host_hal.h"
+#include <atomic>
+#include <malloc.h>
+
+/*
+ * Counts every heap allocation of the process by wrapping the C library
+ * allocator; operator new goes through malloc() as well. The benchmark
+ * runner reports allocations per call from the per-thread counter.
+ */
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<uint64_t> allocations(0);
+static std::atomic<uint64_t> frees(0);
+static std::atomic<int64_t> liveBytes(0);
+static __thread uint64_t threadAllocations;
+
+static void *counted(void *ptr) {
+    if (ptr) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+        threadAllocations++;
+    }
+    return ptr;
+}
+
+static void uncount(void *ptr) {
+    if (ptr) {
+        frees.fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+}
+
+extern "C" {
+
+void *malloc(size_t size) {
+    return counted(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size) {
+    return counted(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, size_t size) {
+    uncount(ptr);
+    void *result = __libc_realloc(ptr, size);
+    if (result) return counted(result);
+    if (ptr && size != 0) counted(ptr);  // Failed: the old block is still allocated
+    return nullptr;
+}
+
+void *memalign(size_t alignment, size_t size) {
+    return counted(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return counted(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    void *ptr = counted(__libc_memalign(alignment, size));
+    if (!ptr) return 12;  // ENOMEM
+    *out = ptr;
+    return 0;
+}
+
+void free(void *ptr) {
+    uncount(ptr);
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+void hostHeapStats(HostHeapStats &out) {
+    out.allocations = allocations.load();
+    out.frees = frees.load();
+    out.liveBytes = liveBytes.load();
+}
+
+uint64_t hostThreadAllocations() {
+    return threadAllocations;
+}
@@ -0,0 +1,68 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+/*
+ * Controls of the host stand-ins, for tests and the benchmark runner.
+ * None of this exists on the device.
+ */
+
+#include <Arduino.h>
+#include <FS.h>
+#include <Wire.h>
+
+// Clock: real time by default. In manual mode millis()/micros() only move
+// through hostClockAdvance*(), delay() and vTaskDelay(), so runs repeat exactly.
+void hostClockManual(bool manual);
+bool hostClockIsManual();
+void hostClockAdvanceMicros(uint64_t us);
+void hostClockAdvanceMs(uint32_t ms);
+uint64_t hostClockMicros();
+
+// Wall clock: time() returns epoch plus the time since this call; 0 means
+// SNTP has not synced yet and time() counts from 1970 at boot
+void hostSetEpoch(time_t epoch);
+
+// Pins: a listener sees every pinMode()/digitalWrite() on its pin; an edge
+// drives the line and runs an attached interrupt with micros() = atMicros
+typedef void (*HostPinListener)(uint8_t pin, uint8_t mode, uint8_t level);
+void hostPinListener(uint8_t pin, HostPinListener listener);
+void hostGpioEdge(uint8_t pin, uint8_t level, uint64_t atMicros);
+uint8_t hostPinMode(uint8_t pin);
+
+// Serial: output goes to stdout unless redirected (NULL mutes it); input
+// comes from a host file
+void hostSerialOutput(FILE *out);
+void hostSerialInput(FILE *in);
+uint64_t hostSerialBytes();
+
+// Heap: every malloc/new in the process is counted
+struct HostHeapStats {
+    uint64_t allocations;     // Blocks allocated since start
+    uint64_t frees;           // Blocks freed
+    int64_t liveBytes;        // Bytes currently allocated
+};
+void hostHeapStats(HostHeapStats &out);
+uint64_t hostThreadAllocations();  // Blocks allocated by the calling thread
+
+// Network: whether the access point and the MQTT broker are reachable
+void hostWiFiUp(bool up);
+void hostBrokerUp(bool up);
+
+// MQTT: counters of the PubSubClient stand-in and an optional listener
+struct HostMqttStats {
+    uint32_t publishes;       // Messages accepted
+    uint32_t rejected;        // Publishes refused (disconnected or larger than the buffer)
+    uint64_t bytes;           // Topic and payload bytes accepted
+    uint32_t lookups;         // WiFi.hostByName() calls
+};
+typedef void (*HostPublishListener)(const char *topic, const uint8_t *payload, size_t length, bool retained);
+void hostMqttStats(HostMqttStats &out);
+void hostMqttListener(HostPublishListener listener);
+
+// Filesystem: LittleFS paths live below this host directory (a fresh
+// temporary directory by default)
+void hostFsRoot(const char *dir);
+const char *hostFsRootPath();
+File hostFileOpen(const char *hostPath, const char *mode);  // Any host file as an fs::File
+
+#endif // HOST_HAL_H
@@ -0,0 +1,2 @@
+// Resolves the firmware's "include/secrets.h" to the host placeholders
+#include "../secrets.h"
@@ -0,0 +1,160 @@
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "host_hal.h"
+#include <atomic>
+
+/*
+ * Wi-Fi station, TCP client and MQTT client stand-ins. Reachability is set
+ * by the test; publishes are counted and shown to an optional listener.
+ */
+
+WiFiClass WiFi;
+
+static std::atomic<bool> wifiUp(true);
+static std::atomic<bool> brokerUp(true);
+static HostMqttStats mqttStats;
+static HostPublishListener publishListener = nullptr;
+
+void hostWiFiUp(bool up) {
+    wifiUp = up;
+}
+
+void hostBrokerUp(bool up) {
+    brokerUp = up;
+}
+
+void hostMqttStats(HostMqttStats &out) {
+    out = mqttStats;
+}
+
+void hostMqttListener(HostPublishListener listener) {
+    publishListener = listener;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase, int32_t channel,
+                             const uint8_t *bssidIn, bool connect) {
+    (void)ssid; (void)passphrase; (void)channel; (void)bssidIn;
+    started = connect;
+    return status();
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    (void)localIP; (void)gateway; (void)subnet; (void)dns1; (void)dns2;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    (void)wifiOff;
+    (void)eraseAp;
+    started = false;
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    if (!started) return WL_DISCONNECTED;
+    return wifiUp ? WL_CONNECTED : WL_NO_SSID_AVAIL;
+}
+
+uint8_t *WiFiClass::BSSID() {
+    return bssid;
+}
+
+IPAddress WiFiClass::localIP() {
+    return status() == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+/**
+ * Resolves every name to the loopback address while the link is up
+ */
+int WiFiClass::hostByName(const char *host, IPAddress &address) {
+    (void)host;
+    mqttStats.lookups++;
+    if (status() != WL_CONNECTED) return 0;
+    address = IPAddress(127, 0, 0, 1);
+    return 1;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeoutMs) {
+    (void)host;
+    return connect(IPAddress(), port, timeoutMs);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    (void)ip; (void)port; (void)timeoutMs;
+    open = WiFi.status() == WL_CONNECTED && brokerUp;
+    return open ? 1 : 0;
+}
+
+uint8_t WiFiClient::connected() {
+    if (open && (WiFi.status() != WL_CONNECTED || !brokerUp)) open = false;
+    return open ? 1 : 0;
+}
+
+PubSubClient::~PubSubClient() {
+    free(buffer);
+}
+
+PubSubClient &PubSubClient::setServer(const char *domain, uint16_t port) {
+    (void)domain;
+    (void)port;
+    if (buffer == nullptr) setBufferSize(MQTT_MAX_PACKET_SIZE);
+    return *this;
+}
+
+PubSubClient &PubSubClient::setServer(IPAddress ip, uint16_t port) {
+    (void)ip;
+    return setServer((const char *)nullptr, port);
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) return false;
+    uint8_t *resized = (uint8_t *)realloc(buffer, size);
+    if (resized == nullptr) return false;
+    buffer = resized;
+    bufferSize = size;
+    return true;
+}
+
+bool PubSubClient::connect(const char *id, const char *user, const char *pass) {
+    (void)id; (void)user; (void)pass;
+    if (!net->connected() && !net->connect(nullptr, 0)) {
+        currentState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    currentState = MQTT_CONNECTED;
+    return true;
+}
+
+void PubSubClient::disconnect() {
+    net->stop();
+    currentState = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::connected() {
+    if (currentState == MQTT_CONNECTED && !net->connected()) currentState = MQTT_CONNECTION_LOST;
+    return currentState == MQTT_CONNECTED;
+}
+
+bool PubSubClient::loop() {
+    return connected();
+}
+
+bool PubSubClient::publish(const char *topic, const char *payload, bool retained) {
+    return publish(topic, (const uint8_t *)payload, payload ? (unsigned int)strlen(payload) : 0, retained);
+}
+
+/**
+ * Accepts a message if connected and it fits the packet buffer
+ * (fixed header, topic length and topic, payload), as the library checks
+ */
+bool PubSubClient::publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained) {
+    size_t topicLength = strlen(topic);
+    if (!connected() || 5 + 2 + topicLength + length > bufferSize) {
+        mqttStats.rejected++;
+        return false;
+    }
+    mqttStats.publishes++;
+    mqttStats.bytes += topicLength + length;
+    if (publishListener) publishListener(topic, payload, length, retained);
+    return true;
+}
@@ -0,0 +1,11 @@
+#ifndef SECRETS_H
+#define SECRETS_H
+
+// Placeholder credentials for the host build; the firmware's own secrets.h is not tracked
+#define WIFI_SSID "host-ssid"
+#define WIFI_PASSWORD "host-password"
+#define MQTT_SERVER "127.0.0.1"
+#define MQTT_USER "host"
+#define MQTT_PASS "host"
+
+#endif // SECRETS_H
@@ -0,0 +1,165 @@
+#include <Adafruit_SSD1306.h>
+
+/*
+ * Adafruit_GFX text output and the Adafruit_SSD1306 I2C transport
+ */
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+    rotation = r & 3;
+    _width = (rotation & 1) ? HEIGHT : WIDTH;
+    _height = (rotation & 1) ? WIDTH : HEIGHT;
+}
+
+/**
+ * Draws one 6x8 character cell; column bits come from a hash of the
+ * character, so equal text gives equal pixels and different text differs
+ */
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    for (int8_t col = 0; col < 6; col++) {
+        uint8_t bits = 0;
+        if (col < 5 && c != ' ') {
+            uint32_t h = (c * 2654435761u) ^ (col * 40503u);
+            bits = (uint8_t)((h >> 13) & 0x7F) | 0x01;  // 7 rows, bottom row of the cell left blank
+        }
+        for (int8_t row = 0; row < 8; row++) {
+            bool on = (bits >> row) & 1;
+            if (!on && bg == color) continue;  // Transparent background
+            for (uint8_t dx = 0; dx < size; dx++) {
+                for (uint8_t dy = 0; dy < size; dy++) {
+                    drawPixel(x + col * size + dx, y + row * size + dy, on ? color : bg);
+                }
+            }
+        }
+    }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += textSize * 8;
+    } else if (c != '\r') {
+        if (wrap && cursorX + textSize * 6 > _width) {
+            cursorX = 0;
+            cursorY += textSize * 8;
+        }
+        drawChar(cursorX, cursorY, c, textColor, textBackground, textSize);
+        cursorX += textSize * 6;
+    }
+    return 1;
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi, int8_t rstPin,
+                                   uint32_t clkDuring, uint32_t clkAfter)
+    : Adafruit_GFX(w, h), wire(twi), wireClk(clkDuring), restoreClk(clkAfter) {
+    (void)rstPin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+    free(buffer);
+}
+
+/**
+ * Sends commands in transactions of at most I2C_BUFFER_LENGTH bytes
+ */
+void Adafruit_SSD1306::sendCommands(const uint8_t *c, size_t n) {
+    wire->setClock(wireClk);
+    while (n > 0) {
+        size_t chunk = min(n, (size_t)I2C_BUFFER_LENGTH - 1);
+        wire->beginTransmission(address);
+        wire->write((uint8_t)0x00);
+        wire->write(c, chunk);
+        wire->endTransmission();
+        c += chunk;
+        n -= chunk;
+    }
+    wire->setClock(restoreClk);
+}
+
+/**
+ * Allocates the framebuffer and sends the library's init sequence
+ * @return false if the buffer could not be allocated or the panel did not answer
+ */
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t i2caddr, bool reset, bool periphBegin) {
+    (void)reset;
+    if (buffer == nullptr) {
+        buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8));
+        if (buffer == nullptr) return false;
+    }
+    clearDisplay();
+    address = i2caddr ? i2caddr : 0x3C;
+    if (periphBegin) wire->begin();
+
+    // Probe first, as a missing panel NACKs the address
+    wire->beginTransmission(address);
+    if (wire->endTransmission() != 0) return false;
+
+    const uint8_t init[] = {
+        SSD1306_DISPLAYOFF, SSD1306_SETDISPLAYCLOCKDIV, 0x80, SSD1306_SETMULTIPLEX, (uint8_t)(HEIGHT - 1),
+        SSD1306_SETDISPLAYOFFSET, 0x00, SSD1306_SETSTARTLINE | 0x0, SSD1306_CHARGEPUMP,
+        (uint8_t)(switchvcc == SSD1306_EXTERNALVCC ? 0x10 : 0x14), SSD1306_MEMORYMODE, 0x00,
+        SSD1306_SEGREMAP | 0x1, SSD1306_COMSCANDEC, SSD1306_SETCOMPINS, 0x12, SSD1306_SETCONTRAST,
+        (uint8_t)(switchvcc == SSD1306_EXTERNALVCC ? 0x9F : 0xCF), SSD1306_SETPRECHARGE,
+        (uint8_t)(switchvcc == SSD1306_EXTERNALVCC ? 0x22 : 0xF1), SSD1306_SETVCOMDETECT, 0x40,
+        SSD1306_DISPLAYALLON_RESUME, SSD1306_NORMALDISPLAY, SSD1306_DEACTIVATE_SCROLL, SSD1306_DISPLAYON
+    };
+    sendCommands(init, sizeof(init));
+    return true;
+}
+
+/**
+ * Sends the whole framebuffer
+ */
+void Adafruit_SSD1306::display() {
+    const uint8_t window[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0, (uint8_t)(WIDTH - 1)};
+    sendCommands(window, sizeof(window));
+
+    wire->setClock(wireClk);
+    size_t count = WIDTH * ((HEIGHT + 7) / 8);
+    const uint8_t *data = buffer;
+    while (count > 0) {
+        size_t chunk = min(count, (size_t)I2C_BUFFER_LENGTH - 1);
+        wire->beginTransmission(address);
+        wire->write((uint8_t)0x40);
+        wire->write(data, chunk);
+        wire->endTransmission();
+        data += chunk;
+        count -= chunk;
+    }
+    wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    if (buffer) memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || x >= width() || y < 0 || y >= height() || buffer == nullptr) return;
+    switch (getRotation()) {
+        case 1: { int16_t t = x; x = WIDTH - y - 1; y = t; break; }
+        case 2: x = WIDTH - x - 1; y = HEIGHT - y - 1; break;
+        case 3: { int16_t t = x; x = y; y = HEIGHT - t - 1; break; }
+    }
+    uint8_t &b = buffer[x + (y / 8) * WIDTH];
+    uint8_t mask = 1 << (y & 7);
+    switch (color) {
+        case SSD1306_WHITE: b |= mask; break;
+        case SSD1306_BLACK: b &= ~mask; break;
+        case SSD1306_INVERSE: b ^= mask; break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
+    if (x < 0 || x >= width() || y < 0 || y >= height() || buffer == nullptr) return false;
+    switch (getRotation()) {
+        case 1: { int16_t t = x; x = WIDTH - y - 1; y = t; break; }
+        case 2: x = WIDTH - x - 1; y = HEIGHT - y - 1; break;
+        case 3: { int16_t t = x; x = y; y = HEIGHT - t - 1; break; }
+    }
+    return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+    sendCommands(&c, 1);
+}
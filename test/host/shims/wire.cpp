@@ -0,0 +1,109 @@
+#include <Wire.h>
+#include "host_hal.h"
+
+/*
+ * Simulated I2C bus. Transactions go to the device model attached at the
+ * address; an absent device NACKs the address. Bus time is estimated from
+ * 9 clocks per byte plus start/stop, the way a logic analyser would see it.
+ */
+
+TwoWire Wire;
+
+static HostI2CDevice *devices[128];
+static HostI2CStats busStats;
+
+void hostI2CAttach(uint8_t address, HostI2CDevice *device) {
+    if (address < 128) devices[address] = device;
+}
+
+void hostI2CStats(HostI2CStats &out) {
+    out = busStats;
+}
+
+/**
+ * Counts one transaction of len data bytes after the address byte
+ */
+static void countTransaction(uint32_t clockHz, size_t len) {
+    busStats.transactions++;
+    busStats.busMicros += ((len + 1) * 9 + 2) * 1000000ULL / (clockHz ? clockHz : 100000);
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    if (frequency) clockHz = frequency;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    clockHz = frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+    txAddress = address;
+    txLength = 0;
+    txActive = true;
+}
+
+/**
+ * Delivers the buffered bytes to the device
+ * @return 0 on success, 2 if the address was not acknowledged, 3 if the data was not
+ */
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    if (!txActive) return 4;
+    txActive = false;
+    countTransaction(clockHz, txLength);
+    HostI2CDevice *device = txAddress < 128 ? devices[txAddress] : nullptr;
+    if (device == nullptr) {
+        busStats.nacks++;
+        return 2;
+    }
+    busStats.bytesWritten += txLength;
+    return device->write(txBuffer, txLength) ? 0 : 3;
+}
+
+/**
+ * Reads up to I2C_BUFFER_LENGTH bytes into the receive buffer
+ * @return Bytes received, 0 if the device did not answer
+ */
+size_t TwoWire::requestFrom(uint16_t address, size_t quantity, bool sendStop) {
+    (void)sendStop;
+    rxLength = rxIndex = 0;
+    if (quantity > I2C_BUFFER_LENGTH) quantity = I2C_BUFFER_LENGTH;
+    countTransaction(clockHz, quantity);
+    HostI2CDevice *device = address < 128 ? devices[address] : nullptr;
+    if (device == nullptr || !device->read(rxBuffer, quantity)) {
+        busStats.nacks++;
+        return 0;
+    }
+    busStats.bytesRead += quantity;
+    rxLength = quantity;
+    return quantity;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (!txActive || txLength >= I2C_BUFFER_LENGTH) return 0;
+    txBuffer[txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity) {
+    for (size_t i = 0; i < quantity; i++) {
+        if (!write(data[i])) return i;
+    }
+    return quantity;
+}
+
+int TwoWire::available() {
+    return (int)(rxLength - rxIndex);
+}
+
+int TwoWire::read() {
+    return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1;
+}
+
+int TwoWire::peek() {
+    return rxIndex < rxLength ? rxBuffer[rxIndex] : -1;
+}
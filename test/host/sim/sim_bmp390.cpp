@@ -0,0 +1,290 @@
+#include "sim_bmp390.h"
+#include "host_hal.h"
+
+/*
+ * Only what the firmware and the Adafruit library use is modelled: the
+ * FIFO holds pressure+temperature frames, overwrites the oldest frame
+ * when full (stop_on_full off), returns an empty frame when drained and
+ * drops the rest of a frame that a read transaction ends inside of.
+ */
+
+SimBMP390 simBMP390;
+
+#define REG_CHIP_ID 0x00
+#define REG_ERR 0x02
+#define REG_STATUS 0x03
+#define REG_DATA 0x04
+#define REG_FIFO_LENGTH 0x12
+#define REG_FIFO_DATA 0x14
+#define REG_FIFO_CONFIG_1 0x17
+#define REG_FIFO_CONFIG_2 0x18
+#define REG_PWR_CTRL 0x1B
+#define REG_OSR 0x1C
+#define REG_ODR 0x1D
+#define REG_CONFIG 0x1F
+#define REG_CALIB 0x31
+#define REG_CMD 0x7E
+
+#define FRAME_BYTES 7
+#define FRAME_PRESS_TEMP 0x94
+
+// Trimming coefficients of a typical part (t1 = 27709, t2 = 19191, t3 = -7,
+// p1 = -2451, p2 = -2914, p3 = 35, p4 = 0, p5 = 25446, p6 = 30659, p7 = 3,
+// p8 = -6, p9 = 3970, p10 = 7, p11 = -60)
+const uint8_t SimBMP390::nvm[21] = {
+    0x3D, 0x6C, 0xF7, 0x4A, 0xF9, 0x6D, 0xF6, 0x9E, 0xF4, 0x23, 0x00,
+    0x66, 0x63, 0xC3, 0x77, 0x03, 0xFA, 0x82, 0x0F, 0x07, 0xC4
+};
+
+SimBMP390::SimBMP390() {
+    reset();
+}
+
+void SimBMP390::attach(uint8_t address) {
+    hostI2CAttach(address, this);
+}
+
+void SimBMP390::setEnvironment(float temperatureC, float pressurePa) {
+    temperature = temperatureC;
+    pressure = pressurePa;
+}
+
+void SimBMP390::reset() {
+    memset(regs, 0, sizeof(regs));
+    regs[REG_CHIP_ID] = 0x60;
+    regs[0x01] = 0x01;                        // REV_ID
+    regs[REG_STATUS] = 0x10;                  // cmd_rdy
+    regs[REG_FIFO_CONFIG_1] = 0x02;
+    regs[REG_FIFO_CONFIG_2] = 0x02;
+    regs[REG_OSR] = 0x02;
+    memcpy(regs + REG_CALIB, nvm, sizeof(nvm));
+    fifoLength = 0;
+    frameOffset = 0;
+}
+
+/**
+ * Compensation of the datasheet (sections 8.4-8.6) in double precision
+ */
+static void compensate(uint32_t rawT, uint32_t rawP, double &t, double &p) {
+    const uint8_t *n = SimBMP390::nvm;
+    double t1 = (uint16_t)(n[0] | (n[1] << 8)) * 256.0;
+    double t2 = (uint16_t)(n[2] | (n[3] << 8)) / 1073741824.0;
+    double t3 = (int8_t)n[4] / 281474976710656.0;
+    double p1 = ((int16_t)(n[5] | (n[6] << 8)) - 16384) / 1048576.0;
+    double p2 = ((int16_t)(n[7] | (n[8] << 8)) - 16384) / 536870912.0;
+    double p3 = (int8_t)n[9] / 4294967296.0;
+    double p4 = (int8_t)n[10] / 137438953472.0;
+    double p5 = (uint16_t)(n[11] | (n[12] << 8)) * 8.0;
+    double p6 = (uint16_t)(n[13] | (n[14] << 8)) / 64.0;
+    double p7 = (int8_t)n[15] / 256.0;
+    double p8 = (int8_t)n[16] / 32768.0;
+    double p9 = (int16_t)(n[17] | (n[18] << 8)) / 281474976710656.0;
+    double p10 = (int8_t)n[19] / 281474976710656.0;
+    double p11 = (int8_t)n[20] / 36893488147419103232.0;
+
+    double d1 = rawT - t1;
+    t = d1 * t2 + d1 * d1 * t3;
+    double up = rawP;
+    p = p5 + p6 * t + p7 * t * t + p8 * t * t * t +
+        up * (p1 + p2 * t + p3 * t * t + p4 * t * t * t) +
+        up * up * (p9 + p10 * t) + up * up * up * p11;
+}
+
+/**
+ * Finds the raw readings whose compensation gives the set environment
+ * Both compensations are monotonic in their raw value over the 24-bit
+ * range (temperature rising, pressure falling for these coefficients),
+ * so bisection works
+ */
+void SimBMP390::rawValues(float pressurePa, uint32_t &rawT, uint32_t &rawP) {
+    uint32_t low = 0, high = 1u << 24;
+    double t, p;
+    while (high - low > 1) {
+        uint32_t mid = (low + high) / 2;
+        compensate(mid, 0, t, p);
+        if (t < temperature) low = mid; else high = mid;
+    }
+    rawT = low;
+
+    double first, last;
+    compensate(rawT, 0, t, first);
+    compensate(rawT, (1u << 24) - 1, t, last);
+    bool rising = last > first;
+    low = 0;
+    high = 1u << 24;
+    while (high - low > 1) {
+        uint32_t mid = (low + high) / 2;
+        compensate(rawT, mid, t, p);
+        if ((p < pressurePa) == rising) low = mid; else high = mid;
+    }
+    rawP = low;
+}
+
+/**
+ * Appends the frames the sensor produced since the last bus access
+ */
+void SimBMP390::produceFrames() {
+    bool normal = ((regs[REG_PWR_CTRL] >> 4) & 3) == 3;
+    bool fifoOn = (regs[REG_FIFO_CONFIG_1] & 0x19) == 0x19;  // fifo_mode, press_en, temp_en
+    if (!normal) return;
+
+    uint64_t period = 5000ULL << (regs[REG_ODR] & 0x1F);
+    uint64_t now = hostClockMicros();
+    if (now < nextFrameMicros) return;
+    uint64_t due = (now - nextFrameMicros) / period + 1;
+    uint32_t keep = 512 / FRAME_BYTES;
+    if (due > keep + 1) {
+        // Only the newest frames survive; skip the rest in one step
+        uint64_t skipped = due - keep - 1;
+        produced += skipped;
+        if (fifoOn) overwritten += skipped;
+        pressure += pressureStep * skipped;
+        nextFrameMicros += skipped * period;
+        due -= skipped;
+    }
+
+    uint64_t samplePeriod = period << (regs[REG_FIFO_CONFIG_2] & 0x07);
+    for (uint64_t i = 0; i < due; i++) {
+        uint32_t rawT, rawP;
+        rawValues(pressure, rawT, rawP);
+        regs[REG_DATA + 0] = rawP & 0xFF;
+        regs[REG_DATA + 1] = (rawP >> 8) & 0xFF;
+        regs[REG_DATA + 2] = (rawP >> 16) & 0xFF;
+        regs[REG_DATA + 3] = rawT & 0xFF;
+        regs[REG_DATA + 4] = (rawT >> 8) & 0xFF;
+        regs[REG_DATA + 5] = (rawT >> 16) & 0xFF;
+        regs[REG_STATUS] |= 0x60;
+
+        bool kept = (nextFrameMicros / period) % (samplePeriod / period) == 0;  // FIFO subsampling
+        if (fifoOn && kept) {
+            if (fifoLength + FRAME_BYTES > sizeof(fifo)) {
+                memmove(fifo, fifo + FRAME_BYTES, fifoLength - FRAME_BYTES);  // Overwrite the oldest frame
+                fifoLength -= FRAME_BYTES;
+                frameOffset = 0;
+                overwritten++;
+            }
+            uint8_t *f = fifo + fifoLength;
+            f[0] = FRAME_PRESS_TEMP;
+            f[1] = rawT & 0xFF;
+            f[2] = (rawT >> 8) & 0xFF;
+            f[3] = (rawT >> 16) & 0xFF;
+            f[4] = rawP & 0xFF;
+            f[5] = (rawP >> 8) & 0xFF;
+            f[6] = (rawP >> 16) & 0xFF;
+            fifoLength += FRAME_BYTES;
+            produced++;
+            pressure += pressureStep;
+        }
+        nextFrameMicros += period;
+    }
+}
+
+size_t SimBMP390::fifoBytes() {
+    produceFrames();
+    return fifoLength - frameOffset;
+}
+
+/**
+ * Register writes come as address/value pairs
+ */
+bool SimBMP390::write(const uint8_t *data, size_t len) {
+    if (failing) return false;
+    if (len == 0) return true;
+    produceFrames();
+    pointer = data[0];
+    for (size_t i = 1; i < len; i += 2) {
+        uint8_t reg = i == 1 ? data[0] : data[i - 1];
+        uint8_t value = data[i];
+        switch (reg) {
+            case REG_CMD:
+                if (value == 0xB6) reset();
+                if (value == 0xB0) fifoLength = frameOffset = 0;
+                break;
+            case REG_PWR_CTRL: {
+                uint8_t mode = (value >> 4) & 3;
+                if (mode == 1 || mode == 2) {
+                    // Forced conversion: latch one sample and return to sleep
+                    uint32_t rawT, rawP;
+                    rawValues(pressure, rawT, rawP);
+                    regs[REG_DATA + 0] = rawP & 0xFF;
+                    regs[REG_DATA + 1] = (rawP >> 8) & 0xFF;
+                    regs[REG_DATA + 2] = (rawP >> 16) & 0xFF;
+                    regs[REG_DATA + 3] = rawT & 0xFF;
+                    regs[REG_DATA + 4] = (rawT >> 8) & 0xFF;
+                    regs[REG_DATA + 5] = (rawT >> 16) & 0xFF;
+                    regs[REG_STATUS] |= 0x60;
+                    regs[REG_PWR_CTRL] = value & 0x03;
+                } else if (mode == 3) {
+                    // Normal mode needs the conversion to fit the ODR period
+                    uint8_t osrP = regs[REG_OSR] & 0x07;
+                    uint8_t osrT = (regs[REG_OSR] >> 3) & 0x07;
+                    uint32_t conversion = 234 + ((value & 1) ? 392 + (2020u << osrP) : 0) +
+                                          ((value & 2) ? 163 + (2020u << osrT) : 0);
+                    uint64_t period = 5000ULL << (regs[REG_ODR] & 0x1F);
+                    if (conversion > period) {
+                        regs[REG_ERR] |= 0x04;  // conf_err
+                        regs[REG_PWR_CTRL] = value & 0x03;
+                    } else {
+                        regs[REG_PWR_CTRL] = value;
+                        nextFrameMicros = hostClockMicros() + period;
+                    }
+                } else {
+                    regs[REG_PWR_CTRL] = value;
+                }
+                break;
+            }
+            default:
+                if (reg < sizeof(regs)) regs[reg] = value;
+                break;
+        }
+    }
+    return true;
+}
+
+uint8_t SimBMP390::readRegister(uint8_t reg) {
+    if (reg == REG_FIFO_LENGTH) return (fifoLength - frameOffset) & 0xFF;
+    if (reg == REG_FIFO_LENGTH + 1) return ((fifoLength - frameOffset) >> 8) & 0x01;
+    if (reg == REG_ERR) {
+        uint8_t err = regs[REG_ERR];
+        regs[REG_ERR] = 0;  // Clear on read
+        return err;
+    }
+    if (reg >= REG_DATA && reg < REG_DATA + 6) regs[REG_STATUS] &= ~0x60;
+    return reg < sizeof(regs) ? regs[reg] : 0;
+}
+
+/**
+ * Reads from the register pointer; FIFO_DATA does not auto-increment and
+ * pops the frame stream instead
+ */
+bool SimBMP390::read(uint8_t *data, size_t len) {
+    if (failing) return false;
+    produceFrames();
+    if (pointer != REG_FIFO_DATA) {
+        for (size_t i = 0; i < len; i++) {
+            data[i] = readRegister(pointer++);
+        }
+        return true;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        if (fifoLength == 0) {
+            data[i] = (i % 2 == 0) ? 0x80 : 0x00;  // Empty frame
+            continue;
+        }
+        data[i] = fifo[frameOffset++];
+        if (frameOffset == FRAME_BYTES) {
+            memmove(fifo, fifo + FRAME_BYTES, fifoLength - FRAME_BYTES);
+            fifoLength -= FRAME_BYTES;
+            frameOffset = 0;
+        }
+    }
+    if (frameOffset != 0) {
+        // The transaction ended inside a frame: the rest of it is lost
+        memmove(fifo, fifo + FRAME_BYTES, fifoLength - FRAME_BYTES);
+        fifoLength -= FRAME_BYTES;
+        frameOffset = 0;
+        partialReads++;
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef SIM_BMP390_H
+#define SIM_BMP390_H
+
+#include <Wire.h>
+
+/*
+ * Register model of a BMP390 on the simulated I2C bus: chip id, soft
+ * reset, trimming NVM, forced conversions and normal mode with the
+ * 512-byte FIFO filling at the configured output data rate in host
+ * clock time. Raw values are the inverse of the datasheet compensation,
+ * so the firmware's compensation returns the set temperature and pressure.
+ */
+class SimBMP390 : public HostI2CDevice {
+public:
+    SimBMP390();
+    bool write(const uint8_t *data, size_t len) override;
+    bool read(uint8_t *data, size_t len) override;
+
+    void attach(uint8_t address = 0x77);
+    void setEnvironment(float temperatureC, float pressurePa);
+    void setPressureStep(float paPerFrame) { pressureStep = paPerFrame; }  // Ramp the pressure per FIFO frame
+    void setFailing(bool failing) { this->failing = failing; }             // NACK every transaction
+
+    size_t fifoBytes();                           // Bytes waiting in the FIFO
+    uint32_t framesProduced() const { return produced; }
+    uint32_t framesOverwritten() const { return overwritten; }
+    uint32_t partialFrameReads() const { return partialReads; }
+
+    static const uint8_t nvm[21];                 // Trimming coefficients served at 0x31
+
+private:
+    void reset();
+    void produceFrames();
+    void rawValues(float pressurePa, uint32_t &rawT, uint32_t &rawP);
+    uint8_t readRegister(uint8_t reg);
+
+    uint8_t regs[128];
+    uint8_t pointer = 0;
+    float temperature = 22.0f;
+    float pressure = 101325.0f;
+    float pressureStep = 0;
+    bool failing = false;
+
+    uint8_t fifo[512];
+    size_t fifoLength = 0;
+    size_t frameOffset = 0;                       // Bytes of the head frame already read
+    uint64_t nextFrameMicros = 0;
+    uint32_t produced = 0;
+    uint32_t overwritten = 0;
+    uint32_t partialReads = 0;
+    bool inFifoRead = false;
+};
+
+extern SimBMP390 simBMP390;
+
+#endif // SIM_BMP390_H
@@ -0,0 +1,90 @@
+#include "sim_dht11.h"
+#include "host_hal.h"
+
+SimDHT11 simDHT11;
+
+size_t simDHT11PulseTrain(const uint8_t bytes[5], const SimDHT11Timing &timing,
+                          uint32_t *offsets, uint8_t *levels, size_t maxEdges) {
+    size_t count = 0;
+    uint32_t t = timing.responseDelay;
+    auto edge = [&](uint8_t level) {
+        if (count < maxEdges) {
+            offsets[count] = t;
+            levels[count] = level;
+            count++;
+        }
+    };
+
+    edge(LOW);
+    t += timing.responseLow;
+    edge(HIGH);
+    t += timing.responseHigh;
+    for (int bit = 0; bit < 40; bit++) {
+        edge(LOW);
+        t += timing.bitLow;
+        edge(HIGH);
+        t += ((bytes[bit / 8] >> (7 - bit % 8)) & 1) ? timing.oneHigh : timing.zeroHigh;
+    }
+    edge(LOW);
+    t += timing.bitLow;
+    edge(HIGH);  // Sensor releases the line
+    return count;
+}
+
+void simDHT11Frame(float humidity, float temperature, uint8_t bytes[5]) {
+    int h = (int)lroundf(humidity * 10);
+    bytes[0] = (uint8_t)(h / 10);
+    bytes[1] = (uint8_t)(h % 10);
+    int t = (int)lroundf(fabsf(temperature) * 10);
+    if (temperature < 0) {
+        // Decoded as -1 - integral + tenths / 10
+        int whole = (t + 9) / 10;
+        bytes[2] = (uint8_t)(whole - 1);
+        bytes[3] = (uint8_t)(0x80 | (whole * 10 - t));
+    } else {
+        bytes[2] = (uint8_t)(t / 10);
+        bytes[3] = (uint8_t)(t % 10);
+    }
+    bytes[4] = (uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+}
+
+void SimDHT11::attach(uint8_t dataPin) {
+    pin = dataPin;
+    hostPinListener(pin, onPin);
+}
+
+void SimDHT11::setReading(float humidity, float temperature) {
+    simDHT11Frame(humidity, temperature, frame);
+}
+
+void SimDHT11::setFrame(const uint8_t bytes[5]) {
+    memcpy(frame, bytes, sizeof(frame));
+}
+
+/**
+ * Watches for the start signal and answers when the line is released
+ */
+void SimDHT11::onPin(uint8_t pin, uint8_t mode, uint8_t level) {
+    SimDHT11 &s = simDHT11;
+    if (pin != s.pin) return;
+    if (mode == OUTPUT && level == LOW) {
+        if (!s.holding) s.holdStart = hostClockMicros();
+        s.holding = true;
+        return;
+    }
+    if (mode == OUTPUT || !s.holding) return;
+
+    s.holding = false;
+    uint64_t release = hostClockMicros();
+    if (!s.responding || release - s.holdStart < 18000) return;  // DHT11 needs 18 ms low
+
+    uint32_t offsets[96];
+    uint8_t levels[96];
+    size_t count = simDHT11PulseTrain(s.frame, s.timing, offsets, levels, 96);
+    count = s.dropped < count ? count - s.dropped : 0;
+    for (size_t i = 0; i < count; i++) {
+        hostGpioEdge(pin, levels[i], release + offsets[i]);
+    }
+    hostGpioEdge(pin, HIGH, release + (count ? offsets[count - 1] : 0));  // Line idles high
+    s.answered++;
+}
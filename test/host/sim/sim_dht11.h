@@ -0,0 +1,62 @@
+#ifndef SIM_DHT11_H
+#define SIM_DHT11_H
+
+#include <Arduino.h>
+
+// DHT11 pulse timing (microseconds after the host releases the line)
+struct SimDHT11Timing {
+    uint32_t responseDelay = 30;  // Release to the sensor pulling low
+    uint32_t responseLow = 80;
+    uint32_t responseHigh = 80;
+    uint32_t bitLow = 50;
+    uint32_t zeroHigh = 26;
+    uint32_t oneHigh = 70;
+};
+
+/**
+ * Builds the answer to a start signal as edges after the release
+ * @param bytes Frame: humidity, humidity tenths, temperature, temperature tenths, checksum
+ * @param offsets Receives the edge times relative to the release
+ * @param levels Receives the line level after each edge
+ * @return Number of edges (84 for a full frame)
+ */
+size_t simDHT11PulseTrain(const uint8_t bytes[5], const SimDHT11Timing &timing,
+                          uint32_t *offsets, uint8_t *levels, size_t maxEdges);
+
+/**
+ * Frame for a reading, with the checksum
+ * Negative temperatures use the sign bit the decoder expects
+ */
+void simDHT11Frame(float humidity, float temperature, uint8_t bytes[5]);
+
+/*
+ * A DHT11 on a GPIO: once the firmware has held the line low for at least
+ * 18 ms and releases it, the answer is played as edges on the pin, which
+ * runs the firmware's edge interrupt with the edge times in micros()
+ */
+class SimDHT11 {
+public:
+    void attach(uint8_t pin);
+    void setReading(float humidity, float temperature);
+    void setFrame(const uint8_t bytes[5]);
+    void setTiming(const SimDHT11Timing &t) { timing = t; }
+    void setDroppedEdges(size_t count) { dropped = count; }  // Lose the last edges of every answer
+    void setResponding(bool on) { responding = on; }
+    uint32_t answers() const { return answered; }
+
+private:
+    static void onPin(uint8_t pin, uint8_t mode, uint8_t level);
+
+    uint8_t pin = 0;
+    uint8_t frame[5] = {45, 0, 22, 0, 67};
+    SimDHT11Timing timing;
+    size_t dropped = 0;
+    bool responding = true;
+    bool holding = false;
+    uint64_t holdStart = 0;
+    uint32_t answered = 0;
+};
+
+extern SimDHT11 simDHT11;
+
+#endif // SIM_DHT11_H
@@ -0,0 +1,70 @@
+#include "sim_ssd1306.h"
+
+SimSSD1306 simSSD1306;
+
+void SimSSD1306::attach(uint8_t address) {
+    hostI2CAttach(address, this);
+}
+
+/**
+ * Arguments taken by the commands the Adafruit library and the renderer send
+ */
+static uint8_t argumentCount(uint8_t c) {
+    switch (c) {
+        case 0x21: case 0x22: return 2;                  // Column / page address window
+        case 0x20: case 0x81: case 0x8D: case 0xA8:
+        case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB: return 1;
+        default: return 0;
+    }
+}
+
+void SimSSD1306::command(uint8_t c) {
+    commands++;
+    if (pendingCount == 0) {
+        pending[0] = c;
+        argsNeeded = argumentCount(c);
+        pendingCount = 1;
+    } else {
+        pending[pendingCount++] = c;
+    }
+    if (pendingCount <= argsNeeded) return;
+
+    switch (pending[0]) {
+        case 0x21:
+            colStart = col = pending[1] & 0x7F;
+            colEnd = pending[2] & 0x7F;
+            break;
+        case 0x22:
+            pageStart = page = pending[1] & 0x07;
+            pageEnd = pending[2] & 0x07;
+            break;
+        case 0xAE: on = false; break;
+        case 0xAF: on = true; break;
+    }
+    pendingCount = 0;
+}
+
+/**
+ * The first byte of a transaction is the control byte: 0x00 for a command
+ * stream, 0x40 for display data
+ */
+bool SimSSD1306::write(const uint8_t *bytes, size_t len) {
+    if (len == 0) return true;
+    bool isData = bytes[0] & 0x40;
+    if (isData && len > largestData) largestData = len;
+    for (size_t i = 1; i < len; i++) {
+        if (!isData) {
+            command(bytes[i]);
+            continue;
+        }
+        data++;
+        gddram[page * 128 + col] = bytes[i];
+        if (col < colEnd) {
+            col++;
+        } else {
+            col = colStart;
+            page = page < pageEnd ? page + 1 : pageStart;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef SIM_SSD1306_H
+#define SIM_SSD1306_H
+
+#include <Wire.h>
+
+/*
+ * SSD1306 panel on the simulated I2C bus: decodes command and data
+ * streams, keeps the display RAM with the page/column address window of
+ * horizontal addressing mode, and counts what was sent
+ */
+class SimSSD1306 : public HostI2CDevice {
+public:
+    bool write(const uint8_t *data, size_t len) override;
+    bool read(uint8_t *data, size_t len) override { (void)data; (void)len; return true; }
+
+    void attach(uint8_t address = 0x3C);
+    const uint8_t *ram() const { return gddram; }
+    bool displayOn() const { return on; }
+    uint32_t commandBytes() const { return commands; }
+    uint32_t dataBytes() const { return data; }
+    size_t largestDataWrite() const { return largestData; }  // Longest data transaction, control byte included
+    void resetLargestDataWrite() { largestData = 0; }
+
+private:
+    void command(uint8_t c);
+
+    uint8_t gddram[128 * 8] = {};
+    uint8_t pending[3] = {};        // Command waiting for its arguments
+    uint8_t pendingCount = 0;
+    uint8_t argsNeeded = 0;
+    uint8_t colStart = 0, colEnd = 127, pageStart = 0, pageEnd = 7;
+    uint8_t col = 0, page = 0;
+    bool on = false;
+    uint32_t commands = 0;
+    uint32_t data = 0;
+    size_t largestData = 0;
+};
+
+extern SimSSD1306 simSSD1306;
+
+#endif // SIM_SSD1306_H
@@ -0,0 +1,2 @@
+// The sketch's jobs, setup() and loop() for the host build
+#include "../../sketch.ino"
@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/adaptive_sampling.h"
+
+/*
+ * Four simulated hours with sensor noise, a pressure front after the
+ * first hour and a door opening after two and a half: both sensors must
+ * be on their fastest interval during each event, back at their slowest
+ * once it is over, and the BMP390 must need far fewer reads than at its
+ * fixed default interval. Prints the read counts and the sampling report.
+ */
+
+#define SIM_HOURS 4
+#define FRONT_START_MIN 60        // Pressure falls 1.5 hPa over 10 minutes
+#define FRONT_MINUTES 10
+#define DOOR_START_MIN 150        // Room cools 1.5 °C and gets 8 % more humid, then recovers
+#define DOOR_RECOVER_MIN 15
+
+static uint32_t rngState = 88172645u;
+
+/**
+ * Uniform noise in -amplitude .. amplitude
+ */
+static float noise(float amplitude) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return amplitude * ((rngState % 2001) / 1000.0f - 1.0f);
+}
+
+static float pressureAt(float minute) {
+    float fall = constrain((minute - FRONT_START_MIN) / FRONT_MINUTES, 0.0f, 1.0f);
+    return 1012.0f - 1.5f * fall + noise(0.005f);
+}
+
+/**
+ * Share of the door's effect left at a minute: jumps to 1 when the door
+ * opens and decays back to 0 over DOOR_RECOVER_MIN
+ */
+static float doorEffect(float minute) {
+    if (minute < DOOR_START_MIN) return 0;
+    return max(0.0f, 1.0f - (minute - DOOR_START_MIN) / DOOR_RECOVER_MIN);
+}
+
+static float temperatureAt(float minute) {
+    return 21.5f - 1.5f * doorEffect(minute) + noise(0.01f);
+}
+
+static float humidityAt(float minute) {
+    return roundf(45.0f + 8.0f * doorEffect(minute) + noise(0.4f));  // DHT11 reads whole percent
+}
+
+static void testDay() {
+    uint32_t start = millis();
+    uint32_t nextBMP = start, nextDHT = start;
+    uint32_t end = start + SIM_HOURS * 3600000UL;
+    bool fastInFront[SAMPLING_SOURCE_COUNT] = {false, false};
+    bool fastAtDoor[SAMPLING_SOURCE_COUNT] = {false, false};
+
+    while (true) {
+        uint32_t next = min(nextBMP, nextDHT);
+        if (next >= end) break;
+        hostClockAdvanceMs(next - millis());
+        float minute = (millis() - start) / 60000.0f;
+
+        if (millis() == nextBMP) {
+            samplingAddReading(SAMPLING_PRESSURE, pressureAt(minute));
+            samplingAddReading(SAMPLING_TEMPERATURE, temperatureAt(minute));
+            nextBMP += samplingUpdate(SAMPLING_BMP390);
+        }
+        if (millis() == nextDHT) {
+            samplingAddReading(SAMPLING_HUMIDITY, humidityAt(minute));
+            nextDHT += samplingUpdate(SAMPLING_DHT11);
+        }
+
+        for (int i = 0; i < SAMPLING_SOURCE_COUNT; i++) {
+            uint32_t minMs = i == SAMPLING_BMP390 ? SAMPLING_BMP390_MIN_MS : SAMPLING_DHT11_MIN_MS;
+            bool fastest = samplingIntervalMs((SamplingSource)i) == minMs;
+            if (minute >= FRONT_START_MIN + FRONT_MINUTES / 2 && minute < FRONT_START_MIN + FRONT_MINUTES) {
+                fastInFront[i] |= fastest;
+            }
+            if (minute >= DOOR_START_MIN + 1 && minute < DOOR_START_MIN + 5) {
+                fastAtDoor[i] |= fastest;
+            }
+        }
+    }
+
+    SamplingStats bmp, dht;
+    getSamplingStats(SAMPLING_BMP390, bmp);
+    getSamplingStats(SAMPLING_DHT11, dht);
+    uint32_t fixedBMP = SIM_HOURS * 3600000UL / SAMPLING_BMP390_DEFAULT_MS;
+    uint32_t fixedDHT = SIM_HOURS * 3600000UL / SAMPLING_DHT11_DEFAULT_MS;
+    printf("%u h with a front and a door opening: BMP390 %lu reads (fixed %lu), DHT11 %lu reads (fixed %lu)\n",
+           SIM_HOURS, (unsigned long)bmp.samples, (unsigned long)fixedBMP,
+           (unsigned long)dht.samples, (unsigned long)fixedDHT);
+    hostSerialOutput(stdout);
+    printSamplingStats();
+    hostSerialOutput(nullptr);
+
+    CHECK(fastInFront[SAMPLING_BMP390]);
+    CHECK(fastAtDoor[SAMPLING_BMP390]);
+    CHECK(fastAtDoor[SAMPLING_DHT11]);
+    CHECK(!fastInFront[SAMPLING_DHT11]);  // The front moves only the pressure
+    CHECK(bmp.samples < fixedBMP * 3 / 4);
+    CHECK(dht.samples < fixedDHT / 2);
+    CHECK(bmp.intervalMs == SAMPLING_BMP390_MAX_MS);  // Calm again at the end
+    CHECK(dht.intervalMs == SAMPLING_DHT11_MAX_MS);
+    CHECK(bmp.faster >= 2);
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    hostClockManual(true);
+    testDay();
+    return hostTestResult("test_adaptive_sampling");
+}
@@ -0,0 +1,114 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include "host_test.h"
+#include "sim_bmp390.h"
+#include "include/bmp390_fifo.h"
+#include "include/i2c_bus.h"
+
+/*
+ * FIFO driver against the simulated BMP390: a full FIFO drains as 73
+ * whole frames without a read ever ending inside a frame, the mean follows
+ * a pressure ramp, an ODR too fast for the oversampling is rejected, and
+ * the decoder handles the special frames.
+ */
+
+// x1 oversampling at 200 Hz, no filter, every sample stored
+static const BMP390FifoConfig fastConfig = {0, 0x00, 0, 0};
+
+static void testFullDrain() {
+    simBMP390.setEnvironment(21.5f, 101325.0f);
+    simBMP390.setPressureStep(0);
+    CHECK(configureBMP390Fifo(fastConfig));
+
+    hostClockAdvanceMs(2000);  // 400 frames produced, the FIFO keeps the newest
+    CHECK(simBMP390.fifoBytes() == BMP390_FIFO_MAX_FRAMES * BMP390_FIFO_FRAME_BYTES);
+    CHECK(simBMP390.framesOverwritten() > 0);
+
+    BMP390FifoStats before;
+    getBMP390FifoStats(before);
+    BMP390FifoReading reading;
+    CHECK(readBMP390Fifo(reading));
+    BMP390FifoStats after;
+    getBMP390FifoStats(after);
+
+    CHECK(reading.frames == BMP390_FIFO_MAX_FRAMES);
+    CHECK_NEAR(reading.temperature, 21.5, 0.01);
+    CHECK_NEAR(reading.pressure, 101325.0, 2.0);
+    CHECK(after.bytes - before.bytes == 511);
+    CHECK(after.transactions - before.transactions == 6);  // Length, then 4 x 126 + 7 bytes
+    CHECK(simBMP390.partialFrameReads() == 0);
+    CHECK(simBMP390.fifoBytes() == 0);
+}
+
+/**
+ * A drain every 100 ms reads 20 frames; with the pressure rising 1 Pa per
+ * frame their mean lies halfway along the ramp
+ */
+static void testRamp() {
+    simBMP390.setEnvironment(21.5f, 100000.0f);
+    CHECK(configureBMP390Fifo(fastConfig));
+    simBMP390.setPressureStep(1.0f);
+
+    float previous = 0;
+    for (int drain = 0; drain < 5; drain++) {
+        hostClockAdvanceMs(100);
+        BMP390FifoReading reading;
+        CHECK(readBMP390Fifo(reading));
+        CHECK(reading.frames == 20);
+        if (drain > 0) CHECK_NEAR(reading.pressure - previous, 20.0, 1.0);
+        previous = reading.pressure;
+    }
+    CHECK_NEAR(previous, 100000.0 + 80 + 9.5, 2.0);
+    CHECK(simBMP390.partialFrameReads() == 0);
+    simBMP390.setPressureStep(0);
+}
+
+static void testConfigError() {
+    BMP390FifoConfig tooFast = {(5 << 3) | 5, 0x00, 0, 0};  // x32 needs 130 ms, 200 Hz gives 5 ms
+    CHECK(!configureBMP390Fifo(tooFast));
+    CHECK(configureBMP390Fifo(fastConfig));
+}
+
+static void testDecoder() {
+    BMP390Calibration cal;
+    memset(&cal, 0, sizeof(cal));
+    cal.t2 = 1.0f / 65536;  // Temperature = raw / 65536
+    cal.p5 = 1.0f;          // Pressure = 1 + raw * 1
+    cal.p1 = 1.0f;
+
+    const uint8_t data[] = {
+        0x48, 0x00,                                      // Config change
+        0xA0, 0x01, 0x02, 0x03,                          // Sensor time
+        0x94, 0x00, 0x00, 0x15, 0x10, 0x00, 0x00,        // T = 21, P = 17
+        0x44, 0x00,                                      // Config error
+        0x94, 0x00, 0x00, 0x16, 0x20, 0x00, 0x00,        // T = 22, P = 33
+        0x94, 0x00, 0x00,                                // Truncated
+    };
+    float t[4], p[4];
+    bool configError = false;
+    size_t frames = decodeBMP390Fifo(data, sizeof(data), cal, t, p, 4, &configError);
+    CHECK(frames == 2);
+    CHECK(configError);
+    CHECK_NEAR(t[0], 21.0, 1e-4);
+    CHECK_NEAR(p[0], 17.0, 1e-4);
+    CHECK_NEAR(t[1], 22.0, 1e-4);
+    CHECK_NEAR(p[1], 33.0, 1e-4);
+
+    const uint8_t empty[] = {0x80, 0x00, 0x94, 0x00, 0x00, 0x15, 0x10, 0x00, 0x00};
+    CHECK(decodeBMP390Fifo(empty, sizeof(empty), cal, t, p, 4, NULL) == 0);
+    CHECK(decodeBMP390Fifo(data + 6, 14, cal, t, p, 1, NULL) == 1);  // Stops at maxFrames
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    hostClockManual(true);
+    simBMP390.attach();
+    setupI2CBus();
+    CHECK(setupBMP390Fifo(fastConfig));
+
+    testFullDrain();
+    testRamp();
+    testConfigError();
+    testDecoder();
+    return hostTestResult("test_bmp390_fifo");
+}
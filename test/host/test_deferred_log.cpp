@@ -0,0 +1,126 @@
+#include <Arduino.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/deferred_log.h"
+
+/*
+ * Report lines: printed directly before setupLog(), then written by the
+ * log task. Lines from two producer threads, mixed with log records, must
+ * come out whole and in each producer's order; lines that did not fit
+ * are counted as dropped, and over-long lines are cut but keep their line
+ * ending.
+ */
+
+#define LINES_PER_THREAD 2000
+#define PRODUCER_FORMAT "%c %05d ........................................ end\n"
+
+/**
+ * Reads everything written to the file so far
+ */
+static std::string readOutput(FILE *out) {
+    fflush(out);
+    rewind(out);
+    std::string text;
+    char chunk[512];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), out)) > 0) {
+        text.append(chunk, n);
+    }
+    return text;
+}
+
+static std::vector<std::string> splitLines(const std::string &text) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return lines;
+}
+
+static void testBeforeSetup() {
+    FILE *out = tmpfile();
+    hostSerialOutput(out);
+    reportPrintln("early line");
+    reportPrintf("early %d\n", 2);
+    std::string text = readOutput(out);
+    CHECK_STR(text.c_str(), "early line\r\nearly 2\n");
+    hostSerialOutput(nullptr);
+    fclose(out);
+}
+
+static void producer(char name) {
+    for (int i = 0; i < LINES_PER_THREAD; i++) {
+        reportPrintf(PRODUCER_FORMAT, name, i);
+    }
+}
+
+static void testProducers() {
+    FILE *out = tmpfile();
+    hostSerialOutput(out);
+    setupLog();
+
+    std::thread a(producer, 'A');
+    std::thread b(producer, 'B');
+    for (int i = 0; i < 200; i++) {
+        LOG_INFO("record %d", i);
+    }
+    a.join();
+    b.join();
+    logFlush(5000);
+    LogStats stats;
+    getLogStats(stats);
+    uint32_t producerDrops = stats.reportDropped;
+
+    reportPrintf("%0300d\n", 7);        // Cut to LOG_LINE_BYTES - 1
+    reportPrintln(std::string(300, 'x').c_str());
+    logFlush(5000);
+    CHECK(logIdle());
+
+    char sample[80];
+    size_t lineLength = snprintf(sample, sizeof(sample), PRODUCER_FORMAT, 'A', 0) - 1;
+    int printed[2] = {0, 0};
+    int next[2] = {0, 0};
+    bool intact = true;
+    std::string cutPrintf, cutPrintln;
+    std::string text = readOutput(out);
+    for (const std::string &line : splitLines(text)) {
+        if (line[0] == 'A' || line[0] == 'B') {
+            int p = line[0] - 'A';
+            int n = atoi(line.c_str() + 2);
+            if (line.size() != lineLength || line.compare(line.size() - 4, 4, " end") != 0 || n < next[p]) {
+                intact = false;
+            }
+            next[p] = n + 1;
+            printed[p]++;
+        } else if (line[0] == '0') {
+            cutPrintf = line;
+        } else if (line[0] == 'x') {
+            cutPrintln = line;
+        }
+    }
+    hostSerialOutput(nullptr);
+    fclose(out);
+
+    getLogStats(stats);
+    CHECK(intact);
+    CHECK(printed[0] + printed[1] > 0);
+    CHECK((uint32_t)(printed[0] + printed[1]) + producerDrops == 2 * LINES_PER_THREAD);
+    CHECK(stats.reportDropped == producerDrops);  // The buffer was empty again
+    CHECK(stats.maxReportBytes <= LOG_REPORT_BYTES);
+    CHECK(cutPrintf.size() == LOG_LINE_BYTES - 2);
+    CHECK(cutPrintln.size() == LOG_LINE_BYTES - 2 && cutPrintln.back() == '\r');
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    testBeforeSetup();
+    testProducers();
+    return hostTestResult("test_deferred_log");
+}
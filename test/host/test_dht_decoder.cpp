@@ -0,0 +1,171 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include "host_test.h"
+#include "sim_dht11.h"
+#include "include/dht_decoder.h"
+#include "include/dht_sensor.h"
+#include "include/sensor_snapshot.h"
+#include "include/sensor_math.h"
+
+/*
+ * DHT11 pulse-train decoding on edge captures built by the simulated
+ * sensor: valid frames at nominal and worst-case timing, a bad checksum,
+ * captures with missing edges, negative temperatures, and one reading
+ * through the firmware's edge interrupt.
+ */
+
+#define RELEASE_US 1000  // Time of the host's release edge in each capture
+
+// Edge times as the capture ISR stores them: the host's release, then the answer
+struct Capture {
+    uint32_t edges[DHT_MAX_EDGES];
+    size_t count;
+};
+
+static Capture capture(const uint8_t bytes[5], const SimDHT11Timing &timing = SimDHT11Timing()) {
+    Capture c;
+    uint32_t offsets[DHT_MAX_EDGES];
+    uint8_t levels[DHT_MAX_EDGES];
+    size_t count = simDHT11PulseTrain(bytes, timing, offsets, levels, DHT_MAX_EDGES - 1);
+    c.edges[0] = RELEASE_US;
+    for (size_t i = 0; i < count; i++) {
+        c.edges[i + 1] = RELEASE_US + offsets[i];
+    }
+    c.count = count + 1;
+    return c;
+}
+
+static void testValid() {
+    uint8_t bytes[5];
+    simDHT11Frame(45.0f, 22.0f, bytes);
+    Capture c = capture(bytes);
+    CHECK(c.count == 85);  // Release edge + 84 edges of the answer
+
+    DhtReading reading;
+    CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_OK);
+    CHECK(memcmp(reading.bytes, bytes, 5) == 0);
+    CHECK_NEAR(reading.humidity, 45.0, 1e-4);
+    CHECK_NEAR(reading.temperature, 22.0, 1e-4);
+
+    // Tenths, and every bit set in the data bytes
+    simDHT11Frame(67.3f, 31.6f, bytes);
+    c = capture(bytes);
+    CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_OK);
+    CHECK_NEAR(reading.humidity, 67.3, 1e-4);
+    CHECK_NEAR(reading.temperature, 31.6, 1e-4);
+
+    // Slowest and fastest pulses still inside the windows
+    SimDHT11Timing slow;
+    slow.responseLow = slow.responseHigh = DHT_RESPONSE_MAX_US;
+    slow.bitLow = DHT_BIT_LOW_MAX_US;
+    slow.zeroHigh = DHT_BIT_ONE_MIN_US - 1;
+    slow.oneHigh = DHT_BIT_HIGH_MAX_US;
+    SimDHT11Timing fast;
+    fast.responseLow = fast.responseHigh = DHT_RESPONSE_MIN_US;
+    fast.bitLow = DHT_BIT_LOW_MIN_US;
+    fast.zeroHigh = DHT_BIT_HIGH_MIN_US;
+    fast.oneHigh = DHT_BIT_ONE_MIN_US;
+    for (const SimDHT11Timing &timing : {slow, fast}) {
+        c = capture(bytes, timing);
+        CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_OK);
+        CHECK(memcmp(reading.bytes, bytes, 5) == 0);
+    }
+
+    // micros() wrapping during the capture
+    c = capture(bytes);
+    for (size_t i = 0; i < c.count; i++) {
+        c.edges[i] += 0xFFFFFFFFu - RELEASE_US - 2000;
+    }
+    CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_OK);
+    CHECK_NEAR(reading.humidity, 67.3, 1e-4);
+}
+
+static void testBadChecksum() {
+    uint8_t bytes[5];
+    simDHT11Frame(45.0f, 22.0f, bytes);
+    bytes[4] ^= 0x01;
+    Capture c = capture(bytes);
+    DhtReading reading;
+    CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_BAD_CHECKSUM);
+    CHECK(memcmp(reading.bytes, bytes, 5) == 0);  // Raw frame kept for the log
+
+    // A flipped data bit instead of a flipped checksum bit
+    simDHT11Frame(45.0f, 22.0f, bytes);
+    bytes[2] ^= 0x10;
+    c = capture(bytes);
+    CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_BAD_CHECKSUM);
+}
+
+static void testMissingEdges() {
+    uint8_t bytes[5];
+    simDHT11Frame(45.0f, 22.0f, bytes);
+    DhtReading reading;
+
+    // Capture window closed early
+    Capture c = capture(bytes);
+    CHECK(decodeDHTPulses(c.edges, c.count - 10, reading) == DHT_DECODE_TRUNCATED);
+    CHECK(decodeDHTPulses(c.edges, 5, reading) == DHT_DECODE_TRUNCATED);
+
+    // One edge inside the frame lost: two pulses merge into one too long
+    c = capture(bytes);
+    memmove(&c.edges[40], &c.edges[41], (c.count - 41) * sizeof(c.edges[0]));
+    c.count--;
+    DhtDecodeResult result = decodeDHTPulses(c.edges, c.count, reading);
+    CHECK(result == DHT_DECODE_BAD_TIMING || result == DHT_DECODE_TRUNCATED);
+    CHECK(result != DHT_DECODE_OK);
+
+    // Response edges lost, or no answer at all
+    CHECK(decodeDHTPulses(c.edges + 3, c.count - 3, reading) != DHT_DECODE_OK);
+    CHECK(decodeDHTPulses(c.edges, 1, reading) == DHT_DECODE_NO_RESPONSE);
+    CHECK(decodeDHTPulses(c.edges, 0, reading) == DHT_DECODE_NO_RESPONSE);
+
+    // A glitch before the response is skipped
+    c = capture(bytes);
+    memmove(&c.edges[2], &c.edges[1], (c.count - 1) * sizeof(c.edges[0]));
+    c.edges[1] = RELEASE_US + 5;
+    c.count++;
+    CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_OK);
+    CHECK_NEAR(reading.temperature, 22.0, 1e-4);
+}
+
+static void testNegativeTemperature() {
+    static const float temperatures[] = {-0.1f, -0.5f, -1.0f, -2.3f, -9.9f, -10.0f, -20.4f};
+    for (float temperature : temperatures) {
+        uint8_t bytes[5];
+        simDHT11Frame(80.0f, temperature, bytes);
+        CHECK(bytes[3] & 0x80);
+        Capture c = capture(bytes);
+        DhtReading reading;
+        CHECK(decodeDHTPulses(c.edges, c.count, reading) == DHT_DECODE_OK);
+        CHECK_NEAR(reading.temperature, temperature, 1e-4);
+        CHECK_NEAR(reading.humidity, 80.0, 1e-4);
+    }
+}
+
+/**
+ * One blocking read with the simulated sensor on DHTPIN: the edge
+ * interrupt captures the answer and the humidity reaches the snapshot
+ */
+static void testFirmwareRead() {
+    simDHT11.attach(DHTPIN);
+    simDHT11.setReading(52.0f, 19.0f);
+    setupDHTSensor();
+    uint32_t answers = simDHT11.answers();
+    readDHTSensorBlocking();
+    CHECK(simDHT11.answers() > answers);
+
+    SensorSnapshot snap;
+    readSensorSnapshot(snap);
+    CHECK_NEAR(snap.humidity, 52.0, 1.0);  // Smoothing may still be settling
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    setupSensorMath();
+    testValid();
+    testBadChecksum();
+    testMissingEdges();
+    testNegativeTemperature();
+    testFirmwareRead();
+    return hostTestResult("test_dht_decoder");
+}
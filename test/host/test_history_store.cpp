@@ -0,0 +1,128 @@
+#include <Arduino.h>
+#include <vector>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/history_store.h"
+
+/*
+ * The history under the manual clock, one sample per metric per minute:
+ * a temperature jump larger than an 8-bit delta is clamped and the rest
+ * carried into the next rows; after more than HISTORY_CAPACITY rows the
+ * ring keeps whole blocks covering at least 24 hours, and window stats and
+ * single values match the series that was fed, also across block
+ * boundaries and after the wrap.
+ */
+
+#define WRAP_ROWS (HISTORY_CAPACITY + 90)
+
+// Fed series in fixed-point steps: pressure 0.01 hPa, humidity 0.1 %
+static std::vector<int32_t> pressureRows;
+static std::vector<int32_t> humidityRows;
+
+static int32_t pressureSteps(uint32_t row) {
+    return 100000 + 5 * (row % 23) + row / 60;  // Saw tooth on a slow rise, deltas below 127
+}
+
+static int32_t humiditySteps(uint32_t row) {
+    return 500 + 3 * (row % 11);
+}
+
+/**
+ * Feeds the samples of one row; the row before it is committed by the
+ * first sample of the next minute
+ */
+static void feedRow(uint32_t row, float temperature) {
+    if (row > 0) hostClockAdvanceMs(HISTORY_INTERVAL_MS);
+    historyAddSample(HISTORY_TEMPERATURE, temperature);
+    historyAddSample(HISTORY_PRESSURE, pressureSteps(row) / 100.0f);
+    historyAddSample(HISTORY_HUMIDITY, humiditySteps(row) / 10.0f);
+    pressureRows.push_back(pressureSteps(row));
+    humidityRows.push_back(humiditySteps(row));
+}
+
+/**
+ * A 5 °C step is 500 steps: four clamped rows of +127, then the rest
+ */
+static void testClamp() {
+    feedRow(0, 20.0f);
+    for (uint32_t row = 1; row <= 6; row++) {
+        feedRow(row, 25.0f);
+    }
+    CHECK(historyRowCount() == 6);  // Row 6 is still being collected
+
+    const float expected[6] = {20.00f, 21.27f, 22.54f, 23.81f, 25.00f, 25.00f};
+    for (int row = 0; row < 6; row++) {
+        float value = NAN;
+        CHECK(historyGetValue(HISTORY_TEMPERATURE, 5 - row, value));
+        CHECK_NEAR(value, expected[row], 1e-4);
+    }
+
+    HistoryStats stats;
+    CHECK(historyGetStats(HISTORY_TEMPERATURE, 60, stats));
+    CHECK(stats.rows == 6);
+    CHECK_NEAR(stats.min, 20.0, 1e-4);
+    CHECK_NEAR(stats.max, 25.0, 1e-4);
+    CHECK_NEAR(stats.mean, (20.00 + 21.27 + 22.54 + 23.81 + 25.00 + 25.00) / 6, 1e-3);
+}
+
+/**
+ * Checks a window against the fed series
+ * @param rows Stored rows, which the window is clamped to
+ */
+static void checkWindow(uint32_t minutes, uint32_t rows) {
+    uint32_t count = min(minutes, rows);
+    uint32_t end = pressureRows.size() - 1;  // The last fed row is not committed yet
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    int64_t sum = 0;
+    for (uint32_t r = end - count; r < end; r++) {
+        lo = min(lo, pressureRows[r]);
+        hi = max(hi, pressureRows[r]);
+        sum += pressureRows[r];
+    }
+
+    HistoryStats stats;
+    CHECK(historyGetStats(HISTORY_PRESSURE, minutes, stats));
+    CHECK(stats.rows == count);
+    CHECK_NEAR(stats.min, lo / 100.0, 1e-3);
+    CHECK_NEAR(stats.max, hi / 100.0, 1e-3);
+    CHECK_NEAR(stats.mean, sum / 100.0 / count, 1e-3);
+}
+
+static void testWrap() {
+    for (uint32_t row = 7; row <= WRAP_ROWS; row++) {
+        feedRow(row, 25.0f);
+    }
+
+    // Whole blocks are dropped, at least 24 hours stay
+    uint32_t committed = WRAP_ROWS;
+    uint32_t newestBlock = (committed - 1) / HISTORY_BLOCK_ROWS;
+    uint32_t stored = committed - (newestBlock - (HISTORY_BLOCKS - 1)) * HISTORY_BLOCK_ROWS;
+    CHECK(historyRowCount() == stored);
+    CHECK(stored >= 24 * 60 && stored <= HISTORY_CAPACITY);
+
+    float value;
+    CHECK(historyGetValue(HISTORY_PRESSURE, stored - 1, value));
+    CHECK_NEAR(value, pressureRows[committed - stored] / 100.0, 1e-4);
+    CHECK(!historyGetValue(HISTORY_PRESSURE, stored, value));
+
+    // The 3 h lookback of the history report
+    CHECK(historyGetValue(HISTORY_PRESSURE, 3 * 60, value));
+    CHECK_NEAR(value, pressureRows[committed - 1 - 3 * 60] / 100.0, 1e-4);
+    CHECK(historyGetValue(HISTORY_HUMIDITY, 3 * 60, value));
+    CHECK_NEAR(value, humidityRows[committed - 1 - 3 * 60] / 10.0, 1e-4);
+
+    // Windows inside the newest block (30 rows), on block edges and across them
+    const uint32_t windows[] = {1, 29, 30, 31, 59, 60, 61, 90, 150, 24 * 60, HISTORY_CAPACITY, 2000};
+    for (uint32_t minutes : windows) {
+        checkWindow(minutes, stored);
+    }
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    hostClockManual(true);
+    setupHistory();
+    testClamp();
+    testWrap();
+    return hostTestResult("test_history_store");
+}
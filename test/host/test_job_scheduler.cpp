@@ -0,0 +1,130 @@
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/job_scheduler.h"
+
+/*
+ * Both scheduler tasks on the real clock for about a second and a half:
+ * one-shot jobs run in deadline order whatever order they were added in;
+ * scheduleJobIn() from the test thread moves one job earlier and another
+ * one far out; triggerJob() from a job on the other scheduler runs its
+ * target straight away; a job busy for 5 ms every 50 ms shows up in the
+ * wake-up rate and idle share, and the report starts a new window.
+ */
+
+#define NEVER_MS 600000UL            // Period and first delay of jobs that only run when moved
+#define BUSY_PERIOD_MS 50
+#define BUSY_MICROS 5000
+#define MOVE_DELAY_MS 200
+#define ON_TIME_MS 40                // Allowed lateness, the busy job may hold the network task
+
+static std::atomic<int> orderCount(0);
+static std::atomic<char> order[3];
+static std::atomic<uint32_t> kickMs(0), triggeredMs(0), movedMs(0), postponedRuns(0);
+static int triggeredJob = -1;
+static uint32_t startMs;
+
+static void recordOrder(char name) {
+    int i = orderCount++;
+    if (i < 3) order[i] = name;
+}
+
+static void firstJob() { recordOrder('A'); }
+static void secondJob() { recordOrder('B'); }
+static void thirdJob() { recordOrder('C'); }
+
+static void kickJob() {
+    kickMs = millis();
+    triggerJob(triggeredJob);
+}
+
+static void triggeredRun() { triggeredMs = millis(); }
+static void movedRun() { movedMs = millis(); }
+static void postponedRun() { postponedRuns++; }
+
+static void busyJob() {
+    uint32_t start = micros();
+    while (micros() - start < BUSY_MICROS) {
+    }
+}
+
+static void sleepUntil(uint32_t ms) {
+    while ((int32_t)(millis() - (startMs + ms)) < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    startMs = millis();
+
+    // Added out of deadline order, 50 ms apart so they don't coalesce
+    int third = addJob(SCHEDULER_SENSORS, "third", thirdJob, NEVER_MS, 150);
+    int first = addJob(SCHEDULER_SENSORS, "first", firstJob, NEVER_MS, 50);
+    int second = addJob(SCHEDULER_SENSORS, "second", secondJob, NEVER_MS, 100);
+    addJob(SCHEDULER_SENSORS, "kick", kickJob, NEVER_MS, 300);
+    triggeredJob = addJob(SCHEDULER_NETWORK, "triggered", triggeredRun, NEVER_MS, NEVER_MS);
+    int moved = addJob(SCHEDULER_NETWORK, "moved", movedRun, NEVER_MS, NEVER_MS);
+    int postponed = addJob(SCHEDULER_NETWORK, "postponed", postponedRun, NEVER_MS, 400);
+    int busy = addJob(SCHEDULER_NETWORK, "busy", busyJob, BUSY_PERIOD_MS, 0);
+    CHECK(busy >= 0);
+    startSchedulers();
+
+    // scheduleJobIn() from another task, in both directions
+    sleepUntil(200);
+    uint32_t moveMs = millis();
+    scheduleJobIn(moved, MOVE_DELAY_MS);
+    scheduleJobIn(postponed, NEVER_MS);
+
+    sleepUntil(1000);
+    SchedulerStats stats;
+    getSchedulerStats(stats);
+
+    // Deadline order
+    CHECK(orderCount == 3);
+    CHECK(order[0] == 'A' && order[1] == 'B' && order[2] == 'C');
+    JobStats job;
+    const int ordered[3] = {first, second, third};
+    for (int id : ordered) {
+        CHECK(getJobStats(id, job));
+        CHECK(job.runs == 1);
+        CHECK(job.maxLateMs < ON_TIME_MS);
+    }
+
+    // triggerJob() across schedulers, scheduleJobIn() from the test thread
+    CHECK(kickMs != 0 && triggeredMs != 0);
+    CHECK(triggeredMs - kickMs < ON_TIME_MS);
+    CHECK(movedMs != 0);
+    CHECK(movedMs - moveMs + SCHEDULER_COALESCE_MS >= MOVE_DELAY_MS);
+    CHECK(movedMs - moveMs < MOVE_DELAY_MS + ON_TIME_MS);
+    CHECK(postponedRuns == 0);
+    CHECK(!getJobStats(SCHEDULER_MAX_JOBS, job));
+
+    // Busy job: about 20 runs, 5 ms each on one of two tasks
+    CHECK(getJobStats(busy, job));
+    CHECK(job.runs >= 15 && job.runs <= 21);
+    CHECK(job.maxMicros >= BUSY_MICROS);
+    uint32_t histogramRuns = 0;
+    for (uint32_t count : job.histogram.counts) histogramRuns += count;
+    CHECK(histogramRuns == job.runs);
+    printf("window %lu ms: %.1f wake-ups/min, %.2f%% idle, busy %lu runs\n",
+           (unsigned long)stats.windowMs, stats.wakeupsPerMinute, stats.idlePercent,
+           (unsigned long)job.runs);
+    CHECK(stats.windowMs >= 1000 && stats.windowMs < 1100);
+    CHECK(stats.wakeupsPerMinute >= 900 && stats.wakeupsPerMinute <= 2400);
+    CHECK(stats.idlePercent >= 90 && stats.idlePercent < 96);
+
+    // The report starts a new window
+    printSchedulerStats();
+    getSchedulerStats(stats);
+    CHECK(stats.windowMs < 20);
+    sleepUntil(1500);
+    getSchedulerStats(stats);
+    CHECK(stats.windowMs >= 450 && stats.windowMs < 600);
+    CHECK(stats.wakeupsPerMinute >= 900 && stats.wakeupsPerMinute <= 2400);
+    CHECK(stats.idlePercent >= 90 && stats.idlePercent < 96);
+
+    return hostTestResult("test_job_scheduler");
+}
@@ -0,0 +1,176 @@
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/metrics_server.h"
+#include "lwip/sockets.h"
+
+/*
+ * Runs the /metrics server on METRICS_PORT of the loopback interface:
+ * responses, refusals once every client slot is taken, a clean close
+ * (FIN, never a reset) in both cases, and a parallel load test.
+ */
+
+#define LOAD_REQUESTS 1000
+#define LOAD_CLIENTS 16
+
+static int connectServer() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(METRICS_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+// One request as a client sees it
+struct Exchange {
+    int status;               // HTTP status, 0 if none was received
+    bool reset;               // Connection ended with a reset instead of a close
+    std::string body;
+};
+
+/**
+ * Sends a request and reads the response until the server closes
+ */
+static Exchange request(const char *text) {
+    Exchange result = {0, false, ""};
+    int fd = connectServer();
+    if (fd < 0) return result;
+    send(fd, text, strlen(text), MSG_NOSIGNAL);
+
+    std::string response;
+    char chunk[1024];
+    while (true) {
+        int n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            response.append(chunk, n);
+            continue;
+        }
+        result.reset = n < 0;  // ECONNRESET, or the receive timeout
+        break;
+    }
+    close(fd);
+
+    if (response.compare(0, 9, "HTTP/1.1 ") == 0) result.status = atoi(response.c_str() + 9);
+    size_t headerEnd = response.find("\r\n\r\n");
+    if (headerEnd != std::string::npos) result.body = response.substr(headerEnd + 4);
+    return result;
+}
+
+static void testResponses() {
+    Exchange ok = request("GET /metrics HTTP/1.1\r\nHost: station\r\n\r\n");
+    CHECK(ok.status == 200);
+    CHECK(!ok.reset);
+    CHECK(ok.body.find("# TYPE weather_uptime_seconds counter\n") != std::string::npos);
+    CHECK(ok.body.find("weather_metrics_refused_total ") != std::string::npos);
+
+    Exchange missing = request("GET /other HTTP/1.1\r\n\r\n");
+    CHECK(missing.status == 404);
+    CHECK(!missing.reset);
+
+    Exchange method = request("POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+    CHECK(method.status == 405);
+    CHECK(!method.reset);
+}
+
+/**
+ * With every slot held by a client that never finishes its request, a
+ * further scrape is refused with 503 and its connection still ends cleanly
+ * although the server never read the request
+ */
+static void testRefusal() {
+    MetricsStats before;
+    getMetricsStats(before);
+
+    int idle[METRICS_MAX_CLIENTS];
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+        idle[i] = connectServer();
+        CHECK(idle[i] >= 0);
+        send(idle[i], "GET /met", 8, MSG_NOSIGNAL);
+    }
+    delay(200);  // Let the server accept them into its slots
+
+    // Large enough to still be unread when the server answers
+    std::string text = "GET /metrics HTTP/1.1\r\nUser-Agent: ";
+    text.append(2000, 'x');
+    text += "\r\n\r\n";
+    for (int i = 0; i < 5; i++) {
+        Exchange busy = request(text.c_str());
+        CHECK(busy.status == 503);
+        CHECK(!busy.reset);
+    }
+
+    MetricsStats after;
+    getMetricsStats(after);
+    CHECK(after.refused - before.refused == 5);
+
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+        close(idle[i]);
+    }
+    delay(200);
+    Exchange ok = request("GET /metrics HTTP/1.1\r\n\r\n");
+    CHECK(ok.status == 200);
+}
+
+/**
+ * LOAD_REQUESTS scrapes from LOAD_CLIENTS threads: every one must be
+ * answered completely with 200 or 503
+ */
+static void testLoad() {
+    MetricsStats before;
+    getMetricsStats(before);
+
+    std::atomic<int> next(0), okCount(0), busyCount(0), failed(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < LOAD_CLIENTS; t++) {
+        threads.emplace_back([&]() {
+            while (next++ < LOAD_REQUESTS) {
+                Exchange e = request("GET /metrics HTTP/1.1\r\nHost: station\r\n\r\n");
+                if (e.reset) {
+                    failed++;
+                } else if (e.status == 200 && e.body.find("weather_metrics_refused_total") != std::string::npos) {
+                    okCount++;
+                } else if (e.status == 503) {
+                    busyCount++;
+                } else {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    MetricsStats after;
+    getMetricsStats(after);
+    printf("Load: %d requests from %d clients: %d x 200, %d x 503, %d failed; %lu bytes sent\n",
+           LOAD_REQUESTS, LOAD_CLIENTS, okCount.load(), busyCount.load(), failed.load(),
+           (unsigned long)(after.bytesSent - before.bytesSent));
+    CHECK(failed == 0);
+    CHECK(okCount + busyCount == LOAD_REQUESTS);
+    CHECK(okCount > 0);
+}
+
+int main() {
+    if (!setupMetricsServer()) {
+        fprintf(stderr, "test_metrics_server: port %d unavailable\n", METRICS_PORT);
+        return 1;
+    }
+    testResponses();
+    testRefusal();
+    testLoad();
+    return hostTestResult("test_metrics_server");
+}
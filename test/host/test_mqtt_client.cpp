@@ -0,0 +1,155 @@
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/mqtt_client.h"
+#include "include/wifi_manager.h"
+
+/*
+ * The connection manager under the manual clock, through a broker outage:
+ * each failed attempt backs off between half and all of an exponential
+ * delay capped at MQTT_BACKOFF_MAX_MS, and calls inside the window make no
+ * attempt; the broker name is resolved once and again only after
+ * MQTT_DNS_REFRESH_FAILURES failures in a row; publishes queued during the
+ * outage stay in the outbox and are sent in order after the reconnect,
+ * which shows up in the reconnect and publish latency percentiles.
+ */
+
+#define OUTAGE_ATTEMPTS 12
+#define QUEUE_DELAY_MS 2             // Time between queueing and the next service call
+#define TOPIC "test/outbox"
+
+static std::vector<std::string> received;
+
+static void onPublish(const char *topic, const uint8_t *payload, size_t length, bool retained) {
+    (void)topic;
+    (void)retained;
+    received.push_back(std::string((const char *)payload, length));
+}
+
+static void queueNumbered(const char *prefix, int count) {
+    char payload[32];
+    for (int i = 0; i < count; i++) {
+        snprintf(payload, sizeof(payload), "%s %d", prefix, i);
+        CHECK(mqttEnqueue(TOPIC, payload, false, true));
+    }
+}
+
+static void checkReceived(size_t first, const char *prefix, int count) {
+    CHECK(received.size() == first + count);
+    char expected[32];
+    for (int i = 0; i < count && first + i < received.size(); i++) {
+        snprintf(expected, sizeof(expected), "%s %d", prefix, i);
+        CHECK_STR(received[first + i].c_str(), expected);
+    }
+}
+
+static void testConnect() {
+    CHECK(serviceMQTT() == MQTT_LOOP_INTERVAL_MS);
+    CHECK(mqttConnected());
+
+    queueNumbered("before", 3);
+    hostClockAdvanceMs(QUEUE_DELAY_MS);
+    serviceMQTT();
+    checkReceived(0, "before", 3);
+
+    MqttStats stats;
+    getMqttStats(stats);
+    CHECK(stats.connects == 1);
+    CHECK(stats.failures == 0);
+    CHECK(stats.outboxQueued == 0);
+    CHECK(stats.publishUs.count == 3);
+    CHECK(stats.publishUs.p50 == QUEUE_DELAY_MS * 1000);
+
+    HostMqttStats host;
+    hostMqttStats(host);
+    CHECK(host.lookups == 1);
+}
+
+static void testOutage() {
+    MqttStats stats;
+    HostMqttStats host;
+    hostBrokerUp(false);
+    uint32_t downMs = millis();
+
+    // The outbox keeps what is queued while the broker is away
+    queueNumbered("queued", MQTT_OUTBOX_SLOTS);
+    CHECK(!mqttEnqueue(TOPIC, "overflow", false, true));
+
+    uint32_t cappedDelays[OUTAGE_ATTEMPTS];
+    int capped = 0;
+    for (int attempt = 1; attempt <= OUTAGE_ATTEMPTS; attempt++) {
+        getMqttStats(stats);
+        uint32_t failures = stats.failures;
+        unsigned long delayMs = serviceMQTT();
+        getMqttStats(stats);
+        CHECK(stats.failures == failures + 1);
+        CHECK(!mqttConnected());
+
+        unsigned long base = MQTT_BACKOFF_MIN_MS;
+        for (int i = 1; i < attempt && base < MQTT_BACKOFF_MAX_MS; i++) base *= 2;
+        if (base > MQTT_BACKOFF_MAX_MS) base = MQTT_BACKOFF_MAX_MS;
+        CHECK(delayMs >= base / 2 && delayMs <= base);
+        if (base == MQTT_BACKOFF_MAX_MS) cappedDelays[capped++] = delayMs;
+
+        // One attempt per backoff window
+        hostClockAdvanceMs(delayMs - 1);
+        CHECK(serviceMQTT() == 1);
+        getMqttStats(stats);
+        CHECK(stats.failures == failures + 1);
+        hostClockAdvanceMs(1);
+    }
+    CHECK(capped >= 5);
+    bool jittered = false;
+    for (int i = 1; i < capped; i++) jittered |= cappedDelays[i] != cappedDelays[0];
+    CHECK(jittered);
+
+    // No attempts while Wi-Fi is down
+    hostWiFiUp(false);
+    getMqttStats(stats);
+    uint32_t failures = stats.failures;
+    CHECK(serviceMQTT() == 500);
+    getMqttStats(stats);
+    CHECK(stats.failures == failures);
+    hostWiFiUp(true);
+
+    hostMqttStats(host);
+    CHECK(host.lookups == 1 + OUTAGE_ATTEMPTS / MQTT_DNS_REFRESH_FAILURES);
+    getMqttStats(stats);
+    CHECK(stats.outboxQueued == MQTT_OUTBOX_SLOTS);
+    CHECK(stats.outboxDropped == 1);
+    CHECK(received.size() == 3);
+
+    // Back up: the outbox drains in order
+    hostBrokerUp(true);
+    uint32_t outageMs = millis() - downMs;
+    CHECK(serviceMQTT() == MQTT_LOOP_INTERVAL_MS);
+    CHECK(mqttConnected());
+    checkReceived(3, "queued", MQTT_OUTBOX_SLOTS);
+
+    getMqttStats(stats);
+    printf("%lu s outage: %lu failures, reconnect p50 %lu ms, publish p50 %lu us p99 %lu us\n",
+           (unsigned long)(outageMs / 1000), (unsigned long)stats.failures,
+           (unsigned long)stats.reconnectMs.p50, (unsigned long)stats.publishUs.p50,
+           (unsigned long)stats.publishUs.p99);
+    CHECK(stats.connects == 2);
+    CHECK(stats.outboxQueued == 0);
+    CHECK(stats.reconnectMs.count == 1);
+    CHECK(stats.reconnectMs.p50 == outageMs);
+    CHECK(stats.publishUs.count == 3 + MQTT_OUTBOX_SLOTS);
+    CHECK(stats.publishUs.p50 == (uint64_t)outageMs * 1000);
+    CHECK(stats.publishUs.p99 == (uint64_t)outageMs * 1000);
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    hostClockManual(true);
+    hostMqttListener(onPublish);
+    setupWiFi();
+    CHECK(connectWiFi(5000));
+    setupMQTT();
+    testConnect();
+    testOutage();
+    return hostTestResult("test_mqtt_client");
+}
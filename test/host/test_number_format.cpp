@@ -0,0 +1,102 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/number_format.h"
+
+/*
+ * Golden tests of the allocation-free formatter against the snprintf
+ * output it replaced: fixed cases (ties, carries, signs, zero, NAN,
+ * infinity), then a sweep of random floats at every supported precision.
+ * JSON fields must print null where printf would print nan or inf.
+ */
+
+#define RANDOM_VALUES 200000
+
+static void checkFixed(float value, uint8_t decimals) {
+    char expected[64];
+    char actual[64];
+    snprintf(expected, sizeof(expected), "%.*f", decimals, (double)value);
+    formatFixed(actual, sizeof(actual), value, decimals);
+    if (strcmp(actual, expected) != 0) {
+        fprintf(stderr, "appendFixed(%a, %u) = \"%s\", snprintf gives \"%s\"\n", (double)value, decimals,
+                actual, expected);
+        hostTestFailures++;
+    }
+}
+
+static void testFixedCases() {
+    static const float cases[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 0.375f, 9.995f, 99.95f,
+        0.05f, 0.005f, 1013.25f, 999.999f, -40.0f, 21.456f, 35.0f, 236.2205f, 1e-7f, -1e-7f,
+        123456.789f, 16777216.0f, 4294967296.0f, 1e12f, 3.4e12f,
+        NAN, -NAN, INFINITY, -INFINITY,
+    };
+    for (float value : cases) {
+        for (uint8_t decimals = 0; decimals <= FORMAT_MAX_DECIMALS; decimals++) {
+            checkFixed(value, decimals);
+        }
+    }
+}
+
+/**
+ * Random bit patterns cover every exponent; values beyond the documented
+ * range (1.8e19 / 10^decimals) are skipped
+ */
+static void testFixedRandom() {
+    uint32_t state = 2463534242u;
+    for (int i = 0; i < RANDOM_VALUES; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        float value;
+        memcpy(&value, &state, sizeof(value));
+        uint8_t decimals = state % (FORMAT_MAX_DECIMALS + 1);
+        if (isfinite(value) && fabsf(value) * powf(10.0f, decimals) >= 1.8e19f) continue;
+        checkFixed(value, decimals);
+    }
+}
+
+static void testUInt() {
+    static const uint32_t cases[] = {0, 1, 9, 10, 99, 100, 65535, 1000000, 4294967295u};
+    for (uint32_t value : cases) {
+        char expected[16];
+        char actual[16];
+        snprintf(expected, sizeof(expected), "%lu", (unsigned long)value);
+        actual[0] = '\0';
+        appendUInt(actual, sizeof(actual), 0, value);
+        CHECK_STR(actual, expected);
+    }
+}
+
+static void testJson() {
+    char buf[96];
+    size_t pos = appendText(buf, sizeof(buf), 0, "{");
+    pos = appendJsonField(buf, sizeof(buf), pos, "temperature", 21.456f, 2);
+    pos = appendJsonField(buf, sizeof(buf), pos, "humidity", NAN, 1);
+    pos = appendJsonField(buf, sizeof(buf), pos, "dew_point", -NAN, 1);
+    pos = appendJsonField(buf, sizeof(buf), pos, "heat_index", INFINITY, 1);
+    pos = appendJsonUInt(buf, sizeof(buf), pos, "count", 7);
+    appendText(buf, sizeof(buf), pos, "}");
+    CHECK_STR(buf, "{\"temperature\":21.46,\"humidity\":null,\"dew_point\":null,\"heat_index\":null,\"count\":7}");
+
+    buf[0] = '\0';
+    appendJsonNumber(buf, sizeof(buf), 0, -0.04f, 1);
+    CHECK_STR(buf, "-0.0");  // Same as printf
+}
+
+static void testTruncation() {
+    char buf[6];
+    size_t pos = appendText(buf, sizeof(buf), 0, "ab");
+    pos = appendFixed(buf, sizeof(buf), pos, 1013.25f, 2);
+    CHECK(pos == 5);
+    CHECK_STR(buf, "ab101");
+}
+
+int main() {
+    testFixedCases();
+    testFixedRandom();
+    testUInt();
+    testJson();
+    testTruncation();
+    return hostTestResult("test_number_format");
+}
@@ -0,0 +1,47 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include "host_test.h"
+#include "sim_ssd1306.h"
+#include "include/oled_display.h"
+#include "include/oled_renderer.h"
+#include "include/i2c_bus.h"
+
+/*
+ * Dirty-page renderer against the simulated SSD1306: the panel ends up
+ * with the framebuffer contents, an unchanged frame sends nothing, and no
+ * data transaction is longer than 32 bytes, so a sensor read waiting for
+ * the bus is never held up by more than one short chunk.
+ */
+
+static bool panelMatches() {
+    return memcmp(simSSD1306.ram(), display.getBuffer(), SCREEN_WIDTH * SCREEN_HEIGHT / 8) == 0;
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    simSSD1306.attach();
+    setupI2CBus();
+    setupOLED();
+    simSSD1306.resetLargestDataWrite();  // The library's own full-frame display() is not chunked by us
+
+    // Full-width change on every page
+    for (int16_t y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int16_t x = 0; x < SCREEN_WIDTH; x++) {
+            display.drawPixel(x, y, SSD1306_WHITE);
+        }
+    }
+    CHECK(flushOLEDChanges(display) > 0);
+    CHECK(panelMatches());
+
+    // A few characters
+    display.setCursor(10, 20);
+    display.setTextColor(SSD1306_BLACK);
+    display.print("1013.25 hPa");
+    CHECK(flushOLEDChanges(display) > 0);
+    CHECK(panelMatches());
+
+    CHECK(flushOLEDChanges(display) == 0);  // Nothing changed
+    CHECK(simSSD1306.largestDataWrite() > 0);
+    CHECK(simSSD1306.largestDataWrite() <= 32);
+    return hostTestResult("test_oled_renderer");
+}
@@ -0,0 +1,85 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/pressure_trend.h"
+
+/*
+ * Trend warm-up on a steady fall of 1 hPa/h, read every 10 s: the 1 h rate
+ * appears after TREND_SHORT_MIN_POINTS minutes, while the 3 h change,
+ * tendency and forecast stay unknown until the 3 h window holds
+ * TREND_LONG_MIN_POINTS and then report the full 3 h fall. A short wobble
+ * right after a power-on must not become a tendency.
+ */
+
+#define READ_PERIOD_MS 10000UL
+#define FALL_HPA_PER_HOUR 1.0f
+
+static float pressureAt(uint32_t ms) {
+    return 1012.0f - FALL_HPA_PER_HOUR * ms / 3600000.0f;
+}
+
+/**
+ * Feeds readings until the given minute since the start
+ */
+static void feedUntil(uint32_t startMs, uint32_t minute) {
+    while (millis() - startMs < minute * 60000UL) {
+        hostClockAdvanceMs(READ_PERIOD_MS);
+        pressureTrendAddSample(pressureAt(millis() - startMs));
+    }
+}
+
+static void testWarmUp() {
+    resetPressureTrend();
+    uint32_t start = millis();
+    PressureTrend t;
+    pressureTrendAddSample(pressureAt(0));
+
+    feedUntil(start, TREND_SHORT_MIN_POINTS - 1);
+    CHECK(!getPressureTrend(t));
+
+    feedUntil(start, TREND_SHORT_MIN_POINTS + 2);
+    CHECK(getPressureTrend(t));
+    CHECK_NEAR(t.rate1h, -FALL_HPA_PER_HOUR, 0.02);
+    CHECK(isnan(t.change3h));
+    CHECK(t.tendency == TENDENCY_UNKNOWN);
+    CHECK(t.zambretti == 0);
+
+    feedUntil(start, TREND_LONG_MIN_POINTS - 1);
+    CHECK(getPressureTrend(t));
+    CHECK(isnan(t.change3h));
+    CHECK(t.zambretti == 0);
+
+    feedUntil(start, TREND_LONG_MIN_POINTS + 2);
+    CHECK(getPressureTrend(t));
+    CHECK_NEAR(t.rate1h, -FALL_HPA_PER_HOUR, 0.02);
+    CHECK_NEAR(t.change3h, -3.0f * FALL_HPA_PER_HOUR, 0.05);
+    CHECK(t.tendency == TENDENCY_FALLING);
+    CHECK(t.zambretti >= 1 && t.zambretti <= 9);
+    CHECK(t.points >= TREND_LONG_MIN_POINTS);
+}
+
+/**
+ * A 0.5 hPa step ten minutes after a power-on: the 1 h rate may react,
+ * the 3 h change and forecast must not exist yet
+ */
+static void testEarlyWobble() {
+    resetPressureTrend();
+    PressureTrend t;
+    for (int i = 0; i < 30 * 6; i++) {
+        hostClockAdvanceMs(READ_PERIOD_MS);
+        pressureTrendAddSample(i < 10 * 6 ? 1012.0f : 1012.5f);
+    }
+    CHECK(getPressureTrend(t));
+    CHECK(t.rate1h > 0.5f);
+    CHECK(isnan(t.change3h));
+    CHECK(t.tendency == TENDENCY_UNKNOWN);
+    CHECK(strcmp(zambrettiForecastShort(t.zambretti), "No forecast yet") == 0);
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    hostClockManual(true);
+    testWarmUp();
+    testEarlyWobble();
+    return hostTestResult("test_pressure_trend");
+}
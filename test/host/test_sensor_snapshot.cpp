@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/sensor_math.h"
+#include "include/sensor_snapshot.h"
+
+/*
+ * Altitude table edge cases, and the snapshot under two writer threads
+ * and a reader: every copy the reader gets must have derived values that
+ * match its raw values, and neither writer may lose the other's reading.
+ */
+
+#define WRITES_PER_THREAD 200000
+
+static void testAltitude() {
+    // Interpolation against the formula across the table
+    for (float p = 300.0f; p <= 1250.0f; p += 0.37f) {
+        float exact = 44330.0f * (1.0f - powf(p / SEA_LEVEL_PRESSURE_HPA, 0.1903f));
+        CHECK_NEAR(pressureToAltitude(p), exact, 0.15);
+    }
+
+    CHECK(isnan(pressureToAltitude(NAN)));
+    CHECK(isnan(pressureToAltitude(-NAN)));
+
+    // Outside the table: extrapolated from the end intervals, never out of bounds
+    CHECK(isfinite(pressureToAltitude(-1e30f)));
+    CHECK(isfinite(pressureToAltitude(1e30f)));
+    CHECK(pressureToAltitude(100.0f) > pressureToAltitude(300.0f));
+    CHECK(pressureToAltitude(1400.0f) < pressureToAltitude(1250.0f));
+    CHECK(pressureToAltitude(INFINITY) == -INFINITY);
+
+    float batch[3] = {1013.25f, NAN, 900.0f};
+    pressureToAltitudeBatch(batch, batch, 3);
+    CHECK_NEAR(batch[0], 0.0, 0.05);
+    CHECK(isnan(batch[1]));
+    CHECK_NEAR(batch[2], 988.5, 0.5);
+}
+
+/**
+ * Writer values encode their own consistency: pressure p goes with
+ * altitude pressureToAltitude(p) and temperature p - 1000; humidity h
+ * with dew point dewPoint(temperature, h)
+ */
+static void testConcurrentWriters() {
+    std::atomic<bool> done(false);
+    std::atomic<int> bad(0);
+    std::atomic<uint32_t> copies(0);
+
+    std::thread bmp([]() {
+        for (int i = 0; i < WRITES_PER_THREAD; i++) {
+            float p = 1000.0f + (i % 50);
+            updateBMPSnapshot(p - 1000.0f, p, pressureToAltitude(p));
+        }
+    });
+    std::thread dht([]() {
+        for (int i = 0; i < WRITES_PER_THREAD; i++) {
+            updateHumiditySnapshot(20.0f + (i % 60));
+        }
+    });
+    std::thread reader([&]() {
+        while (!done) {
+            SensorSnapshot s;
+            readSensorSnapshot(s);
+            copies++;
+            if (isnan(s.pressure) || isnan(s.humidity)) continue;
+            bool ok = s.temperature == s.pressure - 1000.0f &&
+                      s.altitude == pressureToAltitude(s.pressure) &&
+                      s.seaLevelPressure == seaLevelPressure(s.pressure) &&
+                      s.temperatureF == celsiusToFahrenheit(s.temperature) &&
+                      s.dewPoint == dewPoint(s.temperature, s.humidity);
+            if (!ok) bad++;
+        }
+    });
+    bmp.join();
+    dht.join();
+    done = true;
+    reader.join();
+
+    SensorSnapshot last;
+    readSensorSnapshot(last);
+    CHECK(bad == 0);
+    CHECK(copies > 0);
+    CHECK(last.sequence == 2 * WRITES_PER_THREAD);  // No update lost
+    CHECK(last.pressure == 1000.0f + (WRITES_PER_THREAD - 1) % 50);
+    CHECK(last.humidity == 20.0f + (WRITES_PER_THREAD - 1) % 60);
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    setupSensorMath();
+    testAltitude();
+    testConcurrentWriters();
+    return hostTestResult("test_sensor_snapshot");
+}
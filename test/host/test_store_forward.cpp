@@ -0,0 +1,107 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <string>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/store_forward.h"
+#include "include/mqtt_publisher.h"
+#include "include/sensor_snapshot.h"
+#include "include/sensor_math.h"
+
+/*
+ * Store-and-forward on a LittleFS directory of the host: readings queued
+ * before NTP sync are stored with their uptime, held back until the clock
+ * is set and then dated from it; uptime readings left by an earlier boot
+ * are dropped, and Unix-time readings pass through unchanged.
+ */
+
+#define SYNC_EPOCH 1760000000UL
+
+static QueuedReading reading(uint32_t timestamp, float pressure) {
+    QueuedReading r;
+    r.timestamp = timestamp;
+    r.pressure = (uint32_t)lroundf(pressure * 100.0f);
+    r.altitude = 12000;
+    r.temperature = 2150;
+    r.humidity = 450;
+    return r;
+}
+
+/**
+ * Writes the segment an earlier boot left behind: two readings taken
+ * before that boot synced its clock, then one after
+ */
+static void writePreviousBoot() {
+    LittleFS.mkdir(STORE_FORWARD_DIR);
+    QueuedReading previous[3] = {
+        reading(30 | QUEUED_TIME_UPTIME, 1001.00f),
+        reading(60 | QUEUED_TIME_UPTIME, 1002.00f),
+        reading(1750000000, 1003.00f),
+    };
+    File f = LittleFS.open(STORE_FORWARD_DIR "/00000000.log", FILE_WRITE);
+    f.write((const uint8_t *)previous, sizeof(previous));
+    f.close();
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    hostClockManual(true);
+    hostSetEpoch(0);  // NTP has not answered yet
+    std::string root = std::string(hostFsRootPath()) + "/store-forward";
+    hostFsRoot(root.c_str());
+    setupSensorMath();
+
+    writePreviousBoot();
+    CHECK(setupStoreForward());
+    CHECK(storeForwardPending() == 3);
+
+    // Two readings queued before the clock is set, 100 s and 160 s after boot
+    hostClockAdvanceMs(100000);
+    updateBMPSnapshot(21.5f, 1010.00f, 120.0f);
+    updateHumiditySnapshot(45.0f);
+    queueSensorData();
+    hostClockAdvanceMs(60000);
+    updateBMPSnapshot(21.5f, 1011.00f, 120.0f);
+    queueSensorData();
+    storeForwardFlush();  // Both go to flash with their uptime
+    CHECK(storeForwardPending() == 5);
+
+    QueuedReading batch[8];
+    CHECK(storeForwardPeek(batch, 8) == 0);  // Cannot be dated yet
+
+    // NTP answers at 200 s; one more reading is queued at 230 s
+    hostClockAdvanceMs(40000);
+    hostSetEpoch(SYNC_EPOCH);
+    hostClockAdvanceMs(30000);
+    updateBMPSnapshot(21.5f, 1012.00f, 120.0f);
+    queueSensorData();
+
+    StoreForwardStats before;
+    getStoreForwardStats(before);
+    size_t count = storeForwardPeek(batch, 8);
+
+    // The earlier boot's uptime readings are dropped, its Unix reading kept
+    StoreForwardStats after;
+    getStoreForwardStats(after);
+    CHECK(after.dropped - before.dropped == 2);
+    CHECK(count == 4);
+    CHECK(storeForwardPending() == 4);
+    CHECK(batch[0].timestamp == 1750000000);
+    CHECK(batch[0].pressure == 100300);
+
+    // Readings of this boot: dated from their uptime, or already in Unix time
+    CHECK(batch[1].pressure == 101000);
+    CHECK(batch[1].timestamp == SYNC_EPOCH + 100 - 200);
+    CHECK(batch[2].pressure == 101100);
+    CHECK(batch[2].timestamp == SYNC_EPOCH + 160 - 200);
+    CHECK(batch[3].pressure == 101200);
+    CHECK(batch[3].timestamp == SYNC_EPOCH + 30);
+    for (size_t i = 0; i < count; i++) {
+        CHECK((batch[i].timestamp & QUEUED_TIME_UPTIME) == 0);
+    }
+
+    storeForwardConsume(count);
+    CHECK(storeForwardPending() == 0);
+    CHECK(storeForwardPeek(batch, 8) == 0);
+    return hostTestResult("test_store_forward");
+}
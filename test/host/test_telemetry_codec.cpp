@@ -0,0 +1,238 @@
+#include <Arduino.h>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/telemetry_codec.h"
+#include "include/binary_telemetry.h"
+#include "include/sensor_registry.h"
+#include "include/sensor_math.h"
+
+/*
+ * Binary telemetry round trips: random frames with every precision,
+ * missing values, timestamps that go backwards or wrap, and clamped
+ * extremes decode to what was encoded; a full frame refuses samples
+ * without changing; every malformed or truncated frame is rejected.
+ */
+
+#define RANDOM_FRAMES 2000
+
+static uint32_t rngState = 2463534242u;
+
+static uint32_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+/**
+ * Value the decoder must return for an encoded one: rounded to the
+ * field's precision, NaN kept
+ */
+static double expectedValue(float value, uint8_t decimals) {
+    double scale = pow(10.0, decimals);
+    return round((double)value * scale) / scale;
+}
+
+static void testRandomFrames() {
+    static uint8_t frame[4096];
+    static float values[TELEMETRY_MAX_SAMPLES][TELEMETRY_MAX_FIELDS];
+    static uint32_t timestamps[TELEMETRY_MAX_SAMPLES];
+    static TelemetrySample decoded[TELEMETRY_MAX_SAMPLES];
+
+    for (int f = 0; f < RANDOM_FRAMES; f++) {
+        uint8_t fieldCount = 1 + nextRandom() % TELEMETRY_MAX_FIELDS;
+        uint8_t decimals[TELEMETRY_MAX_FIELDS];
+        for (uint8_t i = 0; i < fieldCount; i++) {
+            decimals[i] = nextRandom() % 4;
+        }
+        TelemetryEncoder enc;
+        CHECK(telemetryBegin(enc, frame, sizeof(frame), decimals, fieldCount));
+
+        size_t count = 0;
+        uint32_t timestamp = nextRandom();
+        while (count < TELEMETRY_MAX_SAMPLES) {
+            timestamp += (nextRandom() % 8 == 0) ? nextRandom() : 30;  // Mostly regular, sometimes a jump either way
+            for (uint8_t i = 0; i < fieldCount; i++) {
+                uint32_t r = nextRandom();
+                values[count][i] = (r % 20 == 0) ? NAN : (float)((int32_t)(r % 2000001) - 1000000) / 1000.0f;
+            }
+            if (!telemetryAppend(enc, timestamp, values[count])) break;
+            timestamps[count++] = timestamp;
+            if (nextRandom() % 64 == 0) break;
+        }
+
+        uint8_t fields = 0;
+        int samples = telemetryDecode(frame, telemetryLength(enc), decoded, TELEMETRY_MAX_SAMPLES, fields);
+        CHECK(samples == (int)count);
+        CHECK(fields == fieldCount);
+        if (samples != (int)count) continue;
+        for (size_t n = 0; n < count; n++) {
+            CHECK(decoded[n].timestamp == timestamps[n]);
+            for (uint8_t i = 0; i < fieldCount; i++) {
+                if (isnan(values[n][i])) {
+                    CHECK(isnan(decoded[n].values[i]));
+                } else {
+                    CHECK_NEAR(decoded[n].values[i], expectedValue(values[n][i], decimals[i]), 1e-3);
+                }
+            }
+        }
+    }
+}
+
+static void testExtremes() {
+    const uint8_t decimals[3] = {0, 2, 6};
+    uint8_t frame[128];
+    TelemetryEncoder enc;
+    CHECK(telemetryBegin(enc, frame, sizeof(frame), decimals, 3));
+    CHECK(telemetryLength(enc) == 0);  // Nothing to publish yet
+
+    const float big[3] = {3e9f, -3e9f, INFINITY};
+    const float small[3] = {-0.0f, 0.004f, -0.0000004f};
+    CHECK(telemetryAppend(enc, 0xFFFFFFF0u, big));
+    CHECK(telemetryAppend(enc, 0x00000010u, small));  // Timestamp wraps
+
+    TelemetrySample decoded[2];
+    uint8_t fields;
+    CHECK(telemetryDecode(frame, telemetryLength(enc), decoded, 2, fields) == 2);
+    CHECK(decoded[0].timestamp == 0xFFFFFFF0u);
+    CHECK(decoded[1].timestamp == 0x00000010u);
+    CHECK_NEAR(decoded[0].values[0], 2147483647.0, 1.0);  // Clamped, never mistaken for NaN
+    CHECK_NEAR(decoded[0].values[1], -21474836.47, 4.0);  // float resolution at this size
+    CHECK(!isnan(decoded[0].values[2]));
+    CHECK(decoded[1].values[0] == 0.0f);
+    CHECK_NEAR(decoded[1].values[1], 0.0, 1e-9);
+    CHECK_NEAR(decoded[1].values[2], 0.0, 1e-9);
+}
+
+/**
+ * A sample that might not fit is refused and leaves the frame as it was
+ */
+static void testFullFrame() {
+    const uint8_t decimals[2] = {1, 1};
+    uint8_t frame[TELEMETRY_HEADER_BYTES(2) + 3 * TELEMETRY_MAX_SAMPLE_BYTES(2)];
+    TelemetryEncoder enc;
+    CHECK(!telemetryBegin(enc, frame, TELEMETRY_HEADER_BYTES(2), decimals, 2));
+    CHECK(!telemetryBegin(enc, frame, sizeof(frame), decimals, TELEMETRY_MAX_FIELDS + 1));
+    CHECK(telemetryBegin(enc, frame, sizeof(frame), decimals, 2));
+
+    const float values[2] = {1.0f, 2.0f};
+    int appended = 0;
+    while (telemetryAppend(enc, 1700000000 + appended, values)) {
+        appended++;
+    }
+    CHECK(appended >= 3);
+
+    size_t length = telemetryLength(enc);
+    uint8_t copy[sizeof(frame)];
+    memcpy(copy, frame, length);
+    CHECK(!telemetryAppend(enc, 1800000000, values));
+    CHECK(telemetryLength(enc) == length);
+    CHECK(memcmp(copy, frame, length) == 0);
+
+    TelemetrySample decoded[TELEMETRY_MAX_SAMPLES];
+    uint8_t fields;
+    CHECK(telemetryDecode(frame, length, decoded, TELEMETRY_MAX_SAMPLES, fields) == appended);
+    CHECK(decoded[appended - 1].timestamp == (uint32_t)(1700000000 + appended - 1));
+}
+
+static void testMalformed() {
+    const uint8_t decimals[4] = {2, 1, 0, 0};
+    uint8_t frame[256];
+    TelemetryEncoder enc;
+    CHECK(telemetryBegin(enc, frame, sizeof(frame), decimals, 4));
+    const float a[4] = {21.5f, 45.0f, 236.0f, 999.0f};
+    const float b[4] = {21.7f, NAN, 237.0f, 1000.0f};
+    CHECK(telemetryAppend(enc, 1700000000, a));
+    CHECK(telemetryAppend(enc, 1700000030, b));
+    size_t length = telemetryLength(enc);
+
+    TelemetrySample decoded[4];
+    uint8_t fields;
+    CHECK(telemetryDecode(frame, length, decoded, 4, fields) == 2);
+
+    // Every truncation, and trailing bytes
+    for (size_t cut = 0; cut < length; cut++) {
+        CHECK(telemetryDecode(frame, cut, decoded, 4, fields) == -1);
+    }
+    frame[length] = 0;
+    CHECK(telemetryDecode(frame, length + 1, decoded, 4, fields) == -1);
+
+    CHECK(telemetryDecode(frame, length, decoded, 1, fields) == -1);  // More samples than room
+
+    uint8_t bad[256];
+    memcpy(bad, frame, length);
+    bad[0] = TELEMETRY_FORMAT_VERSION + 1;
+    CHECK(telemetryDecode(bad, length, decoded, 4, fields) == -1);
+    memcpy(bad, frame, length);
+    bad[1] = TELEMETRY_MAX_FIELDS + 1;
+    CHECK(telemetryDecode(bad, length, decoded, 4, fields) == -1);
+    memcpy(bad, frame, length);
+    bad[7] = 7;  // Decimals beyond the supported range
+    CHECK(telemetryDecode(bad, length, decoded, 4, fields) == -1);
+
+    // A varint that never ends
+    memcpy(bad, frame, TELEMETRY_HEADER_BYTES(4));
+    bad[2] = 1;
+    memset(bad + TELEMETRY_HEADER_BYTES(4), 0xFF, 8);
+    CHECK(telemetryDecode(bad, TELEMETRY_HEADER_BYTES(4) + 8, decoded, 4, fields) == -1);
+}
+
+/**
+ * A day of station readings every 30 s in the registry layout: prints the
+ * size per reading in live and backlog frames
+ */
+static void testStationFrames() {
+    uint8_t decimals[SENSOR_COUNT];
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        decimals[i] = sensorRegistry[i].decimals;
+    }
+
+    const size_t batches[2] = {TELEMETRY_BATCH_SAMPLES, TELEMETRY_BACKLOG_SAMPLES};
+    for (size_t batch : batches) {
+        size_t bytes = 0, readings = 0;
+        uint32_t timestamp = 1700000000;
+        for (int frameIndex = 0; frameIndex < 2880 / (int)batch; frameIndex++) {
+            uint8_t frame[TELEMETRY_FRAME_BYTES];
+            TelemetryEncoder enc;
+            CHECK(telemetryBegin(enc, frame, sizeof(frame), decimals, SENSOR_COUNT));
+            float values[TELEMETRY_BACKLOG_SAMPLES][SENSOR_COUNT];
+            for (size_t n = 0; n < batch; n++) {
+                float minute = readings / 2.0f;
+                SensorSnapshot s;
+                s.temperature = 18.0f + 4.0f * sinf(minute / 229.0f);
+                s.humidity = 45.0f + 10.0f * cosf(minute / 229.0f);
+                s.pressure = 1005.0f + 3.0f * sinf(minute / 700.0f);
+                s.altitude = 72.0f - 8.3f * sinf(minute / 700.0f);
+                deriveSensorReadings(s);
+                for (int i = 0; i < SENSOR_COUNT; i++) {
+                    values[n][i] = s.*sensorRegistry[i].field;
+                }
+                CHECK(telemetryAppend(enc, timestamp, values[n]));
+                timestamp += 30;
+                readings++;
+            }
+            bytes += telemetryLength(enc);
+
+            TelemetrySample decoded[TELEMETRY_BACKLOG_SAMPLES];
+            uint8_t fields;
+            CHECK(telemetryDecode(frame, telemetryLength(enc), decoded, batch, fields) == (int)batch);
+            for (size_t n = 0; n < batch; n++) {
+                for (int i = 0; i < SENSOR_COUNT; i++) {
+                    CHECK_NEAR(decoded[n].values[i], expectedValue(values[n][i], decimals[i]), 1e-3);
+                }
+            }
+        }
+        printf("Frames of %u readings: %.1f bytes per reading\n", (unsigned)batch, bytes / (float)readings);
+    }
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    setupSensorMath();
+    testRandomFrames();
+    testExtremes();
+    testFullFrame();
+    testMalformed();
+    testStationFrames();
+    return hostTestResult("test_telemetry_codec");
+}
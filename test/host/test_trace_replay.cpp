@@ -0,0 +1,116 @@
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "host_hal.h"
+#include "host_test.h"
+#include "include/sensor_trace.h"
+#include "include/mqtt_publisher.h"
+#include "include/sensor_snapshot.h"
+
+/*
+ * Replay of test/host/data/sample_trace.txt, two hours of a Serial Monitor
+ * log with one reboot: BMP390 every 10 s, DHT11 every 20 s, a few failed
+ * reads and ordinary log lines in between. The counters must match the
+ * trace, publish decisions must respect the policy's intervals, and a
+ * second replay must produce the same decisions.
+ */
+
+#define SAMPLE_TRACE_LINES 1080
+#define SAMPLE_BMP_LINES 720
+#define SAMPLE_READ_PERIOD_MS 10000UL
+
+static std::string samplePath() {
+    std::string path = __FILE__;
+    return path.substr(0, path.rfind('/')) + "/data/sample_trace.txt";
+}
+
+static void testParse() {
+    TraceLine t;
+    CHECK(parseTraceLine("~T,184022,B,0,21.8731,1009.4412\r\n", t));
+    CHECK(t.ms == 184022);
+    CHECK(t.source == TRACE_SOURCE_BMP390);
+    CHECK(t.status == 0);
+    CHECK_NEAR(t.value1, 21.8731, 1e-4);
+    CHECK_NEAR(t.value2, 1009.4412, 1e-3);
+
+    CHECK(parseTraceLine("~T,187061,D,3,nan,0.0000", t));
+    CHECK(t.source == TRACE_SOURCE_DHT11);
+    CHECK(t.status == 3);
+    CHECK(isnan(t.value1));
+
+    CHECK(!parseTraceLine("01/28/25 10:43PM PST | Temp: 21.87 C", t));
+    CHECK(!parseTraceLine("~P,60000,{\"temperature\":71.37}", t));
+    CHECK(!parseTraceLine("~T,184022,B", t));
+    CHECK(!parseTraceLine("~T,184022;B;0;1;2", t));
+    CHECK(!parseTraceLine("", t));
+}
+
+/**
+ * Replays the sample and returns the "~P" lines it printed
+ */
+static std::vector<std::string> replaySample(TraceReplayStats &stats) {
+    FILE *in = fopen(samplePath().c_str(), "r");
+    CHECK(in != NULL);
+    FILE *out = tmpfile();
+    hostSerialOutput(out);
+
+    traceReplayBegin(stats);
+    char line[256];
+    while (in != NULL && fgets(line, sizeof(line), in) != NULL) {
+        traceReplayLine(line, stats);
+    }
+    traceReplayEnd();
+    hostSerialOutput(nullptr);
+    if (in != NULL) fclose(in);
+
+    std::vector<std::string> publishes;
+    rewind(out);
+    while (fgets(line, sizeof(line), out) != NULL) {
+        if (strncmp(line, "~P,", 3) == 0) publishes.push_back(line);
+    }
+    fclose(out);
+    return publishes;
+}
+
+static void testReplay() {
+    TraceReplayStats stats;
+    std::vector<std::string> publishes = replaySample(stats);
+
+    CHECK(stats.lines == SAMPLE_TRACE_LINES);
+    CHECK(stats.bmpReadings + stats.bmpFailures == SAMPLE_BMP_LINES);
+    CHECK(stats.bmpFailures == 1);
+    CHECK(stats.dhtReadings + stats.dhtFailures == SAMPLE_TRACE_LINES - SAMPLE_BMP_LINES);
+    CHECK(stats.dhtFailures == 3);
+    CHECK(stats.reboots == 1);
+    CHECK(stats.lastMs - stats.firstMs > 119UL * 60 * 1000);  // Continues across the reboot
+    CHECK(stats.maxPressureLag < 0.5f);
+
+    // One "~P" line per decision, spaced as the policy allows
+    CHECK(publishes.size() == stats.publishes);
+    CHECK(stats.publishes >= 2 * 60 * 60 * 1000 / PUBLISH_MAX_INTERVAL_MS);
+    uint32_t previous = 0;
+    for (size_t i = 0; i < publishes.size(); i++) {
+        uint32_t ms = strtoul(publishes[i].c_str() + 3, NULL, 10);
+        CHECK(publishes[i].find("\"pressure\":") != std::string::npos);
+        if (i > 0) {
+            CHECK(ms - previous >= PUBLISH_MIN_INTERVAL_MS);
+            CHECK(ms - previous <= PUBLISH_MAX_INTERVAL_MS + SAMPLE_READ_PERIOD_MS);
+        }
+        previous = ms;
+    }
+
+    // Readings after the replay are stamped with millis() again
+    CHECK(traceClockMs() == millis());
+
+    TraceReplayStats again;
+    std::vector<std::string> repeated = replaySample(again);
+    CHECK(repeated == publishes);
+    CHECK(again.maxPressureLag == stats.maxPressureLag);
+}
+
+int main() {
+    hostSerialOutput(nullptr);
+    testParse();
+    testReplay();
+    return hostTestResult("test_trace_replay");
+}
@@ -0,0 +1,190 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "include/telemetry_codec.h"
+
+/*
+ * Collector-side decoder for the binary telemetry frames. It is built
+ * from src/telemetry_codec.cpp alone, without the firmware or the host
+ * shims, the same way a collector would embed the codec.
+ *
+ * Prints every sample as a CSV row: the Unix timestamp, then each field
+ * with the precision stored in the frame; missing values stay empty.
+ * Each file holds one raw frame (stdin without files), or with --hex one
+ * frame per line as printed by `mosquitto_sub -F %x`.
+ */
+
+#define DEFAULT_FIELDS "temperature,humidity,altitude,pressure"  // SENSOR_REGISTRY order
+
+static void usage() {
+    fprintf(stderr,
+            "usage: telemetry_decode [--hex] [--fields name,...] [file ...]\n"
+            "  --hex      input holds one hex-encoded frame per line\n"
+            "  --fields   column names in frame order (default " DEFAULT_FIELDS ")\n");
+}
+
+static std::vector<std::string> splitNames(const char *list) {
+    std::vector<std::string> names;
+    std::string current;
+    for (const char *p = list; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            names.push_back(current);
+            current.clear();
+            if (*p == '\0') break;
+        } else {
+            current += *p;
+        }
+    }
+    return names;
+}
+
+static bool readAll(FILE *in, std::vector<uint8_t> &data) {
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    return !ferror(in);
+}
+
+/**
+ * Parses one line of hex digits, ignoring whitespace
+ * @return false on a non-hex character or an odd digit count
+ */
+static bool parseHex(const std::string &line, std::vector<uint8_t> &frame) {
+    frame.clear();
+    int high = -1;
+    for (char c : line) {
+        if (isspace((unsigned char)c)) continue;
+        if (!isxdigit((unsigned char)c)) return false;
+        int digit = isdigit((unsigned char)c) ? c - '0' : tolower((unsigned char)c) - 'a' + 10;
+        if (high < 0) {
+            high = digit;
+        } else {
+            frame.push_back((uint8_t)(high << 4 | digit));
+            high = -1;
+        }
+    }
+    return high < 0;
+}
+
+/**
+ * Decodes one frame and prints its samples
+ * @return false if the frame is malformed
+ */
+static bool printFrame(const std::vector<uint8_t> &frame, const std::vector<std::string> &names,
+                       bool &headerPrinted, const char *source) {
+    static TelemetrySample samples[TELEMETRY_MAX_SAMPLES];
+    uint8_t fieldCount = 0;
+    int count = telemetryDecode(frame.data(), frame.size(), samples, TELEMETRY_MAX_SAMPLES, fieldCount);
+    if (count < 0) {
+        fprintf(stderr, "telemetry_decode: %s: malformed frame (%u bytes)\n", source, (unsigned)frame.size());
+        return false;
+    }
+
+    if (!headerPrinted) {
+        printf("timestamp");
+        for (uint8_t i = 0; i < fieldCount; i++) {
+            if (i < names.size()) {
+                printf(",%s", names[i].c_str());
+            } else {
+                printf(",field%u", i);
+            }
+        }
+        printf("\n");
+        headerPrinted = true;
+    }
+
+    for (int s = 0; s < count; s++) {
+        printf("%lu", (unsigned long)samples[s].timestamp);
+        for (uint8_t i = 0; i < fieldCount; i++) {
+            float value = samples[s].values[i];
+            if (isnan(value)) {
+                printf(",");
+            } else {
+                printf(",%.*f", frame[7 + i], (double)value);
+            }
+        }
+        printf("\n");
+    }
+    return true;
+}
+
+/**
+ * Decodes every frame of one input
+ * @return Number of malformed frames
+ */
+static int decodeInput(FILE *in, const char *name, bool hex, const std::vector<std::string> &names,
+                       bool &headerPrinted) {
+    std::vector<uint8_t> data;
+    if (!readAll(in, data)) {
+        fprintf(stderr, "telemetry_decode: %s: read error\n", name);
+        return 1;
+    }
+    if (!hex) {
+        return printFrame(data, names, headerPrinted, name) ? 0 : 1;
+    }
+
+    int errors = 0;
+    int lineNumber = 0;
+    std::string text(data.begin(), data.end());
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+        lineNumber++;
+
+        std::vector<uint8_t> frame;
+        std::string source = std::string(name) + ":" + std::to_string(lineNumber);
+        if (!parseHex(line, frame)) {
+            fprintf(stderr, "telemetry_decode: %s: not a hex frame\n", source.c_str());
+            errors++;
+            continue;
+        }
+        if (frame.empty()) continue;  // Blank line
+        if (!printFrame(frame, names, headerPrinted, source.c_str())) errors++;
+    }
+    return errors;
+}
+
+int main(int argc, char **argv) {
+    bool hex = false;
+    std::vector<std::string> names = splitNames(DEFAULT_FIELDS);
+    std::vector<const char *> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hex") == 0) {
+            hex = true;
+        } else if (strcmp(argv[i], "--fields") == 0 && i + 1 < argc) {
+            names = splitNames(argv[++i]);
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage();
+            return 2;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    bool headerPrinted = false;
+    int errors = 0;
+    if (files.empty()) {
+        errors += decodeInput(stdin, "stdin", hex, names, headerPrinted);
+    }
+    for (const char *path : files) {
+        FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+        if (in == NULL) {
+            fprintf(stderr, "telemetry_decode: %s: cannot open\n", path);
+            errors++;
+            continue;
+        }
+        errors += decodeInput(in, path, hex, names, headerPrinted);
+        if (in != stdin) fclose(in);
+    }
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "host_hal.h"
+#include "include/sensor_trace.h"
+
+/*
+ * Replays recorded sensor traces on a PC through the firmware's own
+ * pipeline (offsets, smoothing, snapshot, history, publish policy), the
+ * same engine TRACE_REPLAY_MODE runs on the station. Takes trace files or
+ * a Serial Monitor log, or stdin without files; prints a "~P" line per
+ * publish decision and the summary.
+ */
+
+static void usage() {
+    fprintf(stderr,
+            "usage: trace_replay [--quiet] [file ...]\n"
+            "  --quiet    print only the summary, not the ~P publish lines\n");
+}
+
+/**
+ * Replays every line of one input
+ */
+static void replayInput(FILE *in, TraceReplayStats &stats) {
+    char line[256];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        traceReplayLine(line, stats);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool quiet = false;
+    std::vector<const char *> files;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage();
+            return 2;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    hostSerialOutput(quiet ? nullptr : stdout);
+    TraceReplayStats stats;
+    traceReplayBegin(stats);
+    auto start = std::chrono::steady_clock::now();
+
+    int errors = 0;
+    if (files.empty()) {
+        replayInput(stdin, stats);
+    }
+    for (const char *path : files) {
+        FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+        if (in == NULL) {
+            fprintf(stderr, "trace_replay: %s: cannot open\n", path);
+            errors++;
+            continue;
+        }
+        replayInput(in, stats);
+        if (in != stdin) fclose(in);
+    }
+    traceReplayEnd();
+
+    unsigned long wallMs = (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    hostSerialOutput(stdout);
+    printTraceReplaySummary(stats, wallMs);
+    return errors || stats.lines == 0 ? 1 : 0;
+}